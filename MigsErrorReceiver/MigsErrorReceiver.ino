@@ -1,6 +1,9 @@
 /*
  * Author: Dylan Turner
- * Description: Receive error messages from the pgrmr
+ * Description:
+ * - Receive debug events from the pgrmr and pass them on over USB
+ * - They're binary (MigsSdk/src/PgrmrTrace.hpp), so read them with
+ *   tools/migsdebug.py <port> rather than a serial monitor
  */
 
 #include <SoftwareSerial.h>
@@ -9,7 +12,7 @@ SoftwareSerial errorReceiver(5, 4); // rx, tx
 
 void setup() {
     Serial.begin(115200);
-    errorReceiver.begin(19200);
+    errorReceiver.begin(57600); // pgrmrtrace::g_baud
 }
 
 void loop() {
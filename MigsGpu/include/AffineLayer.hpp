@@ -0,0 +1,50 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - An affine ("Mode 7") tile background: a map of image slots, turned,
+ *   scaled and sheared by a 2x2 matrix about an origin, drawn over the flat
+ *   background (tile pixels without the alpha bit let it through)
+ * - A line starts from the matrix and origin, scaled by its AffineScale
+ *   entry and fed its AffineRow entry when those tables are in use, which is
+ *   all a perspective floor takes. So the logic MCU sends a few parameters
+ *   a frame, never pixels
+ * - Texture addresses come out of the RP2040's interpolators, stepped once
+ *   a pixel: interp0 gives the map cell, interp1 where in its tile. Nothing
+ *   else uses them
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <GpuLink.hpp>
+
+class AffineLayer {
+    public:
+        AffineLayer(const uint8_t *tiles); // Image slots, g_imageSize apart
+
+        // In tiles, all slot 0. w = 0 turns it off. False if it won't fit
+        bool setup(const int w, const int h, const gpulink::AffineEdge edge);
+        void setCells(const int first, const int count, const uint8_t *slots);
+        void fillCells(const int first, const int count, const uint8_t slot);
+        void matrix(
+            const int16_t pa, const int16_t pb,
+            const int16_t pc, const int16_t pd
+        );
+        void origin( // u, v in 1/16ths of a px, shown at screen point x, y
+            const int16_t u, const int16_t v, const int16_t x, const int16_t y
+        );
+
+        // scales and rows are the raster tables, or null while not in use
+        void drawScanline(
+            uint16_t *pixBuff, const int y, const int width,
+            const uint16_t *scales, const uint16_t *rows
+        ) const;
+
+    private:
+        const uint8_t *_tiles;
+        int _logW, _logH; // 0 while it's off
+        gpulink::AffineEdge _edge;
+        int16_t _pa, _pb, _pc, _pd;
+        int16_t _u, _v, _x, _y;
+        uint8_t _cells[gpulink::g_affineMaxCells];
+};
@@ -0,0 +1,16 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Images built into the firmware from MigsGpu/rom/ by tools/migsrom.py, so
+ *   standard ones (the system font, UI sprites) never cross the bus
+ * - Sprites can draw them straight out of flash, or CopyRomImages puts them
+ *   in RAM slots (see gpulink::g_romImage)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <GpuLink.hpp>
+
+extern const int g_romImageCount;
+extern const uint8_t g_romImages[][gpulink::g_imageSize];
@@ -0,0 +1,53 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Reads fixed size packets from an I2C slave without ever waiting on the bus
+ * - Drives the I2C block's FIFOs directly, so a packet is spread across
+ *   however many scanlines it takes instead of stalling one of them
+ * - Used for both the logic MCU's command batches and the programmer's bulk
+ *   image data (see MigsSdk's GpuLink.hpp). They share a bus, so only one
+ *   link may have a read in flight at a time
+ * - Can also write a short message to the same slave, like the GPU's events
+ */
+
+#pragma once
+
+extern "C" {
+    #include <hardware/i2c.h>
+}
+
+// Gets every non-idle packet, whole
+typedef void (*PacketHandler)(const uint8_t *packet, const int len);
+
+class BulkLink {
+    public:
+        static const int maxPacketSize = 32;
+
+        BulkLink(
+            i2c_inst_t *i2c, const uint8_t addr, const int packetSize,
+            const uint32_t idleIntervalUs, PacketHandler onPacket
+        );
+
+        void poll(const bool mayStart); // Call often; never waits
+        bool idle(void) const; // Nothing in flight, so the bus is free
+
+        // Queues a write of up to a FIFO's worth, which poll() sees out. Only
+        // while the bus is free; a slave that NAKs just doesn't get it
+        bool send(const uint8_t *data, const int len);
+
+    private:
+        i2c_hw_t *_hw;
+        const uint8_t _addr;
+        const int _packetSize;
+        const uint32_t _idleIntervalUs; // Back off when there's nothing new
+        PacketHandler _onPacket;
+
+        bool _reading, _writing;
+        uint8_t _packet[maxPacketSize];
+        int _issued, _got;
+        uint32_t _startUs, _nextUs;
+
+        void _start(void);
+        void _pollWrite(void);
+        void _finish(const bool ok);
+};
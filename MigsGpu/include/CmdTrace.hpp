@@ -0,0 +1,58 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Binary trace of every command that comes over the I2C links, for finding
+ *   out what crossed the bus around a dropped frame
+ * - Recording one is a few stores into a ring in RAM. The ring goes out UART0
+ *   (GPIO 0/1) only as fast as its FIFO takes it, never waiting, so it's safe
+ *   to drain every scanline. tools/migstrace.py decodes it
+ * - Records are <g_traceSync> <op> <len> <frame:2> <time us:4> <xor of the
+ *   rest>, little endian. op is the GpuCommand or bulk packet type, and len
+ *   the bytes of arguments it had (g_traceBadLen if it was cut off or bad)
+ * - If the UART falls behind, new records are dropped and a g_traceDropped
+ *   record with how many goes out once there's room again
+ */
+
+#pragma once
+
+extern "C" {
+    #include <hardware/uart.h>
+}
+
+const uint32_t g_traceBaud = 921600;
+const uint8_t g_traceSync = 0xA5;
+const int g_traceRecordSize = 10;
+const int g_traceRingSize = 256; // Records (8 bytes each in RAM)
+
+// Ops that aren't commands
+const uint8_t g_traceDropped = 0x00; // len = records lost
+const uint8_t g_traceFrame = 0x01; // A frame started drawing
+const uint8_t g_traceBadLen = 0xFF;
+
+struct TraceRecord {
+    uint8_t op, len;
+    uint16_t frame;
+    uint32_t timeUs;
+};
+
+class CmdTrace {
+    public:
+        CmdTrace(uart_inst_t *uart);
+
+        void begin(void);
+        void frame(void); // Call as each frame starts
+        void record(const uint8_t op, const uint8_t len);
+        void drain(void); // Call often; never waits
+
+    private:
+        uart_inst_t *_uart;
+        TraceRecord _ring[g_traceRingSize];
+        int _head, _count;
+        uint16_t _frame;
+        uint32_t _dropped;
+        uint8_t _out[g_traceRecordSize]; // Record being sent
+        int _outInd;
+
+        bool _push(const uint8_t op, const uint8_t len);
+        void _encode(const TraceRecord &rec);
+};
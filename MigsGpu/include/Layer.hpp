@@ -0,0 +1,58 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - A palette framebuffer layer, drawn between the background and the
+ *   sprites, for things that are drawn once and kept (maps, charts, anything
+ *   that would otherwise take hundreds of sprites)
+ * - 2 or 4 bits a pixel, so a full screen fits (a 16bpp one wouldn't), or a
+ *   smaller window of it anywhere on screen. Palette colors are RGAB5515 and
+ *   ones without the alpha bit let what's under them through
+ * - Pixel, line, rect and blit calls draw into it in its own coordinates,
+ *   clipped to it. Nothing but drawScanline() touches the screen
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+const int g_layerMaxBytes = 480 * 270 / 2; // A full screen at 4bpp
+const int g_layerPaletteSize = 16;
+const uint16_t g_layerAlpha = 0x0020;
+
+class Layer {
+    public:
+        Layer(void);
+
+        // Clears it to index 0. bpp = 0 turns it off. False if it won't fit
+        bool setup(const int bpp, const int w, const int h);
+        void position(const int x, const int y); // Of its top left, on screen
+        void setPalette(const int index, const uint16_t color);
+        void setPen(const int index);
+
+        void pixel(const int x, const int y);
+        void line(int x0, int y0, const int x1, const int y1);
+        void rect(const int x, const int y, const int w, const int h);
+
+        // Pixels first to first + n - 1 of a w wide block, row by row, two a
+        // byte high nibble first (whatever the layer's bpp)
+        void blit(
+            const int x, const int y, const int w, const int first,
+            const int n, const uint8_t *nibbles
+        );
+
+        // Scroll moves what's shown left, wrapping around within the layer
+        void drawScanline(
+            uint16_t *pixBuff, const int y, const int width, const int scroll
+        ) const;
+
+    private:
+        uint8_t _bpp;
+        int16_t _x, _y, _w, _h;
+        int _stride; // Bytes a row
+        uint8_t _pen;
+        uint16_t _palette[g_layerPaletteSize];
+        uint8_t _pixels[g_layerMaxBytes];
+
+        void _set(const int x, const int y, const uint8_t index);
+        uint8_t _get(const uint8_t *row, const int x) const;
+};
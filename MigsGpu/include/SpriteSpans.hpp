@@ -0,0 +1,37 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Where each row of an 8x8 image is opaque, worked out whenever the image
+ *   is written, so drawing a sprite never tests alpha bits it doesn't have to
+ * - Per row, everything outside [left, right) is clear. A solid row is one
+ *   block copy of that part, fully opaque images being solid all the way
+ *   across; a row with holes alpha blits just that part; a clear one is
+ *   skipped
+ */
+
+#pragma once
+
+extern "C" {
+    #include <sprite.h>
+}
+#include <stdint.h>
+
+const int g_spanRows = 8; // Sprites are 1 << 3 px square
+
+struct RowSpan {
+    uint8_t left, right;
+    bool solid; // Nothing clear between left and right
+};
+
+struct ImageSpans {
+    RowSpan rows[g_spanRows];
+};
+
+void findSpans(ImageSpans &ref_spans, const uint8_t *img);
+
+// Line y of an image sprite, like sprite_sprite16 but off its spans. Not for
+// hflipped ones
+void drawSpans(
+    uint16_t *pixBuff, const sprite_t &spr, const ImageSpans &spans,
+    const int y, const int width
+);
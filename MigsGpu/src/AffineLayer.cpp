@@ -0,0 +1,154 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the affine tile background
+ */
+
+extern "C" {
+    #include <hardware/interp.h>
+}
+#include <string.h>
+#include <algorithm>
+#include <AffineLayer.hpp>
+
+const uint16_t g_affineAlpha = 0x0020;
+const int g_uvFracBits = 16; // Texture coordinates are 16.16 while drawing
+const int g_logTileSize = 3; // 8 px
+
+static int log2Side(const int side) {
+    for(int bits = 1; (1 << bits) <= gpulink::g_affineMaxSide; bits++) {
+        if(side == (1 << bits)) {
+            return bits;
+        }
+    }
+    return 0;
+}
+
+AffineLayer::AffineLayer(const uint8_t *tiles) :
+        _tiles(tiles), _logW(0), _logH(0),
+        _edge(gpulink::AffineEdge::Wrap),
+        _pa(gpulink::g_affineUnit), _pb(0), _pc(0),
+        _pd(gpulink::g_affineUnit),
+        _u(0), _v(0), _x(0), _y(0) {
+}
+
+bool AffineLayer::setup(
+        const int w, const int h, const gpulink::AffineEdge edge) {
+    _logW = 0;
+    if(w == 0) {
+        return true;
+    }
+    int logW = log2Side(w), logH = log2Side(h);
+    if((logW == 0) || (logH == 0) || (w * h > gpulink::g_affineMaxCells)) {
+        return false;
+    }
+    memset(_cells, 0, w * h);
+    _edge = edge;
+    _logH = logH;
+    _logW = logW;
+
+    // Both step u and v (lane 0 and 1) by the per pixel deltas in their
+    // bases and add what the lanes pick out of them
+    int cellShift = g_uvFracBits + g_logTileSize;
+    interp_config cfg = interp_default_config();
+    interp_config_set_add_raw(&cfg, true);
+    interp_config_set_shift(&cfg, cellShift);
+    interp_config_set_mask(&cfg, 0, logW - 1);
+    interp_set_config(interp0, 0, &cfg);
+    interp_config_set_shift(&cfg, cellShift - logW);
+    interp_config_set_mask(&cfg, logW, logW + logH - 1);
+    interp_set_config(interp0, 1, &cfg);
+    interp_set_base(interp0, 2, 0);
+
+    // Byte offset of the pixel in its tile: 2 a pixel, 16 a row
+    interp_config_set_shift(&cfg, g_uvFracBits - 1);
+    interp_config_set_mask(&cfg, 1, g_logTileSize);
+    interp_set_config(interp1, 0, &cfg);
+    interp_config_set_shift(&cfg, g_uvFracBits - (g_logTileSize + 1));
+    interp_config_set_mask(&cfg, g_logTileSize + 1, 2 * g_logTileSize);
+    interp_set_config(interp1, 1, &cfg);
+    interp_set_base(interp1, 2, 0);
+    return true;
+}
+
+void AffineLayer::setCells(
+        const int first, const int count, const uint8_t *slots) {
+    int cells = 1 << (_logW + _logH);
+    int n = std::min(count, cells - first);
+    if((_logW > 0) && (first >= 0) && (n > 0)) {
+        memcpy(&_cells[first], slots, n);
+    }
+}
+
+void AffineLayer::fillCells(
+        const int first, const int count, const uint8_t slot) {
+    int cells = 1 << (_logW + _logH);
+    int n = std::min(count, cells - first);
+    if((_logW > 0) && (first >= 0) && (n > 0)) {
+        memset(&_cells[first], slot, n);
+    }
+}
+
+void AffineLayer::matrix(
+        const int16_t pa, const int16_t pb,
+        const int16_t pc, const int16_t pd) {
+    _pa = pa;
+    _pb = pb;
+    _pc = pc;
+    _pd = pd;
+}
+
+void AffineLayer::origin(
+        const int16_t u, const int16_t v, const int16_t x, const int16_t y) {
+    _u = u;
+    _v = v;
+    _x = x;
+    _y = y;
+}
+
+void AffineLayer::drawScanline(
+        uint16_t *pixBuff, const int y, const int width,
+        const uint16_t *scales, const uint16_t *rows) const {
+    if(_logW == 0) {
+        return;
+    }
+    int32_t scale = scales ? scales[y] : gpulink::g_affineUnit;
+    if(scale == 0) {
+        return;
+    }
+    int32_t row = rows ? (int16_t) rows[y] : y - _y;
+
+    // The 8.8 matrix times the 8.8 scale is already 16.16. Wrapping in 32
+    // bits only moves where in a repeating map it is
+    int64_t col = -_x;
+    uint32_t du = _pa * (int64_t) scale, dv = _pc * (int64_t) scale;
+    uint32_t u = _u * 4096 + (int64_t) scale * (_pa * col + _pb * row);
+    uint32_t v = _v * 4096 + (int64_t) scale * (_pc * col + _pd * row);
+    interp_set_accumulator(interp0, 0, u);
+    interp_set_accumulator(interp0, 1, v);
+    interp_set_base(interp0, 0, du);
+    interp_set_base(interp0, 1, dv);
+    interp_set_accumulator(interp1, 0, u);
+    interp_set_accumulator(interp1, 1, v);
+    interp_set_base(interp1, 0, du);
+    interp_set_base(interp1, 1, dv);
+
+    // Anything past the map in either direction, negative too, has bits
+    // above its last cell's
+    bool clip = _edge == gpulink::AffineEdge::Clear;
+    int uBits = g_uvFracBits + g_logTileSize + _logW;
+    int vBits = g_uvFracBits + g_logTileSize + _logH;
+    for(int x = 0; x < width; x++) {
+        bool outside = clip && (
+            (interp_get_accumulator(interp0, 0) >> uBits)
+            || (interp_get_accumulator(interp0, 1) >> vBits)
+        );
+        const uint8_t *tile =
+            &_tiles[_cells[interp_pop_full_result(interp0)]
+                * gpulink::g_imageSize];
+        uint16_t color =
+            *(const uint16_t *) &tile[interp_pop_full_result(interp1)];
+        if(!outside && (color & g_affineAlpha)) {
+            pixBuff[x] = color;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the non-blocking packet reader
+ */
+
+extern "C" {
+    #include <pico/stdlib.h>
+    #include <hardware/i2c.h>
+}
+#include <GpuLink.hpp>
+#include <BulkLink.hpp>
+
+const int g_fifoDepth = 16;
+const uint32_t g_timeoutUs = 10000; // Give up on a stuck read
+
+BulkLink::BulkLink(
+        i2c_inst_t *i2c, const uint8_t addr, const int packetSize,
+        const uint32_t idleIntervalUs, PacketHandler onPacket) :
+        _hw(i2c_get_hw(i2c)), _addr(addr), _packetSize(packetSize),
+        _idleIntervalUs(idleIntervalUs), _onPacket(onPacket),
+        _reading(false), _writing(false), _issued(0), _got(0),
+        _startUs(0), _nextUs(0) {
+}
+
+void BulkLink::poll(const bool mayStart) {
+    if(_writing) {
+        _pollWrite();
+        return;
+    }
+    if(!_reading) {
+        if(!mayStart || (static_cast<int32_t>(time_us_32() - _nextUs) < 0)) {
+            return;
+        }
+        _start();
+    }
+
+    // A NAK (slave not there) or our own abort below
+    if(_hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void) _hw->clr_tx_abrt;
+        _finish(false);
+        return;
+    }
+
+    // Queue read commands as the FIFO frees up, stopping after the last
+    while((_issued < _packetSize) && (_hw->txflr < g_fifoDepth)) {
+        bool last = _issued == _packetSize - 1;
+        _hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS
+            | (last ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+        _issued++;
+    }
+    while((_got < _issued) && (_hw->rxflr > 0)) {
+        _packet[_got++] = static_cast<uint8_t>(_hw->data_cmd);
+    }
+
+    if(_got == _packetSize) {
+        _finish(true);
+    } else if(time_us_32() - _startUs >= g_timeoutUs) {
+        _hw->enable = I2C_IC_ENABLE_ENABLE_BITS | I2C_IC_ENABLE_ABORT_BITS;
+    }
+}
+
+bool BulkLink::idle(void) const {
+    return !_reading && !_writing;
+}
+
+bool BulkLink::send(const uint8_t *data, const int len) {
+    if(!idle() || (len < 1) || (len > g_fifoDepth)) {
+        return false;
+    }
+    _hw->enable = 0;
+    _hw->tar = _addr;
+    _hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+    for(int i = 0; i < len; i++) {
+        _hw->data_cmd = data[i]
+            | ((i == len - 1) ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+    }
+    _writing = true;
+    _startUs = time_us_32();
+    return true;
+}
+
+void BulkLink::_start(void) {
+    _hw->enable = 0;
+    _hw->tar = _addr;
+    _hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+    _reading = true;
+    _issued = _got = 0;
+    _startUs = time_us_32();
+}
+
+// Done once the FIFO has drained and the stop is out, or on a NAK
+void BulkLink::_pollWrite(void) {
+    if(_hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void) _hw->clr_tx_abrt;
+        _writing = false;
+    } else if((_hw->txflr == 0)
+            && !(_hw->status & I2C_IC_STATUS_ACTIVITY_BITS)) {
+        _writing = false;
+    } else if(time_us_32() - _startUs >= g_timeoutUs) {
+        _hw->enable = I2C_IC_ENABLE_ENABLE_BITS | I2C_IC_ENABLE_ABORT_BITS;
+    }
+}
+
+void BulkLink::_finish(const bool ok) {
+    _reading = false;
+    bool idle = !ok || (_packet[0] == gpulink::g_linkIdle);
+    _nextUs = time_us_32() + (idle ? _idleIntervalUs : 0);
+    if(!idle) {
+        _onPacket(_packet, _got);
+    }
+}
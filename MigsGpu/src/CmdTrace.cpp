@@ -0,0 +1,83 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the command trace
+ */
+
+extern "C" {
+    #include <pico/stdlib.h>
+    #include <hardware/uart.h>
+}
+#include <CmdTrace.hpp>
+
+CmdTrace::CmdTrace(uart_inst_t *uart) :
+        _uart(uart), _head(0), _count(0), _frame(0), _dropped(0),
+        _outInd(g_traceRecordSize) {
+}
+
+void CmdTrace::begin(void) {
+    uart_init(_uart, g_traceBaud);
+    gpio_set_function(0, GPIO_FUNC_UART);
+    gpio_set_function(1, GPIO_FUNC_UART);
+}
+
+void CmdTrace::frame(void) {
+    _frame++;
+    record(g_traceFrame, 0);
+}
+
+void CmdTrace::record(const uint8_t op, const uint8_t len) {
+    // Say how many were lost before anything newer, so the order holds
+    if(_dropped > 0) {
+        if(g_traceRingSize - _count < 2) {
+            _dropped++;
+            return;
+        }
+        uint8_t lost = (_dropped > 0xFF) ? 0xFF : _dropped;
+        _push(g_traceDropped, lost);
+        _dropped -= lost;
+    }
+    if(!_push(op, len)) {
+        _dropped++;
+    }
+}
+
+void CmdTrace::drain(void) {
+    while(uart_is_writable(_uart)) {
+        if(_outInd == g_traceRecordSize) {
+            if(_count == 0) {
+                return;
+            }
+            int tail = (_head + g_traceRingSize - _count) % g_traceRingSize;
+            _encode(_ring[tail]);
+            _count--;
+        }
+        uart_putc_raw(_uart, _out[_outInd++]);
+    }
+}
+
+bool CmdTrace::_push(const uint8_t op, const uint8_t len) {
+    if(_count == g_traceRingSize) {
+        return false;
+    }
+    _ring[_head] = TraceRecord { op, len, _frame, time_us_32() };
+    _head = (_head + 1) % g_traceRingSize;
+    _count++;
+    return true;
+}
+
+void CmdTrace::_encode(const TraceRecord &rec) {
+    _out[0] = g_traceSync;
+    _out[1] = rec.op;
+    _out[2] = rec.len;
+    _out[3] = rec.frame & 0xFF;
+    _out[4] = rec.frame >> 8;
+    for(int i = 0; i < 4; i++) {
+        _out[5 + i] = (rec.timeUs >> (i * 8)) & 0xFF;
+    }
+    uint8_t check = 0;
+    for(int i = 1; i < g_traceRecordSize - 1; i++) {
+        check ^= _out[i];
+    }
+    _out[g_traceRecordSize - 1] = check;
+    _outInd = 0;
+}
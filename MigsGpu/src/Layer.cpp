@@ -0,0 +1,142 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the palette framebuffer layer
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <Layer.hpp>
+
+Layer::Layer(void) :
+        _bpp(0), _x(0), _y(0), _w(0), _h(0), _stride(0), _pen(0),
+        _palette {} {
+}
+
+bool Layer::setup(const int bpp, const int w, const int h) {
+    _bpp = 0;
+    if(bpp == 0) {
+        return true;
+    }
+    int stride = (w * bpp + 7) / 8;
+    if(
+            ((bpp != 2) && (bpp != 4)) || (w <= 0) || (h <= 0)
+            || (stride * h > g_layerMaxBytes)) {
+        return false;
+    }
+    _w = w;
+    _h = h;
+    _stride = stride;
+    memset(_pixels, 0, stride * h);
+    _bpp = bpp;
+    return true;
+}
+
+void Layer::position(const int x, const int y) {
+    _x = x;
+    _y = y;
+}
+
+void Layer::setPalette(const int index, const uint16_t color) {
+    if(index < g_layerPaletteSize) {
+        _palette[index] = color;
+    }
+}
+
+void Layer::setPen(const int index) {
+    _pen = index;
+}
+
+void Layer::pixel(const int x, const int y) {
+    _set(x, y, _pen);
+}
+
+// Bresenham, all octants
+void Layer::line(int x0, int y0, const int x1, const int y1) {
+    int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+    int err = dx + dy;
+    while(true) {
+        _set(x0, y0, _pen);
+        if((x0 == x1) && (y0 == y1)) {
+            break;
+        }
+        int err2 = 2 * err;
+        if(err2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if(err2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void Layer::rect(const int x, const int y, const int w, const int h) {
+    int left = std::max(x, 0), right = std::min(x + w, (int) _w);
+    int top = std::max(y, 0), bottom = std::min(y + h, (int) _h);
+    for(int row = top; row < bottom; row++) {
+        for(int col = left; col < right; col++) {
+            _set(col, row, _pen);
+        }
+    }
+}
+
+void Layer::blit(
+        const int x, const int y, const int w, const int first,
+        const int n, const uint8_t *nibbles) {
+    if(w <= 0) {
+        return;
+    }
+    for(int i = 0; i < n; i++) {
+        uint8_t byte = nibbles[i / 2];
+        uint8_t index = (i & 1) ? (byte & 0x0F) : (byte >> 4);
+        int px = first + i;
+        _set(x + px % w, y + px / w, index);
+    }
+}
+
+void Layer::drawScanline(
+        uint16_t *pixBuff, const int y, const int width,
+        const int scroll) const {
+    if((_bpp == 0) || (y < _y) || (y >= _y + _h)) {
+        return;
+    }
+    const uint8_t *row = &_pixels[(y - _y) * _stride];
+    int left = std::max((int) _x, 0), right = std::min(_x + _w, width);
+    int col = ((left - _x + scroll) % _w + _w) % _w;
+    for(int x = left; x < right; x++) {
+        uint16_t color = _palette[_get(row, col)];
+        if(color & g_layerAlpha) {
+            pixBuff[x] = color;
+        }
+        if(++col == _w) {
+            col = 0;
+        }
+    }
+}
+
+void Layer::_set(const int x, const int y, const uint8_t index) {
+    if((_bpp == 0) || (x < 0) || (y < 0) || (x >= _w) || (y >= _h)) {
+        return;
+    }
+    uint8_t *row = &_pixels[y * _stride];
+    if(_bpp == 4) {
+        int shift = (x & 1) ? 0 : 4;
+        row[x / 2] = (row[x / 2] & ~(0x0F << shift))
+            | ((index & 0x0F) << shift);
+    } else {
+        int shift = (3 - (x & 3)) * 2;
+        row[x / 4] = (row[x / 4] & ~(0x03 << shift))
+            | ((index & 0x03) << shift);
+    }
+}
+
+// High bits are the leftmost pixel
+uint8_t Layer::_get(const uint8_t *row, const int x) const {
+    if(_bpp == 4) {
+        return (row[x / 2] >> ((x & 1) ? 0 : 4)) & 0x0F;
+    }
+    return (row[x / 4] >> ((3 - (x & 3)) * 2)) & 0x03;
+}
@@ -0,0 +1,54 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the sprite row spans
+ */
+
+#include <algorithm>
+#include <SpriteSpans.hpp>
+
+const uint16_t g_spanAlpha = 0x0020;
+
+void findSpans(ImageSpans &ref_spans, const uint8_t *img) {
+    const uint16_t *pixels = (const uint16_t *) img;
+    for(int y = 0; y < g_spanRows; y++) {
+        const uint16_t *row = &pixels[y * g_spanRows];
+        int left = 0, right = g_spanRows, opaque = 0;
+        while((left < right) && !(row[left] & g_spanAlpha)) {
+            left++;
+        }
+        while((right > left) && !(row[right - 1] & g_spanAlpha)) {
+            right--;
+        }
+        for(int x = left; x < right; x++) {
+            opaque += (row[x] & g_spanAlpha) ? 1 : 0;
+        }
+        ref_spans.rows[y] = RowSpan {
+            (uint8_t) left, (uint8_t) right, opaque == right - left
+        };
+    }
+}
+
+void drawSpans(
+        uint16_t *pixBuff, const sprite_t &spr, const ImageSpans &spans,
+        const int y, const int width) {
+    int ty = y - spr.y;
+    if((ty < 0) || (ty >= g_spanRows)) {
+        return;
+    }
+    if(spr.vflip) {
+        ty = g_spanRows - 1 - ty;
+    }
+    const RowSpan &row = spans.rows[ty];
+    int left = std::max(spr.x + row.left, 0);
+    int right = std::min(spr.x + row.right, width);
+    if(left >= right) {
+        return;
+    }
+    const uint16_t *src = (const uint16_t *) spr.img
+        + ty * g_spanRows + (left - spr.x);
+    if(row.solid) {
+        sprite_blit16(&pixBuff[left], src, right - left);
+    } else {
+        sprite_blit16_alpha(&pixBuff[left], src, right - left);
+    }
+}
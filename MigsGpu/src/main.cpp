@@ -19,42 +19,158 @@ extern "C" {
     #include <hardware/irq.h>
     #include <hardware/sync.h>
     #include <hardware/i2c.h>
+    #include <hardware/watchdog.h>
     #include <dvi.h>
     #include <dvi_timing.h>
     #include <sprite.h>
     #include <common_dvi_pin_configs.h>
 }
+#include <string.h>
+#include <algorithm>
 #include <vector>
+#include <GpuLink.hpp>
+#include <BulkLink.hpp>
+#include <CmdTrace.hpp>
+#include <Layer.hpp>
+#include <AssetRom.hpp>
+#include <SpriteSpans.hpp>
+#include <AffineLayer.hpp>
 
-// DVDD 1.2V
-#define VREG_VSEL       VREG_VOLTAGE_1_20
-#define DVI_TIMING      dvi_timing_960x540p_60hz
+// gpulink::VideoMode it powers on in (SetVideoMode can restart it in another)
+#ifndef MIGS_VIDEO_MODE
+#define MIGS_VIDEO_MODE 0
+#endif
 
 // I only program in 'MURICAN
 #define q_color_free    q_colour_free
 #define q_color_valid   q_colour_valid
 
+void selectMode(void);
 void initDvi(void);
 void drawTextScanline(int y);
 void drawScanline(const uint16_t *scanLine);
 
 void initI2c(void);
 char detectCpu(void);
+void onCpuPacket(const uint8_t *packet, const int len);
+void onBulkPacket(const uint8_t *packet, const int len);
+void drawSprites(uint16_t *pixBuff, const int y, const int16_t scroll);
+void startAnim(const size_t id, const uint16_t anim);
+void animateSprites(void);
+void moveSprites(void);
+void sendEvents(void);
+void queueEvent(const gpulink::GpuEvent kind, const uint16_t id);
+uint32_t imageHash(const uint8_t *data);
+void hashImage(const int slot);
+const ImageSpans &imageSpans(const void *img);
 
-const int g_cpuI2cAddr = 0x7C;
-const int g_frameWidth = 480;
-const int g_frameHeight = 270;
+const int g_maxFrameWidth = 480;
 const int g_scanBuffCount = 4;
+const int g_maxImages = 256; // Fixed, so sprites can point into it
+const uint32_t g_cpuPollUs = 2000; // Between polls while the CPU is quiet
+const uint32_t g_pgrmrPollUs = 16000; // Uploads are rare, so back off more
+const int g_maxEvents = 16; // Waiting to go to the logic MCU
+const uint32_t g_modeMagic = 0x4D494753; // "MIGS" in watchdog scratch 0
+
+// The DVI mode behind each gpulink::VideoMode, and the core voltage its bit
+// clock needs
+struct ModeTiming {
+    const dvi_timing *timing;
+    vreg_voltage vsel;
+};
+
+const ModeTiming g_modes[gpulink::g_videoModes] = {
+    { &dvi_timing_960x540p_60hz, VREG_VOLTAGE_1_20 },
+    { &dvi_timing_640x480p_60hz, VREG_VOLTAGE_1_10 },
+    { &dvi_timing_800x480p_60hz, VREG_VOLTAGE_1_20 },
+    { &dvi_timing_800x600p_60hz, VREG_VOLTAGE_1_30 }
+};
 
 struct SprBuff {
-    uint8_t data[8 * 8 * 2];
+    alignas(4) uint8_t data[gpulink::g_imageSize];
 };
 
+int g_mode = 0; // gpulink::VideoMode
+int g_frameWidth = 0, g_frameHeight = 0;
 dvi_inst g_dvi;
-uint16_t g_staticScanBuff[g_scanBuffCount][g_frameWidth];
+uint16_t g_staticScanBuff[g_scanBuffCount][g_maxFrameWidth];
 std::vector<sprite_t> g_sprs;
-std::vector<SprBuff> g_sprData;
+SprBuff g_sprData[g_maxImages];
+uint32_t g_imageHashes[g_maxImages]; // Valid while g_hashKnown
+bool g_hashKnown[g_maxImages]; // Only while the slot is partly written
+std::vector<uint32_t> g_romHashes; // Found at boot
+ImageSpans g_sprSpans[g_maxImages]; // Found again by every write to the slot
+std::vector<ImageSpans> g_romSpans; // Found at boot
 uint16_t g_bg = 0x0000;
+uint16_t g_glyphFg = 0xFFFF, g_glyphBg = 0x0000; // Opaque white on clear
+
+// Animations, and where each sprite is in the one it's playing
+struct Anim {
+    gpulink::AnimMode mode;
+    uint8_t count; // 0 until it's defined
+    gpulink::AnimStep steps[gpulink::g_animMaxSteps];
+};
+
+struct SprAnim {
+    uint16_t anim; // gpulink::g_animStop if it isn't playing one
+    uint8_t step, left; // left = frames until the next step
+    int8_t dir;
+};
+
+Anim g_anims[gpulink::g_maxAnims];
+std::vector<SprAnim> g_sprAnims; // Same order as g_sprs
+
+// Motion, in 1/256ths of a px so slow velocities still add up
+struct SprMotion {
+    int32_t x, y;
+    int16_t dx, dy;
+    gpulink::MotionEdge edge;
+    gpulink::Ease ease;
+    uint8_t frames, elapsed; // A tween, while frames isn't 0
+    int16_t fromX, fromY, toX, toY;
+};
+
+std::vector<SprMotion> g_sprMotions; // Same order as g_sprs
+
+// Rects take sprite ids, so they share the z order, but are drawn as spans
+struct SprShape {
+    uint16_t w, h; // 0 for an image sprite
+    uint16_t color;
+    gpulink::ShapeFill fill;
+};
+
+std::vector<SprShape> g_sprShapes; // Same order as g_sprs
+SprShape g_shapeStyle = { 0, 0, 0xFFFF, gpulink::ShapeFill::Filled };
+int16_t g_boundsLeft = 0, g_boundsTop = 0;
+int16_t g_boundsRight = 0, g_boundsBottom = 0; // The screen, once it's known
+
+// Written back to the logic MCU, see gpulink::GpuEvent
+struct Event {
+    gpulink::GpuEvent kind;
+    uint16_t id; // Sprite or image slot
+};
+
+Event g_events[g_maxEvents];
+int g_eventHead = 0, g_eventCount = 0;
+
+// Per scanline overrides (see gpulink::RasterTable). Scroll is 0 until set
+uint16_t g_raster[gpulink::g_rasterTables][gpulink::g_rasterLines];
+bool g_rasterBg = false; // Background table in use instead of g_bg
+bool g_rasterScale = false, g_rasterRow = false; // Affine tables in use
+
+Layer g_layer; // Off until it's set up
+AffineLayer g_affine(g_sprData[0].data); // Same
+
+// Both slaves share i2c1, so only one of them is read at a time
+BulkLink g_cpuLink(
+    i2c1, gpulink::g_cpuI2cAddr, gpulink::g_cmdPacketSize, g_cpuPollUs,
+    onCpuPacket
+);
+BulkLink g_pgrmrLink(
+    i2c1, gpulink::g_pgrmrI2cAddr, gpulink::g_bulkPacketSize, g_pgrmrPollUs,
+    onBulkPacket
+);
+CmdTrace g_trace(uart0);
 
 // Do color buff/init in Core1
 void core1_main(void) {
@@ -69,16 +185,30 @@ void core1_main(void) {
 }
 
 int main() {
-    // Speed up the clock
-    vreg_set_voltage(VREG_VSEL);
+    // Speed up the clock, as far as the mode needs
+    selectMode();
+    vreg_set_voltage(g_modes[g_mode].vsel);
     sleep_ms(10);
-    set_sys_clock_khz(DVI_TIMING.bit_clk_khz, true);
+    set_sys_clock_khz(g_modes[g_mode].timing->bit_clk_khz, true);
 
     stdio_init_all();
-    setup_default_uart();
+    g_trace.begin(); // On the default UART's pins
 
     initI2c();
 
+    // Slots start out blank, and ROM images are copied with what's known of
+    // them, so FindImage never has to hash anything
+    for(int i = 0; i < g_maxImages; i++) {
+        hashImage(i);
+        findSpans(g_sprSpans[i], g_sprData[i].data);
+    }
+    g_romSpans.resize(g_romImageCount);
+    g_romHashes.resize(g_romImageCount);
+    for(int i = 0; i < g_romImageCount; i++) {
+        findSpans(g_romSpans[i], g_romImages[i]);
+        g_romHashes[i] = imageHash(g_romImages[i]);
+    }
+
     initDvi();
     multicore_launch_core1(core1_main);
 
@@ -88,84 +218,44 @@ int main() {
         queue_add_blocking((queue_t *) &g_dvi.q_color_free, &buffPtr);
     }
 
-    uint8_t drawCmd[8];
     while(true) {
+        g_trace.frame();
+        animateSprites();
+        moveSprites();
         for(int y = 0; y < g_frameHeight; y++) {
             uint16_t *pixBuff = nullptr;
             queue_remove_blocking(&g_dvi.q_color_free, &pixBuff);
-            sprite_fill16(pixBuff, g_bg, g_frameWidth);
-            for(size_t i = 0; i < g_sprs.size(); i++) {
-                sprite_sprite16(pixBuff, &g_sprs[i], y, g_frameWidth);
-            }
+            sprite_fill16(
+                pixBuff,
+                g_rasterBg
+                    ? g_raster[(int) gpulink::RasterTable::Background][y]
+                    : g_bg,
+                g_frameWidth
+            );
+            g_affine.drawScanline(
+                pixBuff, y, g_frameWidth,
+                g_rasterScale
+                    ? g_raster[(int) gpulink::RasterTable::AffineScale]
+                    : nullptr,
+                g_rasterRow
+                    ? g_raster[(int) gpulink::RasterTable::AffineRow]
+                    : nullptr
+            );
+            g_layer.drawScanline(
+                pixBuff, y, g_frameWidth,
+                g_raster[(int) gpulink::RasterTable::LayerScroll][y]
+            );
+            drawSprites(
+                pixBuff, y,
+                g_raster[(int) gpulink::RasterTable::SpriteScroll][y]
+            );
             queue_add_blocking(&g_dvi.q_color_valid, &pixBuff);
-        }
 
-        if(i2c_read_blocking(i2c1, g_cpuI2cAddr, drawCmd, 1, true) > 0) {
-            switch(drawCmd[0]) {
-                // Do nothing
-                case 0x55:
-                    break;
-
-                // Add sprite data (use sparingly; only at start - frame drops!)
-                case 'D': {
-                    SprBuff newSprData;
-                    printf("Read %d bytes!\n",
-                        i2c_read_blocking(
-                            i2c1, g_cpuI2cAddr, newSprData.data, 128, true
-                        )
-                    );
-                    printf("Received data:\n");
-                    for(int y = 0; y < 8; y++) {
-                        printf("- ");
-                        for(int x = 0; x < 8; x++) {
-                            printf(
-                                "(%x,%x) ",
-                                newSprData.data[(y * 8 + x) * 2],
-                                newSprData.data[(y * 8 + x) * 2 + 1]
-                            );
-                        }
-                        printf("\n");
-                    }
-                    g_sprData.push_back(newSprData);
-                } break;
-
-                // Add a sprite
-                case 'S': {
-                    i2c_read_blocking(
-                        i2c1, g_cpuI2cAddr, drawCmd, 6, true
-                    );
-
-                    uint16_t x = (((uint16_t) drawCmd[0]) << 8) + drawCmd[1];
-                    uint16_t y = (((uint16_t) drawCmd[2]) << 8) + drawCmd[3];
-                    uint16_t img = (((uint16_t) drawCmd[4]) << 8) + drawCmd[5];
-
-                    printf(
-                        "Drawing sprite: %d:%d, %d:%d, %d:%d\n",
-                        drawCmd[0], drawCmd[1],
-                        drawCmd[2], drawCmd[3],
-                        drawCmd[4], drawCmd[5]
-                    );
-
-                    g_sprs.push_back(sprite_t {
-                        x, y,
-                        g_sprData[img].data,
-                        3, false,
-                        false, false
-                    });
-                };
-
-                // Set background
-                case 'B':
-                    printf(
-                        "Setting background: %x:%x\n",
-                        drawCmd[0], drawCmd[1]
-                    );
-                    i2c_read_blocking(
-                        i2c1, g_cpuI2cAddr, drawCmd, 2, true
-                    );
-                    g_bg = (((uint16_t) drawCmd[0]) << 8) + drawCmd[1];
-                    break;
-            }
+            // The logic MCU goes first whenever the bus is free
+            g_cpuLink.poll(g_pgrmrLink.idle());
+            g_pgrmrLink.poll(g_cpuLink.idle());
+            sendEvents();
+            g_trace.drain();
         }
     }
 
@@ -173,9 +263,34 @@ int main() {
 }
 
 // DVI-specific functions
+
+// The watchdog's scratch registers keep a mode asked for over the restart,
+// and are cleared by a power cycle
+void selectMode(void) {
+    g_mode = MIGS_VIDEO_MODE;
+    if(
+            (watchdog_hw->scratch[0] == g_modeMagic)
+            && (watchdog_hw->scratch[1] < gpulink::g_videoModes)) {
+        g_mode = watchdog_hw->scratch[1];
+    }
+    g_frameWidth = gpulink::g_modeWidths[g_mode];
+    g_frameHeight = gpulink::g_modeHeights[g_mode];
+    g_boundsRight = g_frameWidth;
+    g_boundsBottom = g_frameHeight;
+}
+
+void restartInMode(const int mode) {
+    watchdog_hw->scratch[0] = g_modeMagic;
+    watchdog_hw->scratch[1] = mode;
+    watchdog_reboot(0, 0, 0);
+    while(true) {
+        __wfe();
+    }
+}
+
 void initDvi(void) {
     // Set up DVI
-    g_dvi.timing = &DVI_TIMING;
+    g_dvi.timing = g_modes[g_mode].timing;
     g_dvi.ser_cfg = DVI_DEFAULT_SERIAL_CONFIG;
     dvi_init(
         &g_dvi,
@@ -191,3 +306,802 @@ void initI2c(void) {
     gpio_pull_up(2);
     gpio_pull_up(3);
 }
+
+void fillSpan(uint16_t *pixBuff, int left, int right, const uint16_t color) {
+    left = std::max(left, 0);
+    right = std::min(right, g_frameWidth);
+    if(left < right) {
+        std::fill_n(&pixBuff[left], right - left, color);
+    }
+}
+
+// A rect's part of line y: all of it, or just its sides if it's an outline
+// and y isn't its top or bottom. No alpha bit means nothing shows
+void drawRect(
+        uint16_t *pixBuff, const sprite_t &spr, const SprShape &shape,
+        const int y) {
+    int row = y - spr.y;
+    if((row < 0) || (row >= shape.h) || !(shape.color & 0x0020)) {
+        return;
+    }
+    if(
+            (shape.fill == gpulink::ShapeFill::Filled)
+            || (row == 0) || (row == shape.h - 1)) {
+        fillSpan(pixBuff, spr.x, spr.x + shape.w, shape.color);
+    } else {
+        fillSpan(pixBuff, spr.x, spr.x + 1, shape.color);
+        fillSpan(pixBuff, spr.x + shape.w - 1, spr.x + shape.w, shape.color);
+    }
+}
+
+// Shifted left by this line's scroll, which costs nothing when it's 0
+void drawSprites(uint16_t *pixBuff, const int y, const int16_t scroll) {
+    for(size_t i = 0; i < g_sprs.size(); i++) {
+        sprite_t &spr = g_sprs[i];
+        spr.x -= scroll;
+        if(g_sprShapes[i].w > 0) {
+            drawRect(pixBuff, spr, g_sprShapes[i], y);
+        } else if(spr.hflip) {
+            sprite_sprite16(pixBuff, &spr, y, g_frameWidth);
+        } else {
+            drawSpans(pixBuff, spr, imageSpans(spr.img), y, g_frameWidth);
+        }
+        spr.x += scroll;
+    }
+}
+
+// A RAM slot, or an image of the asset ROM (gpulink::g_romImage). Out of
+// range ones wrap, so a sprite never points outside either
+const uint8_t *imageData(const uint16_t img) {
+    if((img & gpulink::g_romImage) && (g_romImageCount > 0)) {
+        return g_romImages[(img & ~gpulink::g_romImage) % g_romImageCount];
+    }
+    return g_sprData[img % g_maxImages].data;
+}
+
+// Spans of whatever imageData() handed a sprite
+const ImageSpans &imageSpans(const void *img) {
+    const uint8_t *data = (const uint8_t *) img;
+    const uint8_t *slots = g_sprData[0].data;
+    if((data >= slots) && (data < slots + sizeof(g_sprData))) {
+        return g_sprSpans[(data - slots) / gpulink::g_imageSize];
+    }
+    return g_romSpans[(data - g_romImages[0]) / gpulink::g_imageSize];
+}
+
+// Every write to a slot ends here, so its hash and spans stay true. end is
+// where the write stopped: uploads come in order, so a slot is hashed once
+// its last piece is in, however many pieces it came in
+void imageChanged(const int slot, const int end) {
+    g_hashKnown[slot] = false;
+    if(end == gpulink::g_imageSize) {
+        hashImage(slot);
+    }
+    findSpans(g_sprSpans[slot], g_sprData[slot].data);
+}
+
+// Big endian, like everything else on the bus
+uint16_t readU16(const uint8_t *data) {
+    return (((uint16_t) data[0]) << 8) + data[1];
+}
+
+// <slot:2> <offset> <len> <data...>, returns bytes used or -1 if it's bad
+int writeImage(const uint8_t *cmd, const int avail) {
+    if(avail < 4) {
+        return -1;
+    }
+    int slot = readU16(cmd);
+    int offset = cmd[2];
+    int dataLen = cmd[3];
+    if(
+            (4 + dataLen > avail) || (slot >= g_maxImages)
+            || (offset + dataLen > gpulink::g_imageSize)) {
+        return -1;
+    }
+    memcpy(&g_sprData[slot].data[offset], &cmd[4], dataLen);
+    imageChanged(slot, offset + dataLen);
+    return 4 + dataLen;
+}
+
+// <slot:2> <row bytes:8>, each set bit becoming the fg color
+int expandGlyph(const uint8_t *cmd, const int avail) {
+    if(avail < 2 + gpulink::g_glyphSize) {
+        return -1;
+    }
+    int slot = readU16(cmd) % g_maxImages;
+    uint16_t *pixels = (uint16_t *) g_sprData[slot].data;
+    for(int y = 0; y < gpulink::g_glyphSize; y++) {
+        uint8_t row = cmd[2 + y];
+        for(int x = 0; x < 8; x++) {
+            pixels[y * 8 + x] = (row & (0x80 >> x)) ? g_glyphFg : g_glyphBg;
+        }
+    }
+    imageChanged(slot, gpulink::g_imageSize);
+    return 2 + gpulink::g_glyphSize;
+}
+
+uint32_t imageHash(const uint8_t *data) {
+    uint32_t hash = gpulink::g_hashStart;
+    for(int i = 0; i < gpulink::g_imageSize; i++) {
+        hash = gpulink::hashByte(hash, data[i]);
+    }
+    return hash;
+}
+
+void hashImage(const int slot) {
+    g_imageHashes[slot] = imageHash(g_sprData[slot].data);
+    g_hashKnown[slot] = true;
+}
+
+// <slot:2> <hash:4>. Slot itself first, since a program that's loaded
+// again usually puts everything back where it was. It runs between
+// scanlines, so it only compares hashes worked out when slots were written,
+// and a partly written slot never matches
+int findImage(const uint8_t *cmd, const int avail) {
+    if(avail < 6) {
+        return -1;
+    }
+    int slot = readU16(cmd);
+    if(slot >= g_maxImages) {
+        return -1;
+    }
+    uint32_t hash = (((uint32_t) readU16(&cmd[2])) << 16) + readU16(&cmd[4]);
+    bool found = g_hashKnown[slot] && (g_imageHashes[slot] == hash);
+    for(int i = 0; !found && (i < g_maxImages); i++) {
+        if((i != slot) && g_hashKnown[i] && (g_imageHashes[i] == hash)) {
+            memcpy(
+                g_sprData[slot].data, g_sprData[i].data, gpulink::g_imageSize
+            );
+            g_imageHashes[slot] = hash;
+            g_hashKnown[slot] = true;
+            g_sprSpans[slot] = g_sprSpans[i];
+            found = true;
+        }
+    }
+    queueEvent(
+        found ? gpulink::GpuEvent::ImageFound : gpulink::GpuEvent::ImageMissing,
+        slot
+    );
+    return 6;
+}
+
+// <slot:2> <rom image:2> <count:2>, as many as fit in the slots
+int copyRomImages(const uint8_t *cmd, const int avail) {
+    if(avail < 6) {
+        return -1;
+    }
+    int slot = readU16(&cmd[0]);
+    int first = readU16(&cmd[2]) & ~gpulink::g_romImage;
+    int count = std::min<int>(readU16(&cmd[4]), g_maxImages - slot);
+    count = std::min(count, g_romImageCount - first);
+    for(int i = 0; i < count; i++) {
+        memcpy(
+            g_sprData[slot + i].data, g_romImages[first + i],
+            gpulink::g_imageSize
+        );
+        g_imageHashes[slot + i] = g_romHashes[first + i];
+        g_hashKnown[slot + i] = true;
+        g_sprSpans[slot + i] = g_romSpans[first + i];
+    }
+    return 6;
+}
+
+// <anim> <mode> <count> (<img:2> <frames>)..., returns bytes used or -1
+int defineAnim(const uint8_t *cmd, const int avail) {
+    if(avail < 3) {
+        return -1;
+    }
+    int count = cmd[2];
+    if(
+            (3 + count * 3 > avail) || (count == 0)
+            || (count > gpulink::g_animMaxSteps)
+            || (cmd[0] >= gpulink::g_maxAnims)) {
+        return -1;
+    }
+    Anim &anim = g_anims[cmd[0]];
+    anim.mode = (gpulink::AnimMode) cmd[1];
+    anim.count = count;
+    for(int i = 0; i < count; i++) {
+        anim.steps[i].img = readU16(&cmd[3 + i * 3]);
+        anim.steps[i].frames = cmd[5 + i * 3];
+    }
+
+    // Anything playing it starts over, so none are past its end
+    for(size_t id = 0; id < g_sprAnims.size(); id++) {
+        if(g_sprAnims[id].anim == cmd[0]) {
+            startAnim(id, cmd[0]);
+        }
+    }
+    return 3 + count * 3;
+}
+
+void startAnim(const size_t id, const uint16_t anim) {
+    if((anim >= gpulink::g_maxAnims) || (g_anims[anim].count == 0)) {
+        g_sprAnims[id].anim = gpulink::g_animStop;
+        return;
+    }
+    const gpulink::AnimStep &first = g_anims[anim].steps[0];
+    g_sprAnims[id] = SprAnim {
+        anim, 0, (uint8_t) std::max<int>(first.frames, 1), 1
+    };
+    g_sprs[id].img = imageData(first.img);
+}
+
+// Once a frame, so animations cost no bus traffic after they're started
+void animateSprites(void) {
+    for(size_t id = 0; id < g_sprAnims.size(); id++) {
+        SprAnim &state = g_sprAnims[id];
+        if((state.anim == gpulink::g_animStop) || (--state.left > 0)) {
+            continue;
+        }
+
+        const Anim &anim = g_anims[state.anim];
+        int next = state.step + state.dir;
+        if((next < 0) || (next >= anim.count)) {
+            if(anim.mode == gpulink::AnimMode::Loop) {
+                next = 0;
+            } else if(
+                    (anim.mode == gpulink::AnimMode::PingPong)
+                    && (anim.count > 1)) {
+                state.dir = -state.dir;
+                next = state.step + state.dir;
+            } else {
+                state.anim = gpulink::g_animStop; // Done, on its last image
+                continue;
+            }
+        }
+        const gpulink::AnimStep &step = anim.steps[next];
+        state.step = next;
+        state.left = std::max<int>(step.frames, 1);
+        g_sprs[id].img = imageData(step.img);
+    }
+}
+
+// <table> <line:2> <count> <values:2...>, returns bytes used or -1
+// Some tables only take over from what they override once written
+void rasterWritten(const int table) {
+    g_rasterBg |= table == (int) gpulink::RasterTable::Background;
+    g_rasterScale |= table == (int) gpulink::RasterTable::AffineScale;
+    g_rasterRow |= table == (int) gpulink::RasterTable::AffineRow;
+}
+
+int writeRaster(const uint8_t *cmd, const int avail) {
+    if(avail < 4) {
+        return -1;
+    }
+    int line = readU16(&cmd[1]);
+    int count = cmd[3];
+    if(
+            (4 + count * 2 > avail) || (cmd[0] >= gpulink::g_rasterTables)
+            || (line + count > gpulink::g_rasterLines)) {
+        return -1;
+    }
+    for(int i = 0; i < count; i++) {
+        g_raster[cmd[0]][line + i] = readU16(&cmd[4 + i * 2]);
+    }
+    rasterWritten(cmd[0]);
+    return 4 + count * 2;
+}
+
+// <table:2> <line:2> <count:2> <value:2>
+int fillRaster(const uint8_t *cmd, const int avail) {
+    if(avail < 8) {
+        return -1;
+    }
+    int table = readU16(&cmd[0]);
+    int line = readU16(&cmd[2]);
+    int count = readU16(&cmd[4]);
+    if(
+            (table >= gpulink::g_rasterTables)
+            || (line + count > gpulink::g_rasterLines)) {
+        return -1;
+    }
+    std::fill_n(&g_raster[table][line], count, readU16(&cmd[6]));
+    rasterWritten(table);
+    return 8;
+}
+
+// <cell:2> <count> <slot>..., returns bytes used or -1
+int affineTiles(const uint8_t *cmd, const int avail) {
+    if(avail < 3) {
+        return -1;
+    }
+    int count = cmd[2];
+    if(3 + count > avail) {
+        return -1;
+    }
+    g_affine.setCells(readU16(cmd), count, &cmd[3]);
+    return 3 + count;
+}
+
+// <x:2> <y:2> <w> <first:2> <n> <indices...>, returns bytes used or -1
+int layerBlit(const uint8_t *cmd, const int avail) {
+    if(avail < 8) {
+        return -1;
+    }
+    int n = cmd[7];
+    int bytes = (n + 1) / 2;
+    if(8 + bytes > avail) {
+        return -1;
+    }
+    g_layer.blit(
+        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]), cmd[4],
+        readU16(&cmd[5]), n, &cmd[8]
+    );
+    return 8 + bytes;
+}
+
+// t and the result go from 0 to 256 over a tween
+int ease(const gpulink::Ease kind, const int t) {
+    switch(kind) {
+        case gpulink::Ease::In:
+            return t * t / 256;
+        case gpulink::Ease::Out:
+            return 256 - (256 - t) * (256 - t) / 256;
+        case gpulink::Ease::InOut:
+            return t * t * (3 * 256 - 2 * t) / (256 * 256);
+        default:
+            return t;
+    }
+}
+
+// One axis of a moving sprite against the motion bounds
+void applyEdge(
+        int32_t &ref_pos, int16_t &ref_vel, const int lo, const int hi,
+        const int size, const gpulink::MotionEdge edge) {
+    int32_t min = lo * 256;
+    int32_t max = (hi - size) * 256; // Whole sprite inside
+    switch(edge) {
+        case gpulink::MotionEdge::Wrap: {
+            int32_t span = (hi - lo) * 256;
+            if(span > 0) {
+                ref_pos = min + ((ref_pos - min) % span + span) % span;
+            }
+            break;
+        }
+        case gpulink::MotionEdge::Bounce:
+            if(ref_pos < min) {
+                ref_pos = std::min(2 * min - ref_pos, max);
+                ref_vel = -ref_vel;
+            } else if(ref_pos > max) {
+                ref_pos = std::max(2 * max - ref_pos, min);
+                ref_vel = -ref_vel;
+            }
+            break;
+        case gpulink::MotionEdge::Stop:
+            if((ref_pos < min) || (ref_pos > max)) {
+                ref_pos = std::max(std::min(ref_pos, max), min);
+                ref_vel = 0;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void queueEvent(const gpulink::GpuEvent kind, const uint16_t id) {
+    if(g_eventCount == g_maxEvents) {
+        return; // The logic MCU isn't keeping up, so it misses this one
+    }
+    g_events[(g_eventHead + g_eventCount) % g_maxEvents] = Event { kind, id };
+    g_eventCount++;
+}
+
+// Keeps the image answers, which don't depend on sprite ids
+void dropTweenEvents(void) {
+    int kept = 0;
+    for(int i = 0; i < g_eventCount; i++) {
+        const Event &event = g_events[(g_eventHead + i) % g_maxEvents];
+        if(event.kind != gpulink::GpuEvent::TweenDone) {
+            g_events[(g_eventHead + kept++) % g_maxEvents] = event;
+        }
+    }
+    g_eventCount = kept;
+}
+
+// Once a frame, like animations. A tween holds the sprite's velocity
+void moveSprites(void) {
+    for(size_t id = 0; id < g_sprMotions.size(); id++) {
+        SprMotion &motion = g_sprMotions[id];
+        sprite_t &spr = g_sprs[id];
+        if(motion.frames > 0) {
+            motion.elapsed++;
+            int e = ease(motion.ease, motion.elapsed * 256 / motion.frames);
+            spr.x = motion.fromX + (motion.toX - motion.fromX) * e / 256;
+            spr.y = motion.fromY + (motion.toY - motion.fromY) * e / 256;
+            motion.x = spr.x * 256;
+            motion.y = spr.y * 256;
+            if(motion.elapsed == motion.frames) {
+                motion.frames = 0;
+                queueEvent(gpulink::GpuEvent::TweenDone, id);
+            }
+            continue;
+        }
+        if((motion.dx == 0) && (motion.dy == 0)) {
+            continue;
+        }
+
+        const SprShape &shape = g_sprShapes[id];
+        int w = shape.w ? shape.w : (1 << spr.log_size);
+        int h = shape.w ? shape.h : (1 << spr.log_size);
+        motion.x += motion.dx;
+        motion.y += motion.dy;
+        applyEdge(
+            motion.x, motion.dx, g_boundsLeft, g_boundsRight, w, motion.edge
+        );
+        applyEdge(
+            motion.y, motion.dy, g_boundsTop, g_boundsBottom, h, motion.edge
+        );
+        spr.x = motion.x >> 8;
+        spr.y = motion.y >> 8;
+    }
+}
+
+// <GpuEvent> <id:2>, one at a time while nothing else is on the bus
+void sendEvents(void) {
+    if((g_eventCount == 0) || !g_cpuLink.idle() || !g_pgrmrLink.idle()) {
+        return;
+    }
+    const Event &next = g_events[g_eventHead];
+    uint8_t event[gpulink::g_eventSize] = {
+        (uint8_t) next.kind,
+        (uint8_t) (next.id >> 8), (uint8_t) (next.id & 0xFF)
+    };
+    if(g_cpuLink.send(event, gpulink::g_eventSize)) {
+        g_eventHead = (g_eventHead + 1) % g_maxEvents;
+        g_eventCount--;
+    }
+}
+
+// A batch of commands: <len> <commands...> (see GpuCommand)
+void onCpuPacket(const uint8_t *packet, const int len) {
+    int end = 1 + packet[0];
+    if(end > len) {
+        return;
+    }
+
+    int i = 1;
+    while(i < end) {
+        const uint8_t *cmd = &packet[i + 1];
+        int avail = end - i - 1;
+        int used = -1; // Stays that way if it's cut off or bad
+        switch((gpulink::GpuCommand) packet[i]) {
+            case gpulink::GpuCommand::Background:
+                if(avail >= 2) {
+                    g_bg = readU16(cmd);
+                    g_rasterBg = false;
+                    used = 2;
+                }
+                break;
+
+            case gpulink::GpuCommand::AddSprite:
+                if(avail >= 6) {
+                    g_sprs.push_back(sprite_t {
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        imageData(readU16(&cmd[4])), 3, false,
+                        false, false
+                    });
+                    g_sprAnims.push_back(SprAnim { gpulink::g_animStop });
+                    g_sprMotions.push_back(SprMotion {
+                        g_sprs.back().x * 256, g_sprs.back().y * 256
+                    });
+                    g_sprShapes.push_back(SprShape {});
+                    used = 6;
+                }
+                break;
+
+            // An image sprite that never draws its image, in the same list
+            case gpulink::GpuCommand::AddRect:
+                if(avail >= 8) {
+                    g_sprs.push_back(sprite_t {
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        g_sprData[0].data, 3, false, false, false
+                    });
+                    g_sprAnims.push_back(SprAnim { gpulink::g_animStop });
+                    g_sprMotions.push_back(SprMotion {
+                        g_sprs.back().x * 256, g_sprs.back().y * 256
+                    });
+                    g_sprShapes.push_back(g_shapeStyle);
+                    g_sprShapes.back().w = std::max<int>(readU16(&cmd[4]), 1);
+                    g_sprShapes.back().h = readU16(&cmd[6]);
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::ShapeStyle:
+                if(avail >= 4) {
+                    g_shapeStyle.color = readU16(&cmd[0]);
+                    g_shapeStyle.fill = (gpulink::ShapeFill) readU16(&cmd[2]);
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::ResizeRect:
+                if(avail >= 6) {
+                    uint16_t id = readU16(cmd);
+                    if((id < g_sprs.size()) && (g_sprShapes[id].w > 0)) {
+                        g_sprShapes[id].w = std::max<int>(readU16(&cmd[2]), 1);
+                        g_sprShapes[id].h = readU16(&cmd[4]);
+                    }
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::RectColor:
+                if(avail >= 4) {
+                    uint16_t id = readU16(cmd);
+                    if((id < g_sprs.size()) && (g_sprShapes[id].w > 0)) {
+                        g_sprShapes[id].color = readU16(&cmd[2]);
+                    }
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::MoveSprite:
+                if(avail >= 6) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        g_sprs[id].x = (int16_t) readU16(&cmd[2]);
+                        g_sprs[id].y = (int16_t) readU16(&cmd[4]);
+                        g_sprMotions[id].x = g_sprs[id].x * 256;
+                        g_sprMotions[id].y = g_sprs[id].y * 256;
+                        g_sprMotions[id].frames = 0;
+                    }
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::SpriteImage:
+                if(avail >= 4) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        g_sprs[id].img = imageData(readU16(&cmd[2]));
+                        g_sprAnims[id].anim = gpulink::g_animStop;
+                    }
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::ClearSprites:
+                g_sprs.clear();
+                g_sprAnims.clear();
+                g_sprMotions.clear();
+                g_sprShapes.clear();
+                dropTweenEvents(); // Their ids mean something else now
+                used = 0;
+                break;
+
+            case gpulink::GpuCommand::Image:
+                used = writeImage(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::GlyphColors:
+                if(avail >= 4) {
+                    g_glyphFg = readU16(&cmd[0]);
+                    g_glyphBg = readU16(&cmd[2]);
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::Glyph:
+                used = expandGlyph(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::DefineAnim:
+                used = defineAnim(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::PlayAnim:
+                if(avail >= 4) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        startAnim(id, readU16(&cmd[2]));
+                    }
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::SetVelocity:
+                if(avail >= 6) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        g_sprMotions[id].dx = (int16_t) readU16(&cmd[2]);
+                        g_sprMotions[id].dy = (int16_t) readU16(&cmd[4]);
+                    }
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::TweenSprite:
+                if(avail >= 8) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        SprMotion &motion = g_sprMotions[id];
+                        motion.fromX = g_sprs[id].x;
+                        motion.fromY = g_sprs[id].y;
+                        motion.toX = (int16_t) readU16(&cmd[2]);
+                        motion.toY = (int16_t) readU16(&cmd[4]);
+                        motion.ease = (gpulink::Ease) cmd[6];
+                        motion.frames = std::max<int>(cmd[7], 1);
+                        motion.elapsed = 0;
+                    }
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::SpriteEdge:
+                if(avail >= 4) {
+                    uint16_t id = readU16(cmd);
+                    if(id < g_sprs.size()) {
+                        g_sprMotions[id].edge =
+                            (gpulink::MotionEdge) readU16(&cmd[2]);
+                    }
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::MotionBounds:
+                if(avail >= 8) {
+                    g_boundsLeft = (int16_t) readU16(&cmd[0]);
+                    g_boundsTop = (int16_t) readU16(&cmd[2]);
+                    g_boundsRight = (int16_t) readU16(&cmd[4]);
+                    g_boundsBottom = (int16_t) readU16(&cmd[6]);
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::RasterLines:
+                used = writeRaster(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::RasterFill:
+                used = fillRaster(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::LayerSetup:
+                if(avail >= 6) {
+                    g_layer.setup(
+                        readU16(&cmd[0]), readU16(&cmd[2]), readU16(&cmd[4])
+                    );
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerPosition:
+                if(avail >= 4) {
+                    g_layer.position(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2])
+                    );
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerPalette:
+                if(avail >= 4) {
+                    g_layer.setPalette(readU16(&cmd[0]), readU16(&cmd[2]));
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerPen:
+                if(avail >= 2) {
+                    g_layer.setPen(readU16(cmd));
+                    used = 2;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerPixel:
+                if(avail >= 4) {
+                    g_layer.pixel(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2])
+                    );
+                    used = 4;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerLine:
+                if(avail >= 8) {
+                    g_layer.line(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        (int16_t) readU16(&cmd[4]), (int16_t) readU16(&cmd[6])
+                    );
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerRect:
+                if(avail >= 8) {
+                    g_layer.rect(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        readU16(&cmd[4]), readU16(&cmd[6])
+                    );
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::LayerBlit:
+                used = layerBlit(cmd, avail);
+                break;
+
+            // Per line tables written for an earlier map don't carry over
+            case gpulink::GpuCommand::AffineSetup:
+                if(avail >= 6) {
+                    g_affine.setup(
+                        readU16(&cmd[0]), readU16(&cmd[2]),
+                        (gpulink::AffineEdge) readU16(&cmd[4])
+                    );
+                    g_rasterScale = g_rasterRow = false;
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::AffineTiles:
+                used = affineTiles(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::AffineFill:
+                if(avail >= 6) {
+                    g_affine.fillCells(
+                        readU16(&cmd[0]), readU16(&cmd[2]), readU16(&cmd[4])
+                    );
+                    used = 6;
+                }
+                break;
+
+            case gpulink::GpuCommand::AffineMatrix:
+                if(avail >= 8) {
+                    g_affine.matrix(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        (int16_t) readU16(&cmd[4]), (int16_t) readU16(&cmd[6])
+                    );
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::AffineOrigin:
+                if(avail >= 8) {
+                    g_affine.origin(
+                        (int16_t) readU16(&cmd[0]), (int16_t) readU16(&cmd[2]),
+                        (int16_t) readU16(&cmd[4]), (int16_t) readU16(&cmd[6])
+                    );
+                    used = 8;
+                }
+                break;
+
+            case gpulink::GpuCommand::FindImage:
+                used = findImage(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::CopyRomImages:
+                used = copyRomImages(cmd, avail);
+                break;
+
+            case gpulink::GpuCommand::SetVideoMode:
+                if(avail >= 2) {
+                    int mode = readU16(cmd);
+                    if((mode < gpulink::g_videoModes) && (mode != g_mode)) {
+                        restartInMode(mode); // Doesn't come back
+                    }
+                    used = 2;
+                }
+                break;
+
+            default:
+                break;
+        }
+        g_trace.record(packet[i], (used < 0) ? g_traceBadLen : used);
+        if(used < 0) {
+            return; // Can't tell where the next command starts
+        }
+        i += 1 + used;
+    }
+}
+
+// Image data the programmer sent straight from a resource pack
+void onBulkPacket(const uint8_t *packet, const int len) {
+    if((packet[0] == gpulink::g_bulkImage)
+            && (packet[4] <= gpulink::g_bulkDataSize)) {
+        int used = writeImage(&packet[1], len - 1);
+        g_trace.record(packet[0], (used < 0) ? g_traceBadLen : used);
+    }
+}
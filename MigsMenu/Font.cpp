@@ -1,635 +0,0 @@
-/*
- * Author: Dylan Turner
- * Description: Storage for font data
- */
-
-#include <Arduino.h>
-#include "Font.hpp"
-
-const char PROGMEM font::g_fontSprs[65][128] = {
-    { // [space]
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // .
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 0
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 1
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 2
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 3
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 4
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 5
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 6
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 7
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 8
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // 9
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // A
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000,
-        0b11111000, 0b00100000, 0b11111000, 0b00100000
-    }, { // B
-
-    }, { // C
-
-    }, { // D
-
-    }, { // E
-
-    }, { // F
-
-    }, { // G
-
-    }, { // H
-
-    }, { // I
-
-    }, { // J
-
-    }, { // K
-
-    }, { // L
-
-    }, { // M
-
-    }, { // N
-
-    }, { // O
-
-    }, { // P
-
-    }, { // Q
-
-    }, { // R
-
-    }, { // S
-
-    }, { // T
-
-    }, { // U
-
-    }, { // V
-
-    }, { // W
-
-    }, { // X
-
-    }, { // Y
-
-    }, { // Z
-
-    }, { // _
-
-    }, { // a
-
-    }, { // b
-
-    }, { // c
-
-    }, { // d
-
-    }, { // e
-
-    }, { // f
-
-    }, { // g
-
-    }, { // h
-
-    }, { // i
-
-    }, { // j
-
-    }, { // k
-
-    }, { // l
-
-    }, { // m
-
-    }, { // n
-
-    }, { // o
-
-    }, { // p
-
-    }, { // q
-
-    }, { // r
-
-    }, { // s
-
-    }, { // t
-
-    }, { // u
-
-    }, { // v
-
-    }, { // w
-
-    }, { // x
-
-    }, { // y
-
-    }, { // z
-
-    }
-};
@@ -0,0 +1,84 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the on-screen game list
+ */
+
+#include <Arduino.h>
+#include <ResourceClient.hpp>
+#include "GameList.hpp"
+
+using namespace menu;
+
+GameList::GameList(rsrc::ResourceClient &resources) :
+        _resources(resources), _top(0), _first(0), _total(0) {
+    for(int i = 0; i < g_visibleGames; i++) {
+        memset(_names[i], ' ', rsrc::g_nameLenLimit - 1);
+        _names[i][rsrc::g_nameLenLimit - 1] = 0;
+    }
+}
+
+bool GameList::load(const uint16_t first) {
+    _top = 0;
+    _first = first;
+    return _fetch(first, 0, g_visibleGames);
+}
+
+bool GameList::scroll(const int rows) {
+    // Keep the window on the list, but let a short list sit at the top
+    long last = max(static_cast<long>(_total) - g_visibleGames, 0L);
+    long first = constrain(static_cast<long>(_first) + rows, 0L, last);
+    int moved = first - _first;
+    if(moved == 0) {
+        return true;
+    }
+    if(abs(moved) >= g_visibleGames) {
+        return load(first);
+    }
+
+    // Rows that went out of view get reused for the ones coming in
+    _top = (_top + moved + g_visibleGames) % g_visibleGames;
+    _first = first;
+    if(moved > 0) {
+        return _fetch(
+            _first + g_visibleGames - moved, g_visibleGames - moved, moved
+        );
+    }
+    return _fetch(_first, 0, -moved);
+}
+
+const char *GameList::name(const int row) const {
+    return _names[(_top + row) % g_visibleGames];
+}
+
+uint16_t GameList::first(void) const {
+    return _first;
+}
+
+uint16_t GameList::total(void) const {
+    return _total;
+}
+
+// Names from index on into count rows from row, in as few requests as fit
+bool GameList::_fetch(uint16_t index, int row, int count) {
+    bool ok = true;
+    while(count > 0) {
+        int slot = (_top + row) % g_visibleGames;
+        int n = min(min(count, rsrc::g_listMax), g_visibleGames - slot);
+        uint8_t got = 0;
+        if(ok) {
+            ok = _resources.list(
+                index, n, &_names[slot], got, _total
+            ) == rsrc::Status::Ok;
+        }
+
+        // Blank out whatever is past the end of the list
+        for(int i = got; i < n; i++) {
+            memset(_names[slot + i], ' ', rsrc::g_nameLenLimit - 1);
+            _names[slot + i][rsrc::g_nameLenLimit - 1] = 0;
+        }
+        index += n;
+        row += n;
+        count -= n;
+    }
+    return ok;
+}
@@ -0,0 +1,35 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The part of the game list that's on screen
+ * - Names are kept in a ring, so scrolling by a row only asks the resource
+ *   provider for the one name that came into view, no matter how many games
+ *   are on the card
+ */
+
+#pragma once
+
+#include <ResourceClient.hpp>
+
+namespace menu {
+    const int g_visibleGames = 10;
+
+    class GameList {
+        public:
+            GameList(rsrc::ResourceClient &resources);
+
+            bool load(const uint16_t first); // Fetch the whole window
+            bool scroll(const int rows); // Fetch only what comes into view
+            const char *name(const int row) const; // Blank past the end
+            uint16_t first(void) const;
+            uint16_t total(void) const;
+
+        private:
+            rsrc::ResourceClient &_resources;
+            char _names[g_visibleGames][rsrc::g_nameLenLimit];
+            int _top; // Ring slot holding the top row
+            uint16_t _first, _total;
+
+            bool _fetch(uint16_t index, int row, int count);
+    };
+}
@@ -7,129 +7,129 @@
  */
 
 #include <Wire.h>
-#include "Font.hpp"
+#include <ResourceClient.hpp>
+#include <GpuQueue.hpp>
+#include <GpuRom.hpp>
+#include "GameList.hpp"
 
-const int g_i2cAddr = 0x7C;
-const int g_numDispGames = 10;
 const uint16_t g_textXOffset = 14;
 const uint8_t g_textYOffset = 4;
 const uint8_t g_textYSpacing = 2;
-const int g_fNameLenLimit = 13; // 8.3
 const uint16_t g_bg = 0x07FF;
-
-int g_listInd = 0;
-char g_gameList[g_numDispGames][g_fNameLenLimit] = {
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            ",
-    "            "
-};
-
-// Flags for sending updated data
-int g_fontsLoaded = 0;
-bool g_tempSendA = true;
+const int g_glyphSize = 8; // ROM font images are sprite sized
+const int g_nameCols = rsrc::g_nameLenLimit - 1;
+const uint8_t g_upPin = 2; // Buttons pull these low while pressed
+const uint8_t g_downPin = 3;
+const unsigned long g_pollMs = 20;
+
+// What the GPU has been sent so far. Text is the GPU's own ROM font (opaque
+// white on clear), so there's nothing to upload first. Each character is a
+// sprite, and cell (row, col) is sprite row * g_nameCols + col
 bool g_updateListText = false;
-bool g_setBg = true;
-
-// Data to send
-uint8_t g_sendBuff[128];
-
-void setup(void) {
-    // Set up communication with the programmer/resource getter
-    Serial.begin(115200);
-    //loadGameList();
-
-    // Set up communication to the GPU
-    Wire.begin(g_i2cAddr);
-    Wire.onRequest(requestEvent);
-    Wire.onReceive(receiveEvent);
-
-    for(int i = 0; i < 129; i++) {
-        g_sendBuff[i] = 0;
-    }
-    g_sendBuff[0] = 0x55;
-}
-
-// We're mostly interested in sending data TO the GPU, so this doesn't do much
-void receiveEvent(int bytesRecv) {
-    while(Wire.available()) {
-        Wire.read();
+int g_textCells = 0; // Sprites added so far
+int g_textNext = 0; // Next cell to bring up to date
+uint16_t g_textShown[menu::g_visibleGames][g_nameCols];
+bool g_upHeld = false, g_downHeld = false;
+
+rsrc::ResourceClient g_resources;
+menu::GameList g_gameList(g_resources);
+gfx::GpuQueue g_gpu;
+
+// The ROM font's image for c, blank for anything it doesn't have
+uint16_t glyph(const char c) {
+    if((c >= '0') && (c <= '9')) {
+        return ROM_FONTS_SYSTEM_NUM_START + (c - '0');
+    } else if((c >= 'A') && (c <= 'Z')) {
+        return ROM_FONTS_SYSTEM_CAP_START + (c - 'A');
+    } else if((c >= 'a') && (c <= 'z')) {
+        return ROM_FONTS_SYSTEM_LOW_START + (c - 'a');
+    } else if(c == '.') {
+        return ROM_FONTS_SYSTEM_PERIOD;
+    } else if(c == '_') {
+        return ROM_FONTS_SYSTEM_UNDER_START;
     }
+    return ROM_FONTS_SYSTEM_SPACE;
 }
 
-void requestEvent() {
-    if(g_setBg) {
-        Wire.write('B');
-        Wire.write((uint8_t) ((g_bg >> 8) & 0xFF));
-        Wire.write((uint8_t) (g_bg & 0xFF));
-        g_setBg = false;
-    } else if(g_fontsLoaded < 2) {
-        Wire.write('D');
-        for(int i = 0; i < 128; i++) {
-            g_sendBuff[i] = pgm_read_byte_near(
-                font::g_fontSprs[g_fontsLoaded] + i
-            );
+// Queue up whatever the GPU still needs; it takes them as it polls. A cell's
+// sprite is added the first time round, and after that only re-imaged when
+// its character changed, so a scroll costs what actually moved
+void updateGpu(void) {
+    while(g_updateListText && (g_gpu.room() > 0)) {
+        int row = g_textNext / g_nameCols;
+        int col = g_textNext % g_nameCols;
+        const char *name = g_gameList.name(row);
+        int len = strnlen(name, g_nameCols);
+        uint16_t img = glyph((col < len) ? name[col] : ' ');
+
+        if(g_textNext == g_textCells) {
+            uint16_t id;
+            if(!g_gpu.addSprite(
+                    g_textXOffset + col * g_glyphSize,
+                    g_textYOffset + row * (g_glyphSize + g_textYSpacing),
+                    img, id)) {
+                break;
+            }
+            g_textCells++;
+        } else if((img != g_textShown[row][col])
+                && !g_gpu.setSpriteImage(g_textNext, img)) {
+            break;
         }
-        Wire.write(g_sendBuff, 128);
-        g_fontsLoaded++;
-    } else if (g_tempSendA) {
-        Wire.write('S');
-
-        Wire.write(0);
-        Wire.write(13);
+        g_textShown[row][col] = img;
 
-        Wire.write(0);
-        Wire.write(27);
+        g_textNext++;
+        if(g_textNext == menu::g_visibleGames * g_nameCols) {
+            g_textNext = 0;
+            g_updateListText = false;
+        }
+    }
+}
 
-        Wire.write(0);
-        Wire.write(FONT_CAP_START);
+// Reach out to resource provider for the visible part of the list
+void loadGameList(const uint16_t first) {
+    g_gameList.load(first);
+    g_updateListText = true;
+    g_textNext = 0;
+}
 
-        g_tempSendA = false;
-    } else {
-        Wire.write(0x55); // Send "0x55" to the GPU to indicate "do nothing"
+// Only the names that come into view are requested
+void scrollGameList(const int rows) {
+    uint16_t first = g_gameList.first();
+    g_gameList.scroll(rows);
+    if(g_gameList.first() != first) {
+        g_updateListText = true;
+        g_textNext = 0;
     }
 }
 
-// Reach out to resource provider and ask for a list of games
-void loadGameList(void) {
-    Serial.write('L');
-    int gameInd = 0, offset = g_listInd;
-    while(!Serial.available());
-    while(Serial.available()) {
-        char cmd = Serial.read();
-        if(cmd == 'F') {
-            if(gameInd < g_numDispGames) { // Just load in and we'll shift later
-                for(int i = 0; i < g_fNameLenLimit; i++) {
-                    g_gameList[gameInd][i++] = Serial.read();
-                }
-                gameInd++;
-            } else if(offset > 0) { // We have a 1st that isn't actually the 1st
-                // Shift over and lose the first ("scroll")
-                for(int i = 1; i < g_numDispGames; i++) {
-                    for(int j = 0; j < g_fNameLenLimit; j++) {
-                        g_gameList[i - 1][j] = g_gameList[i][j];
-                    }
-                }
+// True once per press, when pin first reads low
+bool pressed(const uint8_t pin, bool &ref_held) {
+    bool down = digitalRead(pin) == LOW;
+    bool edge = down && !ref_held;
+    ref_held = down;
+    return edge;
+}
 
-                // Fill in new bottom
-                for(int i = 0; i < g_fNameLenLimit; i++) {
-                    g_gameList[g_numDispGames - 1][i++] = Serial.read();
-                }
-                offset--;
-            } else {
-                break; // Ignore any past offset + 10
-            }
-        }
-    }
-    g_updateListText = true;
+void setup(void) {
+    // Set up communication with the programmer/resource getter
+    Serial.begin(115200);
+    pinMode(g_upPin, INPUT_PULLUP);
+    pinMode(g_downPin, INPUT_PULLUP);
+
+    // Set up communication to the GPU, so it has the background while the
+    // names load
+    g_gpu.begin();
+    g_gpu.setBackground(g_bg);
+    loadGameList(0);
 }
 
 void loop(void) {
-    delay(100);
+    if(pressed(g_upPin, g_upHeld)) {
+        scrollGameList(-1);
+    }
+    if(pressed(g_downPin, g_downHeld)) {
+        scrollGameList(1);
+    }
+    updateGpu();
+    delay(g_pollMs);
 }
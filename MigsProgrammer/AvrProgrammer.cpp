@@ -6,9 +6,8 @@
 #include <SD.h>
 #include "Stk500.hpp"
 #include "AvrProgrammer.hpp"
-#if defined(PGRMR_DEBUG)
-#include <SoftwareSerial.h>
-#endif
+#include "BootTimeline.hpp"
+#include "DebugTrace.hpp"
 
 using namespace pgrmr;
 
@@ -18,106 +17,217 @@ uint8_t g_memPage[128];
 uint8_t g_lineMemBuff[16];
 uint8_t g_lineBuff[50];
 
+// Timing (ms) and retry limits for the programming state machine
+const unsigned long g_bootTime = 10;
+const unsigned long g_finishTime = 20; // Optiboot's 16ms watchdog reset
+const int g_maxSyncTries = 10; // Optiboot can take a few tries after reset
+const int g_maxRetries = 3; // Resyncs per failing command
+const int g_maxAttempts = 2; // Full restarts (reset + rewind) per begin()
+
 #if defined(PGRMR_DEBUG)
-// Error messages (for space)
-const char *g_syncErrMsg = "Problem getting in sync.";
-const char *g_sdFileNotFoundErrMsg = "Failed while opening file.";
-const char *g_pgrmModeErrMsg = "Problem entering program mode.";
-const char *g_loadAddrErrMsg = "Problem while loading page address.";
-const char *g_pagedWriteErrMsg = "Problem while writing page.";
-const char *g_disableErrMsg = "Problem disabling device.";
-
-// Keep track of error throughout programArduino
-stk500::Error g_err = stk500::Error::None;
-
-SoftwareSerial *g_errorSender = nullptr;
+using pgrmrtrace::Event;
 #endif
 
-#if !defined(PGRMR_DEBUG)
-AvrProgrammer::AvrProgrammer(const int reset) : _reset(reset) {
+AvrProgrammer::AvrProgrammer(const int reset) :
+        _reset(reset), _onProgress(nullptr),
+        _state(State::Idle), _resume(State::Idle),
+        _lastErr(stk500::Error::None) {
 }
-#else
-AvrProgrammer::AvrProgrammer(
-        const int reset,
-        const int errTx, const int errRx, const int errBaudRate) :
-        _reset(reset),
-        _errorSender(errRx, errTx),
-        _errTx(errTx), _errRx(errRx), _errBaudRate(errBaudRate) {
-}
-#endif
 
 void AvrProgrammer::init(void) {
-#if defined(PGRMR_DEBUG)
-    pinMode(_errRx, INPUT);
-    pinMode(_errTx, OUTPUT);
-    _errorSender.begin(_errBaudRate);
-    g_errorSender = &_errorSender;
-#endif
     pinMode(_reset, OUTPUT);
     digitalWrite(_reset, HIGH);
 
     _mem.buff = g_memPage;
+}
+
+void AvrProgrammer::begin(File program, ProgressCallback onProgress) {
+    _program = program;
+    _onProgress = onProgress;
+    _lastErr = stk500::Error::None;
+    _attempts = 0;
+    _restart();
+}
 
+bool AvrProgrammer::busy(void) const {
+    return (_state != State::Idle)
+        && (_state != State::Done) && (_state != State::Failed);
+}
+
+State AvrProgrammer::state(void) const {
+    return _state;
+}
+
+stk500::Error AvrProgrammer::lastError(void) const {
+    return _lastErr;
+}
+
+bool AvrProgrammer::update(void) {
+    stk500::Error err;
+    switch(_state) {
+        case State::Boot:
+            if(millis() - _stateTime >= g_bootTime) {
+                _startSync(State::ProgramEnable);
+            }
+            break;
+
+        case State::Sync:
+            err = stk500::poll();
+            if(err == stk500::Error::Pending) {
+                break;
+            } else if(err == stk500::Error::None) {
+                if(!boot::marked(boot::Phase::Synced)) {
+                    boot::mark(boot::Phase::Synced);
+                }
+                _issue(_resume);
+            } else if(++_syncTries < g_maxSyncTries) {
+                stk500::beginSync();
+            } else {
 #if defined(PGRMR_DEBUG)
-    _errorSender.println(F("SD Card initialized."));
+                trace::record(Event::SyncFailed, err);
 #endif
-}
+                _recover(err);
+            }
+            break;
 
-void AvrProgrammer::program(File program) {
-    // Reset other arduino, get in sync, and get its software info
-    digitalWrite(_reset, HIGH);
-    delay(100);
-    _toggleReset();
-    delay(10);
+        case State::ProgramEnable:
+        case State::LoadAddr:
+        case State::WritePage:
+        case State::Disable:
+            err = stk500::poll();
+            if(err == stk500::Error::Pending) {
+                break;
+            } else if(err != stk500::Error::None) {
+                _recover(err);
+                break;
+            }
 
-#if !defined(PGRMR_DEBUG)
-    stk500::getSync();
+            _retries = 0;
+            if(_state == State::ProgramEnable) {
+#if defined(PGRMR_DEBUG)
+                trace::record(Event::ProgramMode);
+#endif
+                _nextPage();
+            } else if(_state == State::LoadAddr) {
+                _issue(State::WritePage);
+            } else if(_state == State::WritePage) {
+#if defined(PGRMR_DEBUG)
+                trace::record(Event::PageWritten, 0, _mem.pageAddr);
+#endif
+                if(_onProgress) {
+                    _onProgress(_program.position(), _program.size());
+                }
+                _nextPage();
+            } else {
+                _stateTime = millis();
+                _state = State::Finish;
+            }
+            break;
+
+        case State::Finish:
+            // Leaving program mode already restarts it into the app
+            if(millis() - _stateTime >= g_finishTime) {
+                _program.close();
+                _state = State::Done;
+#if defined(PGRMR_DEBUG)
+                trace::record(Event::Done);
+#endif
+            }
+            break;
 
-    stk500::programEnable();
-    while(_readPage(program, _mem)) {
-        stk500::loadAddr(_mem.pageAddr >> 1);
-        stk500::pagedWrite(_mem);
+        default:
+            break;
     }
+    return busy();
+}
 
-    // Close out
-    stk500::disableDevice();
-    delay(10);
+// Reset other arduino and start over from the top of the hex file
+void AvrProgrammer::_restart(void) {
+    _program.seek(0);
+    _retries = 0;
     _toggleReset();
-    program.close();
-#else
-    g_err = stk500::getSync();
-    if(g_err != stk500::Error::None) {
-        warning(g_err, g_syncErrMsg);
-    }
+    _stateTime = millis();
+    _state = State::Boot;
+}
+
+void AvrProgrammer::_startSync(const State resume) {
+    _resume = resume;
+    _syncTries = 0;
+    stk500::beginSync();
+    _state = State::Sync;
+}
 
-    // Program arduino
-    g_err = stk500::programEnable(error);
-    if(g_err != stk500::Error::None) {
-        warning(g_err, g_pgrmModeErrMsg);
+// Send the command belonging to a state and move into it
+void AvrProgrammer::_issue(const State st) {
+    switch(st) {
+        case State::ProgramEnable:
+            stk500::beginProgramEnable();
+            break;
+        case State::LoadAddr:
+            stk500::beginLoadAddr(_mem.pageAddr >> 1);
+            break;
+        case State::WritePage:
+            stk500::beginPagedWrite(_mem);
+            break;
+        case State::Disable:
+            stk500::beginDisableDevice();
+            break;
+        default:
+            break;
     }
-    _errorSender.println(F("Entered program mode."));
-    while(_readPage(program, _mem)) {
-        g_err = stk500::loadAddr(_mem.pageAddr >> 1, error);
-        if(g_err != stk500::Error::None) {
-            warning(g_err, g_loadAddrErrMsg);
-        }
-        g_err = stk500::pagedWrite(_mem, error);
-        if(g_err != stk500::Error::None) {
-            warning(g_err, g_pagedWriteErrMsg);
-        }
+    _state = st;
+}
+
+void AvrProgrammer::_nextPage(void) {
+    if(_readPage(_mem) > 0) {
+        _issue(State::LoadAddr);
+    } else {
+#if defined(PGRMR_DEBUG)
+        trace::record(Event::Finished);
+#endif
+        _issue(State::Disable);
     }
-    _errorSender.println(F("Finished programming."));
+}
 
-    // Close out
-    g_err = stk500::disableDevice(error);
-    if(g_err != stk500::Error::None) {
-        warning(g_err, g_disableErrMsg);
+// Resync and repeat the failed command, or start over if that keeps failing
+void AvrProgrammer::_recover(const stk500::Error err) {
+    _lastErr = err;
+#if defined(PGRMR_DEBUG)
+    switch(_state) {
+        case State::ProgramEnable:
+            trace::record(Event::ProgramModeFailed, err);
+            break;
+        case State::LoadAddr:
+            trace::record(Event::LoadAddrFailed, err, _mem.pageAddr);
+            break;
+        case State::WritePage:
+            trace::record(Event::PageWriteFailed, err, _mem.pageAddr);
+            break;
+        case State::Disable:
+            trace::record(Event::DisableFailed, err);
+            break;
+        default:
+            break;
     }
-    delay(10);
-    _toggleReset();
-    program.close();
-    _errorSender.println(F("Done."));
 #endif
+
+    if(++_retries <= g_maxRetries) {
+        // A page write has to be preceded by its address again
+        State resume = (_state == State::WritePage) ? State::LoadAddr
+            : (_state == State::Sync) ? _resume : _state;
+        _startSync(resume);
+    } else if(++_attempts < g_maxAttempts) {
+#if defined(PGRMR_DEBUG)
+        trace::record(Event::Restarting, err, _attempts);
+#endif
+        _restart();
+    } else {
+#if defined(PGRMR_DEBUG)
+        trace::record(Event::GaveUp, err);
+#endif
+        _program.close();
+        _state = State::Failed;
+    }
 }
 
 void AvrProgrammer::_toggleReset(void) const {
@@ -126,12 +236,13 @@ void AvrProgrammer::_toggleReset(void) const {
     digitalWrite(_reset, HIGH);
 }
 
-int AvrProgrammer::_readPage(const File &program, stk500::AvrMem &ref_mem) {
-    // Grab 128 bytes or less (i.e. a page)
+int AvrProgrammer::_readPage(stk500::AvrMem &ref_mem) {
+    // Grab 128 bytes or less (i.e. a page), padding a short one with erased
+    memset(ref_mem.buff, 0xFF, sizeof(g_memPage));
     int totalLen = 0;
     for(int i = 0; i < 8; i++) {
         int addr;
-        int len = _readIntelHexLine(program, addr, g_lineMemBuff, g_lineBuff);
+        int len = _readIntelHexLine(_program, addr, g_lineMemBuff, g_lineBuff);
         if(len < 0) {
             break;
         } else {
@@ -155,9 +266,6 @@ int AvrProgrammer::_readIntelHexLine(
     while(true) {
         if(input.available()) {
             c = input.read();
-#if defined(PGRMR_DEBUG)
-            _errorSender.print((char) c);
-#endif
             if((c == '\n') || (c == '\r')) {
                 break;
             } else {
@@ -197,24 +305,3 @@ uint8_t AvrProgrammer::_hexToByte(const uint8_t *code) const {
     }
     return result;
 }
-
-#if defined(PGRMR_DEBUG)
-void AvrProgrammer::error(const stk500::Error error, const char *msg) {
-    int errInd = -static_cast<int>(error);
-    g_errorSender->print(F("Error: "));
-    g_errorSender->print(msg);
-    g_errorSender->print(F(" Code: "));
-    g_errorSender->print(static_cast<int>(error), DEC);
-    g_errorSender->println(F("."));
-    while(true);
-}
-
-void AvrProgrammer::warning(const stk500::Error error, const char *msg) {
-    int errInd = -static_cast<int>(error);
-    g_errorSender->print(F("Warning: "));
-    g_errorSender->print(msg);
-    g_errorSender->print(F(" Code: "));
-    g_errorSender->print(static_cast<int>(error), DEC);
-    g_errorSender->println(F("."));
-}
-#endif
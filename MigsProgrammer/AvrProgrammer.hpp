@@ -1,48 +1,66 @@
 /*
  * Author: Dylan Turner
- * Description: Interface for programming another arduino over Serial
+ * Description:
+ * - Interface for programming another arduino over Serial
+ * - Programming is a state machine: begin() it, then call update() from
+ *   loop() until it stops returning true, doing other work in between
  */
 
 #pragma once
 
 //#define PGRMR_DEBUG
 
-#if defined(PGRMR_DEBUG)
-#include <SoftwareSerial.h>
-#endif
 #include <SD.h>
 #include "Stk500.hpp"
 
 namespace pgrmr {
+    enum class State {
+        Idle,
+        Boot, // Wait for the target's bootloader to come up after reset
+        Sync,
+        ProgramEnable,
+        LoadAddr,
+        WritePage,
+        Disable,
+        Finish, // Wait for the bootloader to start the new program
+        Done,
+        Failed
+    };
+
+    // Called after every page with hex file bytes consumed and total
+    typedef void (*ProgressCallback)(
+        const unsigned long done, const unsigned long total
+    );
+
     class AvrProgrammer {
         public:
-#if defined(PGRMR_DEBUG)
-            static void error(const stk500::Error error, const char *msg);
-            static void warning(const stk500::Error error, const char *msg);
-#endif
-
-            AvrProgrammer(
-                const int reset
-#if defined(PGRMR_DEBUG)
-                , const int errTx, const int errRx,
-                const int errBaudRate
-#endif
-            );
+            AvrProgrammer(const int reset);
 
             void init(void);
-            void program(File program);
-        
+            void begin(File program, ProgressCallback onProgress = nullptr);
+            bool update(void); // Returns true while still programming
+            bool busy(void) const;
+            State state(void) const;
+            stk500::Error lastError(void) const;
+
         private:
             const int _reset;
             stk500::AvrMem _mem;
 
-#if defined(PGRMR_DEBUG)
-            SoftwareSerial _errorSender;
-            const int _errBaudRate, _errTx, _errRx;
-#endif
+            File _program;
+            ProgressCallback _onProgress;
+            State _state, _resume;
+            stk500::Error _lastErr;
+            unsigned long _stateTime;
+            int _syncTries, _retries, _attempts;
 
+            void _restart(void);
+            void _startSync(const State resume);
+            void _issue(const State st);
+            void _nextPage(void);
+            void _recover(const stk500::Error err);
             void _toggleReset(void) const;
-            int _readPage(const File &program, stk500::AvrMem &ref_mem);
+            int _readPage(stk500::AvrMem &ref_mem);
             int _readIntelHexLine(
                 File input, int &ref_addr,
                 uint8_t *lineMemBuff, uint8_t *lineBuff
@@ -0,0 +1,31 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the boot timeline
+ */
+
+#include <Arduino.h>
+#include "BootTimeline.hpp"
+#include "DebugTrace.hpp"
+
+const int g_phaseCount = static_cast<int>(boot::Phase::Count);
+
+unsigned long g_phaseTimes[g_phaseCount];
+uint8_t g_phasesMarked = 0; // Bit per phase
+
+void boot::mark(const Phase phase) {
+    g_phaseTimes[static_cast<int>(phase)] = millis();
+    g_phasesMarked |= 1 << static_cast<int>(phase);
+#if defined(PGRMR_DEBUG)
+    trace::record(
+        pgrmrtrace::Event::BootPhase, static_cast<int8_t>(phase)
+    );
+#endif
+}
+
+bool boot::marked(const Phase phase) {
+    return g_phasesMarked & (1 << static_cast<int>(phase));
+}
+
+unsigned long boot::at(const Phase phase) {
+    return g_phaseTimes[static_cast<int>(phase)];
+}
@@ -0,0 +1,28 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Timestamps for each phase of bringing the logic MCU up
+ * - Marks are always taken (they're cheap), but only sent as trace events in
+ *   debug builds
+ */
+
+#pragma once
+
+#include "AvrProgrammer.hpp"
+
+namespace boot {
+    enum class Phase {
+        Start, // Entered setup()
+        SdReady,
+        ImageChecked, // Knows whether the logic MCU already holds the image
+        Synced, // Bootloader answered (flashing only)
+        Flashed, // New image written (flashing only)
+        Unchanged, // Image already there and left running (fast path only)
+        Ready, // Logic MCU program running
+        Count
+    };
+
+    void mark(const Phase phase);
+    bool marked(const Phase phase);
+    unsigned long at(const Phase phase);
+}
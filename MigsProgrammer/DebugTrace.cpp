@@ -0,0 +1,112 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the debug event trace
+ */
+
+#include <Arduino.h>
+#include "DebugTrace.hpp"
+
+#if defined(PGRMR_DEBUG)
+#include <SoftwareSerial.h>
+
+using namespace pgrmrtrace;
+
+// Wired to the ErrorReceiver's 5 and 4
+const int g_traceTx = 4;
+const int g_traceRx = 5;
+const int g_traceRingSize = 16; // Records (8 bytes each in RAM)
+
+struct TraceRecord {
+    uint8_t event;
+    int8_t code;
+    uint16_t arg;
+    uint32_t ms;
+};
+
+SoftwareSerial g_traceSender(g_traceRx, g_traceTx);
+TraceRecord g_traceRing[g_traceRingSize];
+int g_traceHead = 0, g_traceCount = 0;
+uint16_t g_traceDropped = 0;
+uint8_t g_traceOut[g_recordSize]; // Record being sent
+int g_traceOutInd = g_recordSize;
+
+static bool push(const Event event, const int8_t code, const uint16_t arg) {
+    if(g_traceCount == g_traceRingSize) {
+        return false;
+    }
+    g_traceRing[g_traceHead] = TraceRecord {
+        static_cast<uint8_t>(event), code, arg,
+        static_cast<uint32_t>(millis())
+    };
+    g_traceHead = (g_traceHead + 1) % g_traceRingSize;
+    g_traceCount++;
+    return true;
+}
+
+static void encode(const TraceRecord &rec) {
+    g_traceOut[0] = g_sync;
+    g_traceOut[1] = rec.event;
+    g_traceOut[2] = static_cast<uint8_t>(rec.code);
+    for(int i = 0; i < 4; i++) {
+        g_traceOut[3 + i] = (rec.ms >> (i * 8)) & 0xFF;
+    }
+    g_traceOut[7] = rec.arg & 0xFF;
+    g_traceOut[8] = rec.arg >> 8;
+    uint8_t check = 0;
+    for(int i = 1; i < g_recordSize - 1; i++) {
+        check ^= g_traceOut[i];
+    }
+    g_traceOut[g_recordSize - 1] = check;
+    g_traceOutInd = 0;
+}
+
+void trace::begin(void) {
+    pinMode(g_traceRx, INPUT);
+    pinMode(g_traceTx, OUTPUT);
+    g_traceSender.begin(g_baud);
+}
+
+void trace::record(const Event event, const int8_t code, const uint16_t arg) {
+    // Records lost to a full ring are owed a Dropped record, which has to go
+    // in before this one or the decoder would put the gap in the wrong spot.
+    // Until there's room for both, this one is lost as well
+    if(g_traceDropped > 0) {
+        if(g_traceRingSize - g_traceCount < 2) {
+            if(g_traceDropped < 0xFFFF) {
+                g_traceDropped++;
+            }
+            return;
+        }
+        push(Event::Dropped, 0, g_traceDropped);
+        g_traceDropped = 0;
+    }
+    if(!push(event, code, arg) && (g_traceDropped < 0xFFFF)) {
+        g_traceDropped++;
+    }
+}
+
+void trace::record(
+        const Event event, const stk500::Error err, const uint16_t arg) {
+    record(event, static_cast<int8_t>(err), arg);
+}
+
+void trace::drain(void) {
+    if(g_traceOutInd == g_recordSize) {
+        if(g_traceCount == 0) {
+            return;
+        }
+        int tail = (g_traceHead + g_traceRingSize - g_traceCount)
+            % g_traceRingSize;
+        encode(g_traceRing[tail]);
+        g_traceCount--;
+    }
+    g_traceSender.write(g_traceOut[g_traceOutInd++]);
+}
+
+void trace::fail(const Event event, const stk500::Error err) {
+    record(event, err);
+    while(true) {
+        drain();
+    }
+}
+#endif
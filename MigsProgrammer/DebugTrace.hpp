@@ -0,0 +1,39 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The PGRMR_DEBUG channel: binary pgrmrtrace events instead of text, so
+ *   reporting costs the programmer a few stores rather than a string
+ * - Records wait in a ring in RAM, and loop() sends them with drain(). That
+ *   isn't free: SoftwareSerial::write bit-bangs with interrupts off, so each
+ *   byte blocks the programmer (and Serial's rx interrupt) for a byte time,
+ *   ~175us at g_baud, even in the middle of STK500 traffic. drain() sends
+ *   one byte a call to keep that to what the USART's 2 byte rx FIFO rides
+ *   out at 115200
+ * - If the ring fills, new records are dropped and an Event::Dropped record
+ *   with how many goes out once there's room again
+ */
+
+#pragma once
+
+#include "AvrProgrammer.hpp"
+
+#if defined(PGRMR_DEBUG)
+#include <PgrmrTrace.hpp>
+#include "Stk500.hpp"
+
+namespace trace {
+    void begin(void);
+    void record(
+        const pgrmrtrace::Event event,
+        const int8_t code = 0, const uint16_t arg = 0
+    );
+    void record(
+        const pgrmrtrace::Event event,
+        const stk500::Error err, const uint16_t arg = 0
+    );
+    void drain(void); // Call often; sends one byte at most
+
+    // Record, send everything still queued and stop for good
+    void fail(const pgrmrtrace::Event event, const stk500::Error err);
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the game index
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <ResourceProtocol.hpp>
+#include "GameIndex.hpp"
+
+using namespace rsrc;
+
+const char *g_indexName = "GAMES.IDX";
+const char *g_menuName = "MENU.HEX";
+const char *g_gameExt = ".HEX";
+const uint32_t g_indexMagic = 0x5844494D; // "MIDX"
+const int g_headerSize = 10;
+
+// Two records for comparing/swapping while sorting, plus the walk's entries
+char g_recA[g_nameLenLimit], g_recB[g_nameLenLimit];
+File g_walkDir, g_walkEntry;
+
+GameIndex::GameIndex(void) : _checked(false), _count(0) {
+}
+
+uint16_t GameIndex::count(void) const {
+    return _count;
+}
+
+bool GameIndex::refresh(void) {
+    if(_checked) {
+        return _file;
+    }
+    _checked = true;
+
+    uint16_t count;
+    uint32_t signature = _signature(count);
+
+    _file = SD.open(g_indexName, FILE_READ);
+    uint32_t size =
+        g_headerSize + static_cast<uint32_t>(count) * g_nameLenLimit;
+    if(_file && (_file.size() == size)) {
+        uint32_t magic = 0, sig = 0;
+        uint16_t cnt = 0;
+        _file.read(reinterpret_cast<uint8_t *>(&magic), 4);
+        _file.read(reinterpret_cast<uint8_t *>(&cnt), 2);
+        _file.read(reinterpret_cast<uint8_t *>(&sig), 4);
+        if((magic == g_indexMagic) && (cnt == count) && (sig == signature)) {
+            _count = count;
+            return true;
+        }
+    }
+    if(_file) {
+        _file.close();
+    }
+    return _rebuild(signature, count);
+}
+
+bool GameIndex::name(const uint16_t ind, char *ref_name) {
+    if(!_file || (ind >= _count)) {
+        return false;
+    }
+    _readRec(ind, ref_name);
+    return true;
+}
+
+bool GameIndex::_isGame(File &entry) const {
+    if(entry.isDirectory()) {
+        return false;
+    }
+    const char *name = entry.name();
+    const char *ext = strrchr(name, '.');
+    return ext && (strcasecmp(ext, g_gameExt) == 0)
+        && (strcasecmp(name, g_menuName) != 0);
+}
+
+// Hash of the game names in directory order. Any add/remove/rename changes it
+uint32_t GameIndex::_signature(uint16_t &ref_count) {
+    uint32_t hash = 5381;
+    ref_count = 0;
+    g_walkDir = SD.open("/", FILE_READ);
+    while((g_walkEntry = g_walkDir.openNextFile())) {
+        if(_isGame(g_walkEntry)) {
+            for(const char *c = g_walkEntry.name(); *c; c++) {
+                hash = hash * 33 + *c;
+            }
+            hash = hash * 33;
+            ref_count++;
+        }
+        g_walkEntry.close();
+    }
+    g_walkDir.close();
+    return hash;
+}
+
+bool GameIndex::_rebuild(const uint32_t signature, const uint16_t count) {
+    // Not FILE_WRITE, as that appends and sorting has to write in place
+    _file = SD.open(g_indexName, O_READ | O_WRITE | O_CREAT | O_TRUNC);
+    if(!_file) {
+        _count = 0;
+        return false;
+    }
+    _file.write(reinterpret_cast<const uint8_t *>(&g_indexMagic), 4);
+    _file.write(reinterpret_cast<const uint8_t *>(&count), 2);
+    _file.write(reinterpret_cast<const uint8_t *>(&signature), 4);
+
+    uint16_t written = 0;
+    g_walkDir = SD.open("/", FILE_READ);
+    while((written < count) && (g_walkEntry = g_walkDir.openNextFile())) {
+        if(_isGame(g_walkEntry)) {
+            memset(g_recA, 0, g_nameLenLimit);
+            strncpy(g_recA, g_walkEntry.name(), g_nameLenLimit - 1);
+            _file.write(reinterpret_cast<uint8_t *>(g_recA), g_nameLenLimit);
+            written++;
+        }
+        g_walkEntry.close();
+    }
+    g_walkDir.close();
+
+    // The card can lose a game between the two walks, and refresh() would
+    // never trust a header that disagrees with the file's size
+    if(written != count) {
+        _file.seek(4);
+        _file.write(reinterpret_cast<const uint8_t *>(&written), 2);
+    }
+    _count = written;
+    _sort(_count);
+    _file.flush();
+    return true;
+}
+
+// Heapsort in place on the card; only two names ever need to be in RAM
+void GameIndex::_sort(const uint16_t count) {
+    for(uint16_t end = count; end > 1; ) {
+        // First pass builds the heap, after that just fix the root
+        int start = (end == count) ? (end / 2) - 1 : 0;
+        for(int root = start; root >= 0; root--) {
+            uint16_t parent = root;
+            while(true) {
+                uint16_t child = parent * 2 + 1;
+                if(child >= end) {
+                    break;
+                }
+                if(child + 1 < end) {
+                    _readRec(child, g_recA);
+                    _readRec(child + 1, g_recB);
+                    if(strcasecmp(g_recB, g_recA) > 0) {
+                        child++;
+                    }
+                }
+                _readRec(parent, g_recA);
+                _readRec(child, g_recB);
+                if(strcasecmp(g_recB, g_recA) <= 0) {
+                    break;
+                }
+                _writeRec(parent, g_recB);
+                _writeRec(child, g_recA);
+                parent = child;
+            }
+        }
+
+        // Largest to the back
+        end--;
+        _readRec(0, g_recA);
+        _readRec(end, g_recB);
+        _writeRec(0, g_recB);
+        _writeRec(end, g_recA);
+    }
+}
+
+void GameIndex::_readRec(const uint16_t ind, char *rec) {
+    _file.seek(g_headerSize + static_cast<uint32_t>(ind) * g_nameLenLimit);
+    _file.read(reinterpret_cast<uint8_t *>(rec), g_nameLenLimit);
+}
+
+void GameIndex::_writeRec(const uint16_t ind, const char *rec) {
+    _file.seek(g_headerSize + static_cast<uint32_t>(ind) * g_nameLenLimit);
+    _file.write(reinterpret_cast<const uint8_t *>(rec), g_nameLenLimit);
+}
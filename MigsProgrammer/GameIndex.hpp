@@ -0,0 +1,34 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Sorted list of games (.HEX files other than the menu) kept on the SD card
+ * - GAMES.IDX: <magic:4> <count:2> <dir signature:4> then 13 byte names
+ * - The root dir is walked once per boot to check the signature, and the
+ *   file is only rebuilt when that changed, so list requests are just a seek
+ */
+
+#pragma once
+
+#include <SD.h>
+
+namespace rsrc {
+    class GameIndex {
+        public:
+            GameIndex(void);
+            bool refresh(void); // Check (first call only) and rebuild if stale
+            uint16_t count(void) const;
+            bool name(const uint16_t ind, char *ref_name); // 13 byte buffer
+
+        private:
+            bool _checked;
+            uint16_t _count;
+            File _file;
+
+            bool _isGame(File &entry) const;
+            uint32_t _signature(uint16_t &ref_count);
+            bool _rebuild(const uint32_t signature, const uint16_t count);
+            void _sort(const uint16_t count);
+            void _readRec(const uint16_t ind, char *rec);
+            void _writeRec(const uint16_t ind, const char *rec);
+    };
+}
@@ -0,0 +1,113 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the GPU uploader
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SD.h>
+#include <GpuLink.hpp>
+#include "ReadAhead.hpp"
+#include "GpuUploader.hpp"
+
+using namespace rsrc;
+
+// Shared with the I2C request handler (interrupt context)
+uint8_t g_bulkPacket[gpulink::g_bulkPacketSize];
+volatile bool g_bulkReady = false;
+volatile uint8_t g_bulkTaken = 0; // Data bytes of packets the GPU has read
+
+GpuUploader::GpuUploader(ReadAhead &cache) :
+        _cache(cache), _file(nullptr), _base(0), _len(0), _sent(0), _slot(0) {
+}
+
+void GpuUploader::begin(void) {
+    Wire.begin(gpulink::g_pgrmrI2cAddr);
+    Wire.onRequest(_onRequest);
+}
+
+bool GpuUploader::start(
+        File *file, const uint32_t base, const uint32_t len,
+        const uint16_t slot) {
+    if(busy()) {
+        return false;
+    }
+    noInterrupts();
+    g_bulkReady = false;
+    g_bulkTaken = 0;
+    interrupts();
+
+    _file = file;
+    _base = base;
+    _len = len;
+    _sent = 0;
+    _slot = slot;
+    service();
+    return true;
+}
+
+void GpuUploader::service(void) {
+    if(!_file || g_bulkReady) {
+        return;
+    }
+
+    noInterrupts();
+    _sent += g_bulkTaken;
+    g_bulkTaken = 0;
+    interrupts();
+    if(_sent >= _len) {
+        _file = nullptr;
+        return;
+    }
+
+    // Never cross an image boundary, so a packet is always one slot
+    uint16_t offset = _sent % gpulink::g_imageSize;
+    int maxLen = min(
+        static_cast<uint32_t>(gpulink::g_bulkDataSize),
+        min(_len - _sent, static_cast<uint32_t>(gpulink::g_imageSize - offset))
+    );
+    const uint8_t *data;
+    int n = _cache.fetch(_file, _base + _sent, maxLen, data);
+    if(n <= 0) {
+        _file = nullptr; // Card error, so give up on it
+        return;
+    }
+
+    uint16_t slot = _slot + _sent / gpulink::g_imageSize;
+    g_bulkPacket[0] = gpulink::g_bulkImage;
+    g_bulkPacket[1] = (slot >> 8) & 0xFF;
+    g_bulkPacket[2] = slot & 0xFF;
+    g_bulkPacket[3] = offset;
+    g_bulkPacket[4] = n;
+    memcpy(&g_bulkPacket[gpulink::g_bulkHeaderSize], data, n);
+    g_bulkReady = true;
+}
+
+void GpuUploader::cancel(const File *file) {
+    if(_file == file) {
+        noInterrupts();
+        g_bulkReady = false;
+        interrupts();
+        _file = nullptr;
+    }
+}
+
+bool GpuUploader::busy(void) const {
+    return _file != nullptr;
+}
+
+uint32_t GpuUploader::left(void) const {
+    return busy() ? _len - _sent : 0;
+}
+
+void GpuUploader::_onRequest(void) {
+    if(!g_bulkReady) {
+        Wire.write(gpulink::g_linkIdle);
+        return;
+    }
+    Wire.write(
+        g_bulkPacket, gpulink::g_bulkHeaderSize + g_bulkPacket[4]
+    );
+    g_bulkTaken = g_bulkPacket[4];
+    g_bulkReady = false;
+}
@@ -0,0 +1,40 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Sends resource pack assets straight to the GPU's image slots
+ * - The programmer sits on the GPU's I2C bus as a slave (see MigsSdk's
+ *   GpuLink.hpp), and the GPU polls it for bulk packets
+ * - The next packet is read from SD in service() (loop context), so the I2C
+ *   request handler only ever copies out of RAM
+ */
+
+#pragma once
+
+#include <SD.h>
+#include <GpuLink.hpp>
+#include "ReadAhead.hpp"
+
+namespace rsrc {
+    class GpuUploader {
+        public:
+            GpuUploader(ReadAhead &cache);
+            void begin(void); // Join the GPU's bus
+
+            bool start(
+                File *file, const uint32_t base, const uint32_t len,
+                const uint16_t slot
+            );
+            void service(void); // Prepare the next packet if it was taken
+            void cancel(const File *file); // Before the file goes away
+            bool busy(void) const;
+            uint32_t left(void) const; // Bytes the GPU hasn't taken yet
+
+        private:
+            ReadAhead &_cache;
+            File *_file;
+            uint32_t _base, _len, _sent;
+            uint16_t _slot;
+
+            static void _onRequest(void);
+    };
+}
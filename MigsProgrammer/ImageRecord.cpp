@@ -0,0 +1,70 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the flashed image record
+ */
+
+#include <EEPROM.h>
+#include <SD.h>
+#include "ImageRecord.hpp"
+
+using namespace pgrmr;
+
+struct Record {
+    uint16_t magic;
+    ImageId id;
+};
+
+const int g_recordAddr = 0;
+const uint16_t g_recordMagic = 0x4D49; // "MI"
+const uint16_t g_noMagic = 0xFFFF; // Erased EEPROM
+
+// Hashing buffer. Small, but enough to use the SD library's block reads
+uint8_t g_hashBuff[32];
+
+ImageId pgrmr::identify(File &image) {
+    // Fletcher-32, reducing every few hundred bytes (too few to overflow)
+    uint32_t sum1 = 0xFFFF, sum2 = 0xFFFF;
+    int n, sinceReduce = 0;
+    image.seek(0);
+    while((n = image.read(g_hashBuff, sizeof(g_hashBuff))) > 0) {
+        for(int i = 0; i < n; i++) {
+            sum1 += g_hashBuff[i];
+            sum2 += sum1;
+        }
+        sinceReduce += n;
+        if(sinceReduce >= 256) {
+            sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+            sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+            sinceReduce = 0;
+        }
+    }
+    sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+    sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+    sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+    sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+    image.seek(0);
+
+    ImageId id;
+    id.size = image.size();
+    id.sum = (sum2 << 16) | sum1;
+    return id;
+}
+
+bool pgrmr::isFlashed(const ImageId &id) {
+    Record rec;
+    EEPROM.get(g_recordAddr, rec);
+    return (rec.magic == g_recordMagic)
+        && (rec.id.size == id.size) && (rec.id.sum == id.sum);
+}
+
+void pgrmr::recordFlashed(const ImageId &id) {
+    Record rec;
+    rec.magic = g_recordMagic;
+    rec.id = id;
+    EEPROM.put(g_recordAddr, rec); // put() only rewrites bytes that changed
+}
+
+void pgrmr::forgetFlashed(void) {
+    EEPROM.update(g_recordAddr, g_noMagic & 0xFF);
+    EEPROM.update(g_recordAddr + 1, g_noMagic >> 8);
+}
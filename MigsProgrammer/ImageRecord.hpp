@@ -0,0 +1,22 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Remember which hex image the logic MCU was last flashed with
+ * - Kept in the programmer's EEPROM so an unchanged image is left alone
+ */
+
+#pragma once
+
+#include <SD.h>
+
+namespace pgrmr {
+    struct ImageId {
+        uint32_t size;
+        uint32_t sum; // Fletcher-32 over the hex file
+    };
+
+    ImageId identify(File &image); // Leaves the file rewound
+    bool isFlashed(const ImageId &id);
+    void recordFlashed(const ImageId &id);
+    void forgetFlashed(void); // Call before flashing in case it doesn't finish
+}
@@ -9,13 +9,12 @@
  */
 
 #include "AvrProgrammer.hpp"
+#include "BootTimeline.hpp"
+#include "DebugTrace.hpp"
+#include "ImageRecord.hpp"
 #include "ResourceProvider.hpp"
 
 const uint32_t g_bootBaud = 115200; // Baud rate for programming over serial
-#if defined(PGRMR_DEBUG)
-const uint32_t g_errBaud = 19200;
-const char *g_sdInitErrMsg = "Failed to init SD card.";
-#endif
 
 // Pins
 const uint32_t g_chipSelect = 10; // Chip select for SD card
@@ -23,38 +22,93 @@ const uint32_t g_reset = 6; // Reset pin for other arduino
 
 const char *g_progName = "menu.hex";
 
-pgrmr::AvrProgrammer g_programmer(
-    g_reset
-#if defined(PGRMR_DEBUG)
-    , 4, 5, g_errBaud
-#endif
-);
+pgrmr::AvrProgrammer g_programmer(g_reset);
 rsrc::ResourceProvider g_resourceProvider;
 
+// Hex file bytes written so far, for anyone who wants to report status
+unsigned long g_flashDone = 0, g_flashTotal = 0;
+
+void onFlashProgress(const unsigned long done, const unsigned long total) {
+    g_flashDone = done;
+    g_flashTotal = total;
+}
+
+// What's being flashed, so it can be recorded once it's on the logic MCU
+pgrmr::ImageId g_imageId;
+bool g_booting = true;
+
+// Called once the logic MCU is running its program
+void finishBoot(void) {
+    g_booting = false;
+    boot::mark(boot::Phase::Ready);
+}
+
+// Only reflash when the logic MCU doesn't already hold the image. If it does,
+// it powered up with us and is already running it, and a reset would only
+// send it through the bootloader's wait again
+void startImage(void) {
+    // Read hex file from SD card
+    if(!SD.exists(g_progName)) {
+        while(1);
+    }
+    File program = SD.open(g_progName, FILE_READ);
+    g_imageId = pgrmr::identify(program);
+    boot::mark(boot::Phase::ImageChecked);
+
+    if(pgrmr::isFlashed(g_imageId)) {
+        program.close();
+        boot::mark(boot::Phase::Unchanged);
+        finishBoot();
+        return;
+    }
+
+    pgrmr::forgetFlashed();
+    g_programmer.begin(program, onFlashProgress);
+}
+
 void setup(void) {
+#if defined(PGRMR_DEBUG)
+    trace::begin();
+#endif
+    boot::mark(boot::Phase::Start);
     Serial.begin(g_bootBaud); // Required for AvrProgrammer to work
 
     pinMode(g_chipSelect, OUTPUT);
     if(!SD.begin(g_chipSelect)) {
 #if defined(PGRMR_DEBUG)
-        pgrmr::AvrProgrammer::error(stk500::Error::Generic, g_sdInitErrMsg);
+        trace::fail(pgrmrtrace::Event::SdFailed, stk500::Error::Generic);
 #else
         exit(1);
 #endif
     }
+    boot::mark(boot::Phase::SdReady);
 
     g_programmer.init();
-    delay(500);
+    g_resourceProvider.begin();
+    startImage();
+}
 
-    // Read hex file from SD card
-    if(!SD.exists(g_progName)) {
-        while(1);
+void loop(void) {
+#if defined(PGRMR_DEBUG)
+    trace::drain();
+#endif
+    // Other duties (controller polling, status) can go here between steps
+    if(g_programmer.update()) {
+        return;
     }
-    File program = SD.open(g_progName, FILE_READ);
 
-    g_programmer.program(program);
-}
+    // Retries inside the programmer are used up, so take it from the top
+    if(g_programmer.state() == pgrmr::State::Failed) {
+        Serial.begin(g_bootBaud); // In case the provider switched rates
+        startImage();
+        return;
+    }
+
+    if(g_booting) {
+        pgrmr::recordFlashed(g_imageId);
+        boot::mark(boot::Phase::Flashed);
+        finishBoot();
+    }
 
-void loop(void) {
     g_resourceProvider.provide();
 }
@@ -0,0 +1,101 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the read-ahead block cache
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include "ReadAhead.hpp"
+
+using namespace rsrc;
+
+ReadAhead::ReadAhead(void) : _current(-1), _hits(0), _misses(0) {
+    for(int i = 0; i < g_readAheadBlocks; i++) {
+        _blocks[i].file = nullptr;
+    }
+}
+
+int ReadAhead::fetch(
+        File *file, const uint32_t pos, const int maxLen,
+        const uint8_t *&ref_data) {
+    int block = _find(file, pos);
+    if(block < 0) {
+        _misses++;
+        block = (_current + 1) % g_readAheadBlocks; // Keep the current one
+        if(!_load(block, file, pos - (pos % g_readAheadBlockSize))) {
+            return 0;
+        }
+    } else if(block != _current) {
+        _hits++; // Prefetched
+    }
+    _current = block;
+
+    const ReadAheadBlock &blk = _blocks[block];
+    int avail = static_cast<int>(blk.pos + blk.len - pos);
+    if(avail <= 0) {
+        return 0; // End of file
+    }
+    ref_data = &blk.data[pos - blk.pos];
+    return min(maxLen, avail);
+}
+
+void ReadAhead::prefetch(void) {
+    if(_current < 0) {
+        return;
+    }
+    const ReadAheadBlock &cur = _blocks[_current];
+    if(cur.len < g_readAheadBlockSize) {
+        return; // Hit the end of the file, so there's no next block
+    }
+    uint32_t next = cur.pos + g_readAheadBlockSize;
+    if(_find(cur.file, next) >= 0) {
+        return;
+    }
+    _load((_current + 1) % g_readAheadBlocks, cur.file, next);
+}
+
+void ReadAhead::invalidate(const File *file) {
+    for(int i = 0; i < g_readAheadBlocks; i++) {
+        if(_blocks[i].file == file) {
+            _blocks[i].file = nullptr;
+            if(_current == i) {
+                _current = -1;
+            }
+        }
+    }
+}
+
+uint32_t ReadAhead::hits(void) const {
+    return _hits;
+}
+
+uint32_t ReadAhead::misses(void) const {
+    return _misses;
+}
+
+int ReadAhead::_find(const File *file, const uint32_t pos) const {
+    for(int i = 0; i < g_readAheadBlocks; i++) {
+        const ReadAheadBlock &blk = _blocks[i];
+        if((blk.file == file) && (pos >= blk.pos)
+                && (pos < blk.pos + g_readAheadBlockSize)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ReadAhead::_load(const int block, File *file, const uint32_t pos) {
+    ReadAheadBlock &blk = _blocks[block];
+    blk.file = nullptr;
+    if(!file->seek(pos)) {
+        return false;
+    }
+    int n = file->read(blk.data, g_readAheadBlockSize);
+    if(n < 0) {
+        return false;
+    }
+    blk.file = file;
+    blk.pos = pos;
+    blk.len = n;
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Tiny block cache between the SD card and the transfer pump
+ * - Reads are served out of 64 byte blocks aligned in the file, and while the
+ *   provider would otherwise sit idle, the block after the one being streamed
+ *   is loaded ahead of time, hiding SD latency from sequential readers
+ * - A block switch counts as a hit if the block was already there
+ */
+
+#pragma once
+
+#include <SD.h>
+
+namespace rsrc {
+    const int g_readAheadBlockSize = 64;
+    const int g_readAheadBlocks = 2;
+
+    struct ReadAheadBlock {
+        File *file;
+        uint32_t pos; // Aligned to g_readAheadBlockSize
+        int len; // Less than the block size at the end of a file
+        uint8_t data[g_readAheadBlockSize];
+    };
+
+    class ReadAhead {
+        public:
+            ReadAhead(void);
+
+            // Point ref_data at up to maxLen bytes of file at pos
+            int fetch(
+                File *file, const uint32_t pos, const int maxLen,
+                const uint8_t *&ref_data
+            );
+            void prefetch(void); // Call when there's nothing better to do
+            void invalidate(const File *file); // Before close/reopen/write
+
+            uint32_t hits(void) const;
+            uint32_t misses(void) const;
+
+        private:
+            ReadAheadBlock _blocks[g_readAheadBlocks];
+            int _current; // Block last served from, or -1
+            uint32_t _hits, _misses;
+
+            int _find(const File *file, const uint32_t pos) const;
+            bool _load(
+                const int block, File *file, const uint32_t pos
+            );
+    };
+}
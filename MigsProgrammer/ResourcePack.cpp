@@ -0,0 +1,67 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the resource pack reader
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <PackFormat.hpp>
+#include "ResourcePack.hpp"
+
+using namespace rsrc;
+
+uint8_t g_packHeader[g_packHeaderSize];
+
+ResourcePack::ResourcePack(void) : _count(0), _tocOffset(0) {
+}
+
+bool ResourcePack::open(const char *name) {
+    if(_file) {
+        _file.close();
+    }
+    _count = 0;
+
+    _file = SD.open(name, FILE_READ);
+    if(!_file) {
+        return false;
+    }
+    if(_file.read(g_packHeader, g_packHeaderSize) != g_packHeaderSize) {
+        _file.close();
+        return false;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, &g_packHeader[0], 4);
+    if((magic != g_packMagic) || (g_packHeader[4] != g_packVersion)
+            || (g_packHeader[5] != g_packEntrySize)) {
+        _file.close();
+        return false;
+    }
+    memcpy(&_count, &g_packHeader[6], 2);
+    memcpy(&_tocOffset, &g_packHeader[8], 4);
+    return true;
+}
+
+bool ResourcePack::isOpen(void) {
+    return _file;
+}
+
+uint16_t ResourcePack::count(void) const {
+    return _count;
+}
+
+bool ResourcePack::find(const uint16_t id, PackEntry &ref_entry) {
+    if(!_file || (id >= _count)) {
+        return false;
+    }
+    if(!_file.seek(_tocOffset + static_cast<uint32_t>(id) * g_packEntrySize)) {
+        return false;
+    }
+    uint8_t *entry = reinterpret_cast<uint8_t *>(&ref_entry);
+    return (_file.read(entry, g_packEntrySize) == g_packEntrySize)
+        && (ref_entry.id == id);
+}
+
+File &ResourcePack::file(void) {
+    return _file;
+}
@@ -0,0 +1,29 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The open resource pack (see MigsSdk's PackFormat.hpp)
+ * - Opened once per game, then assets are found by id with a single seek
+ *   instead of a FAT lookup and filename parse per load
+ */
+
+#pragma once
+
+#include <SD.h>
+#include <PackFormat.hpp>
+
+namespace rsrc {
+    class ResourcePack {
+        public:
+            ResourcePack(void);
+            bool open(const char *name); // Closes whatever was open before
+            bool isOpen(void);
+            uint16_t count(void) const;
+            bool find(const uint16_t id, PackEntry &ref_entry);
+            File &file(void);
+
+        private:
+            File _file;
+            uint16_t _count;
+            uint32_t _tocOffset;
+    };
+}
@@ -5,62 +5,559 @@
 
 #include <Arduino.h>
 #include <SD.h>
+#include <ResourceProtocol.hpp>
+#include <GpuLink.hpp>
+#include "GameIndex.hpp"
+#include "GpuUploader.hpp"
+#include "ReadAhead.hpp"
+#include "ResourcePack.hpp"
+#include "SaveFile.hpp"
 #include "ResourceProvider.hpp"
 
 using namespace rsrc;
 
-const int g_fNameLenLimit = 13;
-
 // Save on dynamic resource breaking system by using globals
-char g_fName[g_fNameLenLimit]; // Only allow root dir 8.3 filenames + \0 for now
-int g_fNameInd = 0;
-File g_program, g_entry;
+char g_fName[g_nameLenLimit]; // Only allow root dir 8.3 filenames + \0 for now
+File g_files[g_maxHandles];
+GameIndex g_games;
+ResourcePack g_pack;
+PackEntry g_asset;
+SaveFile g_save;
+
+// Request being received: <cmd> <len> <payload...>
+uint8_t g_frame[2 + g_maxPayload];
+int g_frameInd = 0;
+unsigned long g_frameStart = 0;
+
+/*
+ * Read being sent. Data goes out in blocks through Serial.write(buff, n):
+ * - Blocks come from the read-ahead cache, which fills them with
+ *   File::read(buff, n) straight out of the SD library's 512 byte sector
+ *   cache, so each sector is only read from the card once
+ * - A full sector sized buffer won't fit next to that cache in 2KB, so
+ *   blocks are the size of the hardware serial tx buffer instead
+ */
+ReadAhead g_readAhead;
+uint32_t g_xferPos = 0;
+File *g_xferFile = nullptr;
+uint16_t g_xferLeft = 0;
+uint8_t g_window = 0, g_windowLeft = 0; // Window of 0 == no flow control
+bool g_awaitingAck = false;
+unsigned long g_ackWaitStart = 0;
+
+// Upload to the GPU, which runs alongside everything else
+GpuUploader g_uploader(g_readAhead);
 
 ResourceProvider::ResourceProvider(void) {
 }
 
+void ResourceProvider::begin(void) {
+    g_uploader.begin();
+}
+
 void ResourceProvider::provide(void) {
-    while(true) {
-        if(Serial.available()) {
-            uint8_t cmd = Serial.read();
-            switch(cmd) {
-                case 0x55:
-                    return;
-
-                case 'F':
-                    g_fNameInd = 0;
-                    while(Serial.available()) {
-                        g_fName[g_fNameInd++] = Serial.read();
-                    }
-                    g_fName[g_fNameInd] = 0;
-                    if(!SD.exists(g_fName)) {
-                        while(1);
-                    }
-                    g_program = SD.open(g_fName, FILE_READ);
-                    while(g_program.available()) {
-                        Serial.write(g_program.read());
-                    }
-                    g_program.close();
-                    break;
-
-                case 'L':
-                    g_program = SD.open("/", FILE_READ);
-                    while(true) {
-                        g_entry = g_program.openNextFile();
-                        if(!g_entry) {
-                            break;
-                        }
-
-                        Serial.write('F');
-                        for(g_fNameInd = 0;
-                                g_fNameInd < g_fNameLenLimit;
-                                g_fNameInd++) {
-                            Serial.write(g_entry.name()[g_fNameInd]);
-                        }
-                        g_entry.close();
-                    }
-                    break;
+    g_uploader.service();
+
+    if(g_xferLeft > 0) {
+        _pump();
+        if(g_awaitingAck || (Serial.availableForWrite() == 0)) {
+            g_readAhead.prefetch();
+        }
+        return;
+    }
+
+    while(Serial.available()) {
+        uint8_t b = Serial.read();
+        if((g_frameInd == 0) && (b == g_idleByte)) {
+            continue;
+        }
+        if(g_frameInd == 0) {
+            g_frameStart = millis();
+        }
+        g_frame[g_frameInd++] = b;
+
+        if((g_frameInd == 2) && (g_frame[1] > g_maxPayload)) {
+            g_frameInd = 0;
+            _respond(Status::BadFrame, 0);
+            return;
+        }
+        if((g_frameInd >= 2) && (g_frameInd == 2 + g_frame[1])) {
+            g_frameInd = 0;
+            _serve();
+            return;
+        }
+    }
+
+    // Don't let half a frame block everything after it
+    if((g_frameInd > 0) && (millis() - g_frameStart >= g_frameTimeout)) {
+        g_frameInd = 0;
+        _respond(Status::BadFrame, 0);
+    } else if(g_frameInd == 0) {
+        g_save.idle(); // Write back a save once the game stops writing
+        g_readAhead.prefetch(); // Get the next block while the client works
+    }
+}
+
+void ResourceProvider::_serve(void) {
+    switch(static_cast<Command>(g_frame[0])) {
+        case Command::Open:
+            _open();
+            break;
+        case Command::Read:
+            _read();
+            break;
+        case Command::Close:
+            _close();
+            break;
+        case Command::List:
+            _list();
+            break;
+        case Command::Baud:
+            _baud();
+            break;
+        case Command::OpenPack:
+            _openPack();
+            break;
+        case Command::AssetInfo:
+            _assetInfo();
+            break;
+        case Command::ReadAsset:
+            _readAsset();
+            break;
+        case Command::Stats:
+            _stats();
+            break;
+        case Command::Upload:
+            _upload();
+            break;
+        case Command::UploadStatus:
+            _uploadStatus();
+            break;
+        case Command::AssetHash:
+            _assetHash();
+            break;
+        case Command::OpenSave:
+            _openSave();
+            break;
+        case Command::WriteSave: {
+            uint32_t offset = 0;
+            for(int i = 0; i < 4; i++) {
+                offset |= static_cast<uint32_t>(g_frame[2 + i]) << (i * 8);
             }
+            _writeSave(offset, 4);
+        } break;
+        case Command::AppendSave:
+            _writeSave(g_save.size(), 0);
+            break;
+        case Command::SyncSave:
+            _syncSave();
+            break;
+        case Command::ReadSave:
+            _readSave();
+            break;
+        default:
+            _respond(Status::BadFrame, 0);
+            break;
+    }
+}
+
+void ResourceProvider::_open(void) {
+    int len = g_frame[1];
+    if((len == 0) || (len >= g_nameLenLimit)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    memcpy(g_fName, &g_frame[2], len);
+    g_fName[len] = 0;
+
+    int handle = 0;
+    while((handle < g_maxHandles) && g_files[handle]) {
+        handle++;
+    }
+    if(handle >= g_maxHandles) {
+        _respond(Status::NoHandles, 0);
+        return;
+    }
+    if(!SD.exists(g_fName)) {
+        _respond(Status::NotFound, 0);
+        return;
+    }
+    g_files[handle] = SD.open(g_fName, FILE_READ);
+    if(!g_files[handle]) {
+        _respond(Status::NotFound, 0);
+        return;
+    }
+
+    _respond(Status::Ok, 1);
+    Serial.write(static_cast<uint8_t>(handle));
+}
+
+// <handle> <offset:4> <len:2> [window]
+void ResourceProvider::_read(void) {
+    if((g_frame[1] != 7) && (g_frame[1] != 8)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    uint8_t handle = g_frame[2];
+    if((handle >= g_maxHandles) || !g_files[handle]) {
+        _respond(Status::BadHandle, 0);
+        return;
+    }
+    uint32_t offset = 0;
+    for(int i = 0; i < 4; i++) {
+        offset |= static_cast<uint32_t>(g_frame[3 + i]) << (i * 8);
+    }
+    uint16_t len = g_frame[7] | (static_cast<uint16_t>(g_frame[8]) << 8);
+
+    _startRead(
+        g_files[handle], 0, g_files[handle].size(), offset, len,
+        (g_frame[1] == 8) ? g_frame[9] : 0
+    );
+}
+
+// Start sending len bytes at offset of the blob at base in file
+void ResourceProvider::_startRead(
+        File &file, const uint32_t base, const uint32_t size,
+        const uint32_t offset, uint16_t len, const uint8_t window) {
+    if(offset > size) {
+        _respond(Status::BadOffset, 0);
+        return;
+    }
+    if(size - offset < len) {
+        len = size - offset;
+    }
+
+    _respond(Status::Ok, len);
+    g_xferFile = &file;
+    g_xferPos = base + offset;
+    g_xferLeft = len;
+    g_window = g_windowLeft = window;
+    g_awaitingAck = false;
+    _pump();
+}
+
+// Send as much of the current read as the tx buffer and window allow
+void ResourceProvider::_pump(void) {
+    while(g_xferLeft > 0) {
+        if(g_awaitingAck) {
+            if(Serial.available()) {
+                if(Serial.read() == g_ackByte) {
+                    g_awaitingAck = false;
+                    g_windowLeft = g_window;
+                }
+            } else if(millis() - g_ackWaitStart >= g_ackTimeout) {
+                g_xferLeft = 0; // Client gave up, so drop the rest
+            }
+            return;
+        }
+
+        int room = Serial.availableForWrite();
+        if(g_window > 0) {
+            room = min(room, g_windowLeft);
+        }
+        if(room <= 0) {
+            return;
+        }
+
+        const uint8_t *data;
+        int n = g_readAhead.fetch(g_xferFile, g_xferPos, g_xferLeft, data);
+        if(n > 0) {
+            n = min(n, room);
+            Serial.write(data, n);
+        } else {
+            // Card error, but the length is promised, so pad it out
+            n = min(room, g_xferLeft);
+            for(int i = 0; i < n; i++) {
+                Serial.write(static_cast<uint8_t>(0));
+            }
+        }
+        g_xferPos += n;
+        g_xferLeft -= n;
+
+        if((g_window > 0) && ((g_windowLeft -= n) == 0) && (g_xferLeft > 0)) {
+            g_awaitingAck = true;
+            g_ackWaitStart = millis();
+        }
+    }
+}
+
+void ResourceProvider::_close(void) {
+    if(g_frame[1] != 1) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    uint8_t handle = g_frame[2];
+    if((handle >= g_maxHandles) || !g_files[handle]) {
+        _respond(Status::BadHandle, 0);
+        return;
+    }
+    g_readAhead.invalidate(&g_files[handle]);
+    g_files[handle].close();
+    _respond(Status::Ok, 0);
+}
+
+// <offset:2> <count>, answered with the total and up to g_listMax names
+void ResourceProvider::_list(void) {
+    if(g_frame[1] != 3) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_games.refresh()) {
+        _respond(Status::NotFound, 0);
+        return;
+    }
+    uint16_t offset = g_frame[2] | (static_cast<uint16_t>(g_frame[3]) << 8);
+    uint16_t total = g_games.count();
+    int count = min(g_frame[4], g_listMax);
+    count = (offset >= total) ? 0 : min(count, total - offset);
+
+    _respond(Status::Ok, 2 + count * g_nameLenLimit);
+    Serial.write(static_cast<uint8_t>(total & 0xFF));
+    Serial.write(static_cast<uint8_t>((total >> 8) & 0xFF));
+    for(int i = 0; i < count; i++) {
+        g_games.name(offset + i, g_fName);
+        Serial.write(reinterpret_cast<uint8_t *>(g_fName), g_nameLenLimit);
+    }
+}
+
+void ResourceProvider::_openPack(void) {
+    int len = g_frame[1];
+    if((len == 0) || (len >= g_nameLenLimit)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    memcpy(g_fName, &g_frame[2], len);
+    g_fName[len] = 0;
+
+    g_uploader.cancel(&g_pack.file());
+    g_readAhead.invalidate(&g_pack.file());
+    if(!g_pack.open(g_fName)) {
+        _respond(Status::BadPack, 0);
+        return;
+    }
+    uint16_t count = g_pack.count();
+    _respond(Status::Ok, 2);
+    Serial.write(static_cast<uint8_t>(count & 0xFF));
+    Serial.write(static_cast<uint8_t>((count >> 8) & 0xFF));
+}
+
+// <id:2>
+void ResourceProvider::_assetInfo(void) {
+    if(g_frame[1] != 2) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_pack.isOpen()) {
+        _respond(Status::BadPack, 0);
+        return;
+    }
+    uint16_t id = g_frame[2] | (static_cast<uint16_t>(g_frame[3]) << 8);
+    if(!g_pack.find(id, g_asset)) {
+        _respond(Status::BadAsset, 0);
+        return;
+    }
+    _respond(Status::Ok, 6);
+    Serial.write(static_cast<uint8_t>(g_asset.type));
+    Serial.write(g_asset.flags);
+    Serial.write(reinterpret_cast<const uint8_t *>(&g_asset.length), 4);
+}
+
+// <id:2> <offset:4> <len:2> [window]
+void ResourceProvider::_readAsset(void) {
+    if((g_frame[1] != 8) && (g_frame[1] != 9)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_pack.isOpen()) {
+        _respond(Status::BadPack, 0);
+        return;
+    }
+    uint16_t id = g_frame[2] | (static_cast<uint16_t>(g_frame[3]) << 8);
+    if(!g_pack.find(id, g_asset)) {
+        _respond(Status::BadAsset, 0);
+        return;
+    }
+    uint32_t offset = 0;
+    for(int i = 0; i < 4; i++) {
+        offset |= static_cast<uint32_t>(g_frame[4 + i]) << (i * 8);
+    }
+    uint16_t len = g_frame[8] | (static_cast<uint16_t>(g_frame[9]) << 8);
+
+    _startRead(
+        g_pack.file(), g_asset.offset, g_asset.length, offset, len,
+        (g_frame[1] == 9) ? g_frame[10] : 0
+    );
+}
+
+// <read-ahead hits:4> <read-ahead misses:4>
+void ResourceProvider::_stats(void) {
+    uint32_t hits = g_readAhead.hits(), misses = g_readAhead.misses();
+    _respond(Status::Ok, 8);
+    Serial.write(reinterpret_cast<const uint8_t *>(&hits), 4);
+    Serial.write(reinterpret_cast<const uint8_t *>(&misses), 4);
+}
+
+// <id:2> <first gpu slot:2>
+void ResourceProvider::_upload(void) {
+    if(g_frame[1] != 4) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_pack.isOpen()) {
+        _respond(Status::BadPack, 0);
+        return;
+    }
+    if(g_uploader.busy()) {
+        _respond(Status::Busy, 0);
+        return;
+    }
+    uint16_t id = g_frame[2] | (static_cast<uint16_t>(g_frame[3]) << 8);
+    if(!g_pack.find(id, g_asset)) {
+        _respond(Status::BadAsset, 0);
+        return;
+    }
+    uint16_t slot = g_frame[4] | (static_cast<uint16_t>(g_frame[5]) << 8);
+    g_uploader.start(&g_pack.file(), g_asset.offset, g_asset.length, slot);
+    _respond(Status::Ok, 0);
+}
+
+// <bytes left:4>
+void ResourceProvider::_uploadStatus(void) {
+    uint32_t left = g_uploader.left();
+    _respond(Status::Ok, 4);
+    Serial.write(reinterpret_cast<const uint8_t *>(&left), 4);
+}
+
+// <id:2> <image:2>. Read through the read-ahead blocks, so an upload of the
+// same image right after comes out of RAM
+void ResourceProvider::_assetHash(void) {
+    if(g_frame[1] != 4) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_pack.isOpen()) {
+        _respond(Status::BadPack, 0);
+        return;
+    }
+    uint16_t id = g_frame[2] | (static_cast<uint16_t>(g_frame[3]) << 8);
+    if(!g_pack.find(id, g_asset)) {
+        _respond(Status::BadAsset, 0);
+        return;
+    }
+    uint16_t image = g_frame[4] | (static_cast<uint16_t>(g_frame[5]) << 8);
+    uint32_t start = static_cast<uint32_t>(image) * gpulink::g_imageSize;
+    if(start + gpulink::g_imageSize > g_asset.length) {
+        _respond(Status::BadOffset, 0);
+        return;
+    }
+
+    uint32_t hash = gpulink::g_hashStart;
+    for(int done = 0; done < gpulink::g_imageSize; ) {
+        const uint8_t *data;
+        int n = g_readAhead.fetch(
+            &g_pack.file(), g_asset.offset + start + done,
+            gpulink::g_imageSize - done, data
+        );
+        if(n <= 0) {
+            _respond(Status::BadAsset, 0);
+            return;
+        }
+        for(int i = 0; i < n; i++) {
+            hash = gpulink::hashByte(hash, data[i]);
         }
+        done += n;
+    }
+    _respond(Status::Ok, 4);
+    Serial.write(reinterpret_cast<const uint8_t *>(&hash), 4);
+}
+
+void ResourceProvider::_openSave(void) {
+    int len = g_frame[1];
+    if((len == 0) || (len >= g_nameLenLimit)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    memcpy(g_fName, &g_frame[2], len);
+    g_fName[len] = 0;
+
+    g_readAhead.invalidate(&g_save.file());
+    if(!g_save.open(g_fName)) {
+        _respond(Status::BadSave, 0);
+        return;
+    }
+    uint32_t size = g_save.size();
+    _respond(Status::Ok, 4);
+    Serial.write(reinterpret_cast<const uint8_t *>(&size), 4);
+}
+
+// Data follows the first dataStart bytes of the payload
+void ResourceProvider::_writeSave(const uint32_t offset, const int dataStart) {
+    if(g_frame[1] < dataStart) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_save.isOpen()) {
+        _respond(Status::BadSave, 0);
+        return;
+    }
+    if(offset > g_save.size()) {
+        _respond(Status::BadOffset, 0);
+        return;
     }
+    g_readAhead.invalidate(&g_save.file());
+    bool ok = g_save.write(
+        offset, &g_frame[2 + dataStart], g_frame[1] - dataStart
+    );
+    _respond(ok ? Status::Ok : Status::BadSave, 0);
+}
+
+void ResourceProvider::_syncSave(void) {
+    if(!g_save.isOpen()) {
+        _respond(Status::BadSave, 0);
+        return;
+    }
+    _respond(g_save.sync() ? Status::Ok : Status::BadSave, 0);
+}
+
+// <offset:4> <len:2> [window]
+void ResourceProvider::_readSave(void) {
+    if((g_frame[1] != 6) && (g_frame[1] != 7)) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(!g_save.isOpen() || !g_save.sync()) {
+        _respond(Status::BadSave, 0);
+        return;
+    }
+    uint32_t offset = 0;
+    for(int i = 0; i < 4; i++) {
+        offset |= static_cast<uint32_t>(g_frame[2 + i]) << (i * 8);
+    }
+    uint16_t len = g_frame[6] | (static_cast<uint16_t>(g_frame[7]) << 8);
+
+    _startRead(
+        g_save.file(), 0, g_save.size(), offset, len,
+        (g_frame[1] == 7) ? g_frame[8] : 0
+    );
+}
+
+// Answer at the current rate, then switch. The client switches on the answer
+void ResourceProvider::_baud(void) {
+    if(g_frame[1] != 1) {
+        _respond(Status::BadFrame, 0);
+        return;
+    }
+    if(g_frame[2] >= g_baudCount) {
+        _respond(Status::BadBaud, 0);
+        return;
+    }
+    _respond(Status::Ok, 0);
+    Serial.flush();
+    Serial.begin(g_bauds[g_frame[2]]);
+}
+
+void ResourceProvider::_respond(const Status status, const uint16_t len) {
+    Serial.write(static_cast<uint8_t>(status));
+    Serial.write(static_cast<uint8_t>(len & 0xFF));
+    Serial.write(static_cast<uint8_t>((len >> 8) & 0xFF));
 }
@@ -4,14 +4,46 @@
  * - When not reprogramming the CPU, we want the programmer to provide
  *   resources from the SD card
  * - As long as we don't force a reset, we can continue to use Serial
+ * - Speaks the framed protocol in MigsSdk's ResourceProtocol.hpp
+ * - Also feeds pack assets to the GPU over I2C when asked to upload them
+ * - And keeps the game's save file, writing it back while idle
  */
 
 #pragma once
 
+#include <SD.h>
+#include <ResourceProtocol.hpp>
+
 namespace rsrc {
     class ResourceProvider {
         public:
             ResourceProvider(void);
-            void provide(void); // Loops until 0x55 is sent over serial
+            void begin(void); // Join the GPU's bus for uploads
+            void provide(void); // Serves at most one request, never waits
+
+        private:
+            void _serve(void);
+            void _open(void);
+            void _read(void);
+            void _startRead(
+                File &file, const uint32_t base, const uint32_t size,
+                const uint32_t offset, uint16_t len, const uint8_t window
+            );
+            void _pump(void);
+            void _close(void);
+            void _list(void);
+            void _baud(void);
+            void _openPack(void);
+            void _assetInfo(void);
+            void _readAsset(void);
+            void _stats(void);
+            void _upload(void);
+            void _uploadStatus(void);
+            void _assetHash(void);
+            void _openSave(void);
+            void _writeSave(const uint32_t offset, const int dataStart);
+            void _syncSave(void);
+            void _readSave(void);
+            void _respond(const Status status, const uint16_t len);
     };
 }
@@ -0,0 +1,106 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the write-behind save file
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include "SaveFile.hpp"
+
+using namespace rsrc;
+
+SaveFile::SaveFile(void) :
+        _size(0), _buffPos(0), _buffLen(0), _dirty(false), _lastWrite(0) {
+}
+
+bool SaveFile::open(const char *name) {
+    if(_file) {
+        sync();
+        _file.close();
+    }
+    _size = 0;
+    _buffLen = 0;
+    _dirty = false;
+
+    _file = SD.open(name, O_READ | O_WRITE | O_CREAT);
+    if(!_file) {
+        return false;
+    }
+    _size = _file.size();
+    return true;
+}
+
+bool SaveFile::isOpen(void) {
+    return _file;
+}
+
+uint32_t SaveFile::size(void) const {
+    return _size;
+}
+
+bool SaveFile::write(const uint32_t offset, const uint8_t *data, int len) {
+    if(!_file || (offset > _size)) {
+        return false;
+    }
+
+    uint32_t pos = offset;
+    while(len > 0) {
+        if(_buffLen == 0) {
+            _buffPos = pos;
+        }
+
+        // Fits if it starts inside or right after what's buffered
+        uint32_t end = _buffPos - (_buffPos % g_saveBuffSize) + g_saveBuffSize;
+        if((pos < _buffPos) || (pos > _buffPos + _buffLen) || (pos >= end)) {
+            if(!_writeBack()) {
+                return false;
+            }
+            continue;
+        }
+
+        int n = min(static_cast<uint32_t>(len), end - pos);
+        memcpy(&_buff[pos - _buffPos], data, n);
+        _buffLen = max(_buffLen, static_cast<int>(pos - _buffPos) + n);
+        pos += n;
+        data += n;
+        len -= n;
+    }
+
+    _size = max(_size, pos);
+    _dirty = true;
+    _lastWrite = millis();
+    return true;
+}
+
+bool SaveFile::sync(void) {
+    if(!_file || !_dirty) {
+        return true;
+    }
+    if(!_writeBack()) {
+        return false;
+    }
+    _file.flush();
+    _dirty = false;
+    return true;
+}
+
+void SaveFile::idle(void) {
+    if(_dirty && (millis() - _lastWrite >= g_saveIdleFlush)) {
+        sync();
+    }
+}
+
+File &SaveFile::file(void) {
+    return _file;
+}
+
+// Buffer into the SD library's sector cache
+bool SaveFile::_writeBack(void) {
+    if(_buffLen == 0) {
+        return true;
+    }
+    bool ok = _file.seek(_buffPos)
+        && (_file.write(_buff, _buffLen) == static_cast<size_t>(_buffLen));
+    _buffLen = 0;
+    return ok;
+}
@@ -0,0 +1,44 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - A game's save file, written behind through a small RAM buffer
+ * - Writes land in the buffer and only go to the card when it fills, when a
+ *   write isn't contiguous with it, on sync(), or once writes stop for a bit,
+ *   so a game saving a few bytes at a time never waits on the card
+ * - A sector sized buffer won't fit next to the SD library's own, so the
+ *   buffer never crosses a g_saveBuffSize boundary instead. That way every
+ *   write-back touches exactly one sector
+ */
+
+#pragma once
+
+#include <SD.h>
+
+namespace rsrc {
+    const int g_saveBuffSize = 64; // Divides the 512 byte sector size
+    const unsigned long g_saveIdleFlush = 250; // ms without writes to flush
+
+    class SaveFile {
+        public:
+            SaveFile(void);
+            bool open(const char *name); // Syncs and closes the last one
+            bool isOpen(void);
+            uint32_t size(void) const; // Including what's still buffered
+
+            // No holes, so offset can be at most size()
+            bool write(const uint32_t offset, const uint8_t *data, int len);
+            bool sync(void); // Everything on the card, directory entry too
+            void idle(void); // Call when there's nothing better to do
+            File &file(void); // For reads, after a sync()
+
+        private:
+            File _file;
+            uint32_t _size, _buffPos; // _buffPos is the offset of _buff[0]
+            int _buffLen; // 0 when the buffer holds nothing
+            bool _dirty; // Not flushed since the last write
+            unsigned long _lastWrite;
+            uint8_t _buff[g_saveBuffSize];
+
+            bool _writeBack(void);
+    };
+}
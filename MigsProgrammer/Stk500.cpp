@@ -13,363 +13,157 @@
 
 const char *stk500::signOnMessage = "AVR STK";
 
-#if !defined(STK500_DEBUG)
 uint8_t g_msg[8], g_resp[8];
-#else
-uint8_t g_msg[8], stk500::g_resp[8];
-#endif
 
 const int g_memType = 'F';
 const int g_pageSize = 128;
 const int g_flash = 1;
 
-int g_tries = 0;
-bool g_quit = false;
+// Optiboot answers in well under a ms, page writes take ~5ms, so this is slack
+const unsigned long g_cmdTimeout = 50;
 
-#if defined(STK500_DEBUG)
-const char *g_unrecoverable1ErrMsg = "Unrecoverable #1";
-const char *g_unrecoverable2ErrMsg = "Unrecoverable #2";
-const char *g_unrecoverable3ErrMsg = "Unrecoverable #3";
-#endif
+// State of the exchange in flight
+bool g_active = false;
+const uint8_t *g_payload = nullptr;
+unsigned int g_headLen = 0, g_payloadLen = 0, g_txLen = 0, g_txInd = 0;
+unsigned int g_respLen = 0, g_respInd = 0;
+unsigned long g_sentTime = 0;
+stk500::Error g_failedErr = stk500::Error::NotOk; // What Response::Failed means
 
-void stk500::send(uint8_t *buff, const unsigned int len) {
+void stk500::send(const uint8_t *buff, const unsigned int len) {
     Serial.write(buff, len);
 }
 
-stk500::Error stk500::recv(uint8_t *buff, const unsigned int len) {
-    if(Serial.readBytes(buff, len) < 0) {
-        return Error::NoProgrammer;
-    }
-    return Error::None;
-}
-
 void stk500::drain(void) {
     while(Serial.available() > 0) {
         Serial.read();
     }
 }
 
-stk500::Error stk500::getSync(void) {
-    // Get in sync
-    g_msg[0] = static_cast<uint8_t>(Command::GetSync);
-    g_msg[1] = static_cast<uint8_t>(Special::CrcEop);
-
-    // First send and drain a few times to get rid of noise
-    send(g_msg, 2);
-    drain();
-    send(g_msg, 2);
-    drain();
-
-    send(g_msg, 2);
-    if(recv(g_resp, 1) != Error::None) {
-        return Error::Generic;
-    }
-    if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-        drain();
-        return Error::ProtocolSync;
-    }
+// Queue up g_msg[0..headLen) + payload + CrcEop, expecting respLen bytes back
+static void beginExchange(
+        const unsigned int headLen,
+        const uint8_t *payload, const unsigned int payloadLen,
+        const unsigned int respLen, const stk500::Error failedErr) {
+    g_headLen = headLen;
+    g_payload = payload;
+    g_payloadLen = payloadLen;
+    g_txLen = headLen + payloadLen + 1;
+    g_txInd = 0;
+    g_respLen = respLen;
+    g_respInd = 0;
+    g_failedErr = failedErr;
+    g_active = true;
+}
 
-    if(recv(g_resp, 1) != Error::None) {
+stk500::Error stk500::poll(void) {
+    if(!g_active) {
         return Error::Generic;
     }
-    if(g_resp[0] != static_cast<uint8_t>(Response::Ok)) {
-        return Error::NotOk;
-    }
 
-    return Error::None;
-}
+    // Only hand Serial what fits so we never wait on the tx buffer
+    while(g_txInd < g_txLen) {
+        unsigned int room = Serial.availableForWrite();
+        if(room == 0) {
+            return Error::Pending;
+        }
 
-#if !defined(STK500_DEBUG)
-stk500::Error stk500::getParam(const Parameter param, unsigned int &ref_val) {
-#else
-stk500::Error stk500::getParam(
-        const Parameter param, unsigned int &ref_val,
-        void (*warning)(Error, const char *),
-        void (*error)(Error, const char *)) {
-#endif
-    unsigned int val;
+        unsigned int n;
+        if(g_txInd < g_headLen) {
+            n = min(room, g_headLen - g_txInd);
+            send(&g_msg[g_txInd], n);
+        } else if(g_txInd < g_headLen + g_payloadLen) {
+            n = min(room, g_headLen + g_payloadLen - g_txInd);
+            send(&g_payload[g_txInd - g_headLen], n);
+        } else {
+            n = 1;
+            Serial.write(static_cast<uint8_t>(Special::CrcEop));
+        }
+        g_txInd += n;
 
-    g_tries = 0;
-    g_quit = false;
-    while(!g_quit) {
-        g_tries++;
+        if(g_txInd == g_txLen) {
+            g_sentTime = millis();
+        }
+    }
 
-        // Reset to get param command
-        g_msg[0] = static_cast<uint8_t>(Command::GetParameter);
-        g_msg[1] = static_cast<uint8_t>(param);
-        g_msg[2] = static_cast<uint8_t>(Special::CrcEop);
-        send(g_msg, 3);
+    while((g_respInd < g_respLen) && (Serial.available() > 0)) {
+        g_resp[g_respInd++] = Serial.read();
 
-        if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-            error(Error::Generic, g_unrecoverable1ErrMsg);
-#else
-            exit(1);
-#endif
-        }
-        if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
-            if(g_tries > 33) {
-#if defined(STK500_DEBUG)
-                warning(Error::NoSync, "Get param too many retries.");
-#endif
+        if(g_respInd == 1) {
+            if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
+                g_active = false;
                 return Error::NoSync;
             }
-            Error syncErr = getSync(); // Modifies g_msg too, but non-issue
-            if(syncErr != Error::None) {
-#if defined(STK500_DEBUG)
-                warning(Error::NoSync, "Get param sync failed.");
-#endif
-                return syncErr;
+            if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
+                drain();
+                g_active = false;
+                return Error::ProtocolSync;
             }
-            continue;
-        }
-        if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-#if defined(STK500_DEBUG)
-            warning(Error::ProtocolSync, "Get param not in sync.");
-#endif
-            return Error::ProtocolSync;
         }
-
-        g_quit = true;
     }
 
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable2ErrMsg);
-#else
-        exit(1);
-#endif
+    if(g_respInd < g_respLen) {
+        if(millis() - g_sentTime >= g_cmdTimeout) {
+            g_active = false;
+            return Error::Timeout;
+        }
+        return Error::Pending;
     }
-    val = g_resp[0];
 
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable3ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::Failed)) {
-        return Error::ParameterFailed;
+    g_active = false;
+    switch(g_resp[g_respLen - 1]) {
+        case static_cast<uint8_t>(Response::Ok):
+            return Error::None;
+        case static_cast<uint8_t>(Response::NoDevice):
+            return Error::NoDevice;
+        case static_cast<uint8_t>(Response::Failed):
+            return g_failedErr;
+        default:
+            return Error::UnknownResponse;
     }
-    if(g_resp[0] != static_cast<uint8_t>(Response::Ok)) {
-        return Error::NotOk;
-    }
-
-    ref_val = val;
-    return Error::None;
 }
 
-#if !defined(STK500_DEBUG)
-stk500::Error stk500::loadAddr(const unsigned int addr) {
-#else
-stk500::Error stk500::loadAddr(
-        const unsigned int addr, void (*error)(Error, const char *)) {
-#endif
-    g_tries = 0;
-    g_quit = false;
-    while(!g_quit) {
-        g_tries++;
-
-        // Reset load command
-        g_msg[0] = static_cast<uint8_t>(Command::LoadAddress);
-        g_msg[1] = addr & 0xFF;
-        g_msg[2] = (addr >> 8) & 0xFF;
-        g_msg[3] = static_cast<uint8_t>(Special::CrcEop);
-        send(g_msg, 4);
-
-        if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-            error(Error::Generic, g_unrecoverable1ErrMsg);
-#else
-            exit(1);
-#endif
-        }
-        if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
-            if(g_tries > 33) {
-                return Error::NoSync;
-            }
-            Error syncErr = getSync(); // Modifies g_msg, but non-issue
-            if(syncErr != Error::None) {
-                return syncErr;
-            }
-            continue;
-        }
-        if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-            return Error::ProtocolSync;
-        }
+void stk500::beginSync(void) {
+    // Get rid of any noise left over from reset first
+    drain();
 
-        g_quit = true;
-    }
+    g_msg[0] = static_cast<uint8_t>(Command::GetSync);
+    beginExchange(1, nullptr, 0, 2, Error::NotOk);
+}
 
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable2ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::Ok)) {
-        return Error::None;
-    }
+void stk500::beginGetParam(const Parameter param) {
+    g_msg[0] = static_cast<uint8_t>(Command::GetParameter);
+    g_msg[1] = static_cast<uint8_t>(param);
+    beginExchange(2, nullptr, 0, 3, Error::ParameterFailed);
+}
 
-    return Error::NotOk;
+void stk500::beginLoadAddr(const unsigned int addr) {
+    g_msg[0] = static_cast<uint8_t>(Command::LoadAddress);
+    g_msg[1] = addr & 0xFF;
+    g_msg[2] = (addr >> 8) & 0xFF;
+    beginExchange(3, nullptr, 0, 2, Error::NotOk);
 }
 
 // NOTE: Eeprom not supported
-#if !defined(STK500_DEBUG)
-stk500::Error stk500::pagedWrite(const AvrMem &mem) {
-#else
-stk500::Error stk500::pagedWrite(
-        const AvrMem &mem, void (*error)(Error, const char *)) {
-#endif
+void stk500::beginPagedWrite(const AvrMem &mem) {
     // Send data separately on arduino
     g_msg[0] = static_cast<uint8_t>(Command::ProgramPage);
     g_msg[1] = (g_pageSize >> 8) & 0xFF;
     g_msg[2] = g_pageSize & 0xFF;
     g_msg[3] = g_memType;
-    send(g_msg, 4);
-    send(&mem.buff[0], g_pageSize);
-    g_msg[0] = static_cast<uint8_t>(Special::CrcEop);
-    send(g_msg, 1);
-
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable1ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
-        return Error::NoSync;
-    } 
-    if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-        return Error::ProtocolSync;
-    }
-
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable2ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] != static_cast<uint8_t>(Response::Ok)) {
-        return Error::NotOk;
-    }
-
-    return Error::None;
+    beginExchange(4, mem.buff, g_pageSize, 2, Error::NotOk);
 }
 
-#if !defined(STK500_DEBUG)
-stk500::Error stk500::programEnable(void) {
-#else
-stk500::Error stk500::programEnable(void (*error)(Error, const char *)) {
-#endif
-    g_tries = 0;
-    g_quit = false;
-    while(!g_quit) {
-        g_tries++;
-
-        g_msg[0] = static_cast<uint8_t>(Command::EnterProgramMode);
-        g_msg[1] = static_cast<uint8_t>(Special::CrcEop);
-        send(g_msg, 2);
-
-        if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-            error(Error::Generic, g_unrecoverable1ErrMsg);
-#else
-            exit(1);
-#endif
-        }
-        if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
-            if(g_tries > 33) {
-                return Error::NoSync;
-            }
-            Error syncErr = getSync(); // modifies g_msg, but non-issue
-            if(syncErr != Error::None) {
-                return syncErr;
-            }
-            continue;
-        }
-        if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-            return Error::ProtocolSync;
-        }
-
-        g_quit = true;
-    }
-
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable2ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::Ok)) {
-        return Error::None;
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::NoDevice)) {
-        return Error::NoDevice;
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::Failed)) {
-        return Error::NoProgramMode;
-    }
-
-    return Error::UnknownResponse;
+void stk500::beginProgramEnable(void) {
+    g_msg[0] = static_cast<uint8_t>(Command::EnterProgramMode);
+    beginExchange(1, nullptr, 0, 2, Error::NoProgramMode);
 }
 
-#if !defined(STK500_DEBUG)
-stk500::Error stk500::disableDevice(void) {
-#else
-stk500::Error stk500::disableDevice(void (*error)(Error, const char *)) {
-#endif
-    g_tries = 0;
-    g_quit = false;
-    while(!g_quit) {
-        g_tries++;
-
-        g_msg[0] = static_cast<uint8_t>(Command::LeaveProgramMode);
-        g_msg[1] = static_cast<uint8_t>(Special::CrcEop);
-        send(g_msg, 2);
-
-        if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-            error(Error::Generic, g_unrecoverable1ErrMsg);
-#else
-            exit(1);
-#endif
-        }
-        if(g_resp[0] == static_cast<uint8_t>(Response::NoSync)) {
-            if(g_tries > 33) {
-                return Error::NoSync;
-            }
-            Error syncErr = getSync();
-            if(syncErr != Error::None) {
-                return syncErr;
-            }
-            continue;
-        }
-        if(g_resp[0] != static_cast<uint8_t>(Response::InSync)) {
-            return Error::ProtocolSync;
-        }
-
-        g_quit = true;
-    }
-
-    if(recv(g_resp, 1) != Error::None) {
-#if defined(STK500_DEBUG)
-        error(Error::Generic, g_unrecoverable2ErrMsg);
-#else
-        exit(1);
-#endif
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::Ok)) {
-        return Error::None;
-    }
-    if(g_resp[0] == static_cast<uint8_t>(Response::NoDevice)) {
-        return Error::NoDevice;
-    }
+void stk500::beginDisableDevice(void) {
+    g_msg[0] = static_cast<uint8_t>(Command::LeaveProgramMode);
+    beginExchange(1, nullptr, 0, 2, Error::NotOk);
+}
 
-    return Error::UnknownResponse;
+uint8_t stk500::paramValue(void) {
+    return g_resp[1];
 }
@@ -8,17 +8,11 @@
 
 #pragma once
 
-//#define STK500_DEBUG
-
 #include <Arduino.h>
 
 namespace stk500 {
     extern const char *signOnMessage; // Sign on string for GetSignOn
 
-#if defined(STK500_DEBUG)
-    extern uint8_t g_resp[];
-#endif
-
     struct AvrMem {
         int size;
         unsigned int pageAddr;
@@ -115,31 +109,28 @@ namespace stk500 {
         NoProgramMode = -6, // Failed to get into programming mode
         NoProgrammer = -7, // Programmer not responding
         NotOk = -8,
-        ParameterFailed = -9 // Get parameter failed response
+        ParameterFailed = -9, // Get parameter failed response
+        Timeout = -10, // Response didn't arrive within the command timeout
+        Pending = -11 // Exchange still in progress (not actually an error)
     };
 
-    void send(uint8_t *buff, const unsigned int len);
-    Error recv(uint8_t *buff, const unsigned int len);
+    /*
+     * Commands are exchanged without blocking:
+     * - A begin*() call queues the command
+     * - poll() pushes out as much as the tx buffer takes, then collects the
+     *   response, and returns Error::Pending until the exchange is finished
+     * - Only one exchange may be in flight at a time
+     */
+    void send(const uint8_t *buff, const unsigned int len);
     void drain(void);
-    Error getSync(void);
+    Error poll(void);
+
+    void beginSync(void);
+    void beginGetParam(const Parameter param);
+    void beginLoadAddr(const unsigned int addr);
+    void beginPagedWrite(const AvrMem &mem);
+    void beginProgramEnable(void);
+    void beginDisableDevice(void);
 
-#if !defined(STK500_DEBUG)
-    Error getParam(const Parameter param, unsigned int &ref_val);
-    Error loadAddr(const unsigned int addr);
-    Error pagedWrite(const AvrMem &mem);
-    Error programEnable(void);
-    Error disableDevice(void);
-#else
-    Error getParam(
-        const Parameter param, unsigned int &ref_val,
-        void (*warning)(Error, const char *),
-        void (*error)(Error, const char *)
-    );
-    Error loadAddr(
-        const unsigned int addr, void (*error)(Error, const char *)
-    );
-    Error pagedWrite(const AvrMem &mem, void (*error)(Error, const char *));
-    Error programEnable(void (*error)(Error, const char *));
-    Error disableDevice(void (*error)(Error, const char *));
-#endif
+    uint8_t paramValue(void); // Result of the last finished beginGetParam
 }
@@ -0,0 +1,103 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Resource transfer throughput benchmark, run on the logic MCU
+ * - Put a file named BENCH.BIN (16KB or more) in the SD card root
+ * - Results go out like the programmer's debug output: connect pins 5, 4 to
+ *   a MigsErrorReceiver's 4, 5
+ */
+
+#include <SoftwareSerial.h>
+#include <ResourceClient.hpp>
+
+const char *g_benchFile = "BENCH.BIN";
+const uint16_t g_benchLen = 16384;
+
+SoftwareSerial g_report(4, 5); // rx, tx
+rsrc::ResourceClient g_resources;
+uint8_t g_buff[64];
+uint32_t g_sunk = 0;
+
+void sink(const uint8_t *data, const uint16_t len) {
+    g_sunk += len;
+}
+
+void report(
+        const __FlashStringHelper *what, const uint8_t param,
+        const uint32_t bytes, const unsigned long ms) {
+    g_report.print(what);
+    g_report.print(param, DEC);
+    g_report.print(F(": "));
+    g_report.print(bytes, DEC);
+    g_report.print(F(" B in "));
+    g_report.print(ms, DEC);
+    g_report.print(F(" ms = "));
+    g_report.print(ms > 0 ? (bytes * 1000) / ms : 0, DEC);
+    g_report.println(F(" B/s"));
+}
+
+// Many small ranged reads, each paying a request round trip
+void benchReads(const uint8_t handle, const uint8_t chunk) {
+    uint32_t total = 0;
+    uint16_t got;
+    unsigned long start = millis();
+    for(uint32_t off = 0; off < g_benchLen; off += chunk) {
+        if(g_resources.read(handle, off, g_buff, chunk, got)
+                != rsrc::Status::Ok) {
+            break;
+        }
+        total += got;
+    }
+    report(F("read chunk "), chunk, total, millis() - start);
+}
+
+// One flow controlled read of the whole thing
+void benchStream(const uint8_t handle, const uint8_t window) {
+    uint16_t got;
+    g_sunk = 0;
+    unsigned long start = millis();
+    g_resources.stream(handle, 0, g_benchLen, g_buff, window, sink, got);
+    report(F("stream window "), window, g_sunk, millis() - start);
+}
+
+void setup(void) {
+    Serial.begin(rsrc::g_bauds[0]);
+    g_report.begin(19200);
+    delay(100);
+
+    uint8_t handle;
+    if(g_resources.open(g_benchFile, handle) != rsrc::Status::Ok) {
+        g_report.println(F("Couldn't open BENCH.BIN"));
+        return;
+    }
+
+    for(int baud = 0; baud < rsrc::g_baudCount; baud++) {
+        if(g_resources.baud(baud) != rsrc::Status::Ok) {
+            g_report.println(F("Baud switch failed"));
+            break;
+        }
+        g_report.print(F("== "));
+        g_report.print(rsrc::g_bauds[baud], DEC);
+        g_report.println(F(" baud"));
+
+        benchReads(handle, 16);
+        benchReads(handle, 64);
+        benchStream(handle, 32);
+        benchStream(handle, 64);
+    }
+
+    uint32_t hits, misses;
+    if(g_resources.stats(hits, misses) == rsrc::Status::Ok) {
+        g_report.print(F("Read-ahead hits/misses: "));
+        g_report.print(hits, DEC);
+        g_report.print(F("/"));
+        g_report.println(misses, DEC);
+    }
+
+    g_resources.baud(0);
+    g_resources.close(handle);
+    g_report.println(F("Done."));
+}
+
+void loop(void) {
+}
@@ -0,0 +1,205 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - I2C addresses and packet layouts for the GPU's bus
+ * - The GPU is the bus master and polls its slaves, reading a whole packet
+ *   per transaction. A packet starting with g_linkIdle has nothing in it
+ *   + The logic MCU sends command batches: <len> <commands...>, len being
+ *     the bytes of commands that follow (see GpuCommand, big endian fields)
+ *   + The GPU writes events (see GpuEvent) back to the logic MCU between
+ *     polls
+ *   + The programmer sends bulk image data, so it skips the logic MCU:
+ *     <op> <slot hi> <slot lo> <offset> <len> <data...>
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace gpulink {
+    const uint8_t g_cpuI2cAddr = 0x7C;
+    const uint8_t g_pgrmrI2cAddr = 0x7D;
+    const uint8_t g_linkIdle = 0x55;
+
+    // Whole packets fit AVR Wire's 32 byte buffer
+    const int g_cmdPacketSize = 32;
+    const int g_cmdBatchMax = g_cmdPacketSize - 1;
+
+    enum class GpuCommand : uint8_t {
+        Background = 'B', // <color:2>
+        AddSprite = 'S', // <x:2> <y:2> <img:2>, ids count up from 0
+        MoveSprite = 'M', // <id:2> <x:2> <y:2>
+        SpriteImage = 'I', // <id:2> <img:2>, stopping its animation
+        ClearSprites = 'C', // Ids start over from 0
+        Image = 'U', // <slot:2> <offset> <len> <data...>, like a bulk packet
+
+        // 1bpp glyphs, expanded to an image slot by the GPU
+        GlyphColors = 'P', // <fg:2> <bg:2> for the glyphs after it
+        Glyph = 'G', // <slot:2> <row bytes:8>, top first, MSB on the left
+
+        // Animations the GPU steps through by itself, once per frame
+        DefineAnim = 'A', // <anim> <AnimMode> <count> (<img:2> <frames>)...
+        PlayAnim = 'N', // <id:2> <anim:2> from its first image, or g_animStop
+
+        // Motion the GPU applies by itself, once per frame. A move cancels a
+        // tween, but not a velocity
+        SetVelocity = 'V', // <id:2> <dx:2> <dy:2>, 1/256ths of a px a frame
+        TweenSprite = 'T', // <id:2> <x:2> <y:2> <Ease> <frames>, then TweenDone
+        SpriteEdge = 'E', // <id:2> <MotionEdge:2>, what a velocity does there
+        MotionBounds = 'O', // <left:2> <top:2> <right:2> <bottom:2>, all sprites
+
+        // Per scanline tables the GPU applies as it draws each line
+        RasterLines = 'R', // <RasterTable> <line:2> <count> (<value:2>)...
+        RasterFill = 'F', // <RasterTable:2> <line:2> <count:2> <value:2>
+
+        // A 2 or 4 bpp palette framebuffer between the background and the
+        // sprites, drawn into in its own coordinates
+        LayerSetup = 'L', // <bpp:2> <w:2> <h:2>, cleared to 0. bpp 0 is off
+        LayerPosition = 'J', // <x:2> <y:2> of its top left on screen
+        LayerPalette = 'Q', // <index:2> <color:2>, no alpha bit to see through
+        LayerPen = 'K', // <index:2> for the pixels, lines and rects after it
+        LayerPixel = 'X', // <x:2> <y:2>
+        LayerLine = 'W', // <x0:2> <y0:2> <x1:2> <y1:2>
+        LayerRect = 'Y', // <x:2> <y:2> <w:2> <h:2>, filled
+        LayerBlit = 'Z', // <x:2> <y:2> <w> <first:2> <n> <indices...> (below)
+
+        // Solid rects, filled a span at a time as each line is drawn. They
+        // take sprite ids, so they sit in the same z order and move, tween
+        // and scroll like sprites. Out of capitals, so lower case from here
+        AddRect = 'H', // <x:2> <y:2> <w:2> <h:2>, in the last ShapeStyle
+        ShapeStyle = 'y', // <color:2> <ShapeFill:2> for the rects after it
+        ResizeRect = 'z', // <id:2> <w:2> <h:2>
+        RectColor = 'r', // <id:2> <color:2>
+
+        // Restarts the GPU into another VideoMode, so everything sent before
+        // it is gone. Does nothing if it's already in that mode
+        SetVideoMode = 'v', // <VideoMode:2>
+
+        // Image slots outlive the logic MCU's program, so a new one can ask
+        // for an image by its imageHash() before uploading it. If any slot
+        // holds it, it's copied into slot. Answered with ImageFound or
+        // ImageMissing, the second meaning it has to be uploaded after all
+        FindImage = 'h', // <slot:2> <hash:4>
+
+        // Puts count images of the GPU's asset ROM in RAM slots from slot
+        // on, where they draw without going through the flash cache
+        CopyRomImages = 'c', // <slot:2> <rom image:2> <count:2>
+
+        // An affine ("Mode 7") background in place of the flat one: a map of
+        // image slots the GPU turns, scales and tilts as it draws each line.
+        // Screen point x, y shows texture point u, v, and one px right or
+        // down on screen moves <pa, pc> or <pb, pd> in the texture (8.8).
+        // The AffineScale and AffineRow raster tables change that per line
+        AffineSetup = 'a', // <w:2> <h:2> <AffineEdge:2> in tiles, all slot 0
+        AffineTiles = 't', // <cell:2> <count> <slot>..., row by row
+        AffineFill = 'f', // <cell:2> <count:2> <slot:2>
+        AffineMatrix = 'x', // <pa:2> <pb:2> <pc:2> <pd:2>
+        AffineOrigin = 'o' // <u:2> <v:2> (1/16ths of a texture px) <x:2> <y:2>
+    };
+    const int g_glyphSize = 8;
+
+    // An image id with this bit set (wherever one goes) is that image of the
+    // asset ROM built into the GPU firmware (MigsSdk's GpuRom.hpp has their
+    // ids), drawn straight from flash instead of from a slot
+    const uint16_t g_romImage = 0x8000;
+
+    enum class AnimMode : uint8_t {
+        Once = 0, // Stays on the last image
+        Loop = 1,
+        PingPong = 2 // Forward, then back, and so on
+    };
+    const int g_maxAnims = 32;
+    const int g_animMaxSteps = 8;
+    const uint16_t g_animStop = 0xFFFF; // Keeps whatever image it's on
+
+    struct AnimStep {
+        uint16_t img;
+        uint8_t frames; // How long it's shown
+    };
+
+    enum class Ease : uint8_t {
+        Linear = 0,
+        In = 1, // Starts slow (quadratic)
+        Out = 2, // Ends slow
+        InOut = 3 // Both (smoothstep)
+    };
+
+    // What a sprite with a velocity does at the motion bounds, which start
+    // out as the screen
+    enum class MotionEdge : uint8_t {
+        None = 0, // Keeps going
+        Wrap = 1, // Its corner leaves one side and comes back in the other
+        Bounce = 2, // Velocity flips to keep the whole sprite inside
+        Stop = 3 // Velocity goes to 0 to keep the whole sprite inside
+    };
+
+    // Blits are pixels first to first + n - 1 of a w wide block, row by row,
+    // as 4 bit palette indices two a byte, high nibble first
+    const int g_blitHeaderSize = 9; // Op included
+
+    enum class RasterTable : uint8_t {
+        Background = 0, // Color of each line, until the next Background
+        SpriteScroll = 1, // px each line's sprites are drawn further left
+        LayerScroll = 2, // px each line of the layer is shifted left, wrapping
+
+        // Until the next AffineSetup, once written. A perspective floor is a
+        // scale of height / (line - horizon) and a fixed row of -distance
+        AffineScale = 3, // The matrix times this on each line (8.8), 0 = off
+        AffineRow = 4 // y the matrix is given instead of line - origin y
+    };
+    const int g_rasterTables = 5;
+    const int g_rasterLines = 300; // A line each, in the tallest mode
+
+    // Maps are powers of two from 2 to 128 tiles a side, up to 64x64 tiles.
+    // Only RAM slots can be tiles
+    enum class AffineEdge : uint8_t {
+        Wrap = 0, // The map repeats forever
+        Clear = 1 // Outside it, the background shows
+    };
+    const int g_affineMaxSide = 128;
+    const int g_affineMaxCells = 64 * 64;
+    const int16_t g_affineUnit = 256; // 1.0, in the matrix and scales
+
+    enum class ShapeFill : uint8_t {
+        Filled = 0,
+        Outline = 1 // 1 px border
+    };
+
+    // Internal resolutions, each half its DVI mode's width and height. Fewer
+    // pixels a line leave more time for each one (more sprites a line)
+    enum class VideoMode : uint8_t {
+        Mode480x270 = 0, // 960x540p60, the default
+        Mode320x240 = 1, // 640x480p60
+        Mode400x240 = 2, // 800x480p60
+        Mode400x300 = 3 // 800x600p60
+    };
+    const int g_videoModes = 4;
+    const uint16_t g_modeWidths[g_videoModes] = { 480, 320, 400, 400 };
+    const uint16_t g_modeHeights[g_videoModes] = { 270, 240, 240, 300 };
+
+    // 32 bit FNV-1a over an image slot's g_imageSize bytes, as they sit in
+    // the GPU (so a glyph is hashed as the image it expands to)
+    const uint32_t g_hashStart = 2166136261UL;
+
+    inline uint32_t hashByte(const uint32_t hash, const uint8_t b) {
+        return (hash ^ b) * 16777619UL;
+    }
+
+    // The GPU writes these back to the logic MCU (I2C master write)
+    enum class GpuEvent : uint8_t {
+        TweenDone = 'T', // <id:2>, the sprite reached its tween's target
+        ImageFound = 'F', // <slot:2>, it holds the image FindImage asked for
+        ImageMissing = 'M' // <slot:2>, left as it was
+    };
+    const int g_eventSize = 3;
+
+    const uint8_t g_bulkImage = 'D'; // len bytes at offset of image slot
+    static_assert(
+        g_bulkImage != g_linkIdle,
+        "The bulk image op is the idle byte, so the GPU would drop it"
+    );
+    const int g_bulkHeaderSize = 5;
+    const int g_bulkDataSize = 24;
+    const int g_bulkPacketSize = g_bulkHeaderSize + g_bulkDataSize;
+    const int g_imageSize = 8 * 8 * 2; // One 8x8 RGAB5515 image
+}
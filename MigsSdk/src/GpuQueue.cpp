@@ -0,0 +1,830 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the batching GPU command queue
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "GpuLink.hpp"
+#include "GpuQueue.hpp"
+
+using namespace gfx;
+using gpulink::GpuCommand;
+
+// Wire's request handler has no context, so it goes through this
+GpuQueue *g_activeQueue = nullptr;
+uint8_t g_packet[gpulink::g_cmdPacketSize];
+
+GpuQueue::GpuQueue(void) :
+        _head(0), _count(0), _spriteCount(0), _doneHead(0), _doneCount(0),
+        _resultHead(0), _resultCount(0) {
+}
+
+void GpuQueue::begin(void) {
+    g_activeQueue = this;
+    Wire.begin(gpulink::g_cpuI2cAddr);
+    Wire.onRequest(_onRequest);
+    Wire.onReceive(_onReceive);
+}
+
+bool GpuQueue::setBackground(const uint16_t color) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending( // Table 0 is the background's
+        GpuCommand::Background, false, 0, GpuCommand::RasterLines
+    );
+    if(pending) {
+        pending->args[0] = color;
+    }
+    interrupts();
+    return pending || _push({ GpuCommand::Background, false, { color } });
+}
+
+bool GpuQueue::addSprite(
+        const int16_t x, const int16_t y, const uint16_t img,
+        uint16_t &ref_id) {
+    if(!_push({
+            GpuCommand::AddSprite, false,
+            {
+                static_cast<uint16_t>(x), static_cast<uint16_t>(y), img
+            }
+        })) {
+        return false;
+    }
+    ref_id = _spriteCount++;
+    return true;
+}
+
+bool GpuQueue::moveSprite(
+        const uint16_t id, const int16_t x, const int16_t y) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(
+        GpuCommand::MoveSprite, true, id, GpuCommand::TweenSprite
+    );
+    if(pending) {
+        pending->args[1] = x;
+        pending->args[2] = y;
+    }
+    interrupts();
+    return pending || _push({
+        GpuCommand::MoveSprite, false,
+        { id, static_cast<uint16_t>(x), static_cast<uint16_t>(y) }
+    });
+}
+
+bool GpuQueue::setSpriteImage(const uint16_t id, const uint16_t img) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(
+        GpuCommand::SpriteImage, true, id, GpuCommand::PlayAnim
+    );
+    if(pending) {
+        pending->args[1] = img;
+    }
+    interrupts();
+    return pending || _push({ GpuCommand::SpriteImage, false, { id, img } });
+}
+
+bool GpuQueue::clearSprites(void) {
+    if(!_push({ GpuCommand::ClearSprites })) {
+        return false;
+    }
+    _spriteCount = 0;
+    return true;
+}
+
+bool GpuQueue::setShapeStyle(
+        const uint16_t color, const gpulink::ShapeFill fill) {
+    return _push({
+        GpuCommand::ShapeStyle, false, { color, static_cast<uint16_t>(fill) }
+    });
+}
+
+bool GpuQueue::addRect(
+        const int16_t x, const int16_t y, const uint16_t w, const uint16_t h,
+        uint16_t &ref_id) {
+    if(!_push({
+            GpuCommand::AddRect, false,
+            { static_cast<uint16_t>(x), static_cast<uint16_t>(y), w, h }
+        })) {
+        return false;
+    }
+    ref_id = _spriteCount++;
+    return true;
+}
+
+bool GpuQueue::addHLine(
+        const int16_t x, const int16_t y, const uint16_t len,
+        uint16_t &ref_id) {
+    return addRect(x, y, len, 1, ref_id);
+}
+
+bool GpuQueue::addVLine(
+        const int16_t x, const int16_t y, const uint16_t len,
+        uint16_t &ref_id) {
+    return addRect(x, y, 1, len, ref_id);
+}
+
+bool GpuQueue::resizeRect(
+        const uint16_t id, const uint16_t w, const uint16_t h) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::ResizeRect, true, id);
+    if(pending) {
+        pending->args[1] = w;
+        pending->args[2] = h;
+    }
+    interrupts();
+    return pending || _push({ GpuCommand::ResizeRect, false, { id, w, h } });
+}
+
+bool GpuQueue::setRectColor(const uint16_t id, const uint16_t color) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::RectColor, true, id);
+    if(pending) {
+        pending->args[1] = color;
+    }
+    interrupts();
+    return pending || _push({ GpuCommand::RectColor, false, { id, color } });
+}
+
+bool GpuQueue::uploadImage(
+        const uint16_t slot, const uint8_t *data, const bool progmem,
+        const uint8_t len) {
+    return _push({ GpuCommand::Image, progmem, { slot, len }, data, 0 });
+}
+
+bool GpuQueue::findImage(const uint16_t slot, const uint32_t hash) {
+    return _push({
+        GpuCommand::FindImage, false,
+        {
+            slot, static_cast<uint16_t>(hash >> 16),
+            static_cast<uint16_t>(hash & 0xFFFF)
+        }
+    });
+}
+
+bool GpuQueue::imageResult(ImageResult &ref_result) {
+    noInterrupts();
+    bool any = _resultCount > 0;
+    if(any) {
+        ref_result = _imageResults[_resultHead];
+        _resultHead = (_resultHead + 1) % g_imageResultsSize;
+        _resultCount--;
+    }
+    interrupts();
+    return any;
+}
+
+uint32_t GpuQueue::imageHash(const uint8_t *data, const bool progmem) {
+    uint32_t hash = gpulink::g_hashStart;
+    for(int i = 0; i < gpulink::g_imageSize; i++) {
+        hash = gpulink::hashByte(
+            hash, progmem ? pgm_read_byte(&data[i]) : data[i]
+        );
+    }
+    return hash;
+}
+
+// Pixels are little endian in the GPU's slots
+uint32_t GpuQueue::glyphHash(
+        const uint8_t *rows, const uint16_t fg, const uint16_t bg,
+        const bool progmem) {
+    uint32_t hash = gpulink::g_hashStart;
+    for(int y = 0; y < gpulink::g_glyphSize; y++) {
+        uint8_t row = progmem ? pgm_read_byte(&rows[y]) : rows[y];
+        for(int x = 0; x < 8; x++) {
+            uint16_t color = (row & (0x80 >> x)) ? fg : bg;
+            hash = gpulink::hashByte(hash, color & 0xFF);
+            hash = gpulink::hashByte(hash, color >> 8);
+        }
+    }
+    return hash;
+}
+
+bool GpuQueue::copyRomImages(
+        const uint16_t slot, const uint16_t romImage, const uint16_t count) {
+    return _push({
+        GpuCommand::CopyRomImages, false, { slot, romImage, count }
+    });
+}
+
+bool GpuQueue::setGlyphColors(const uint16_t fg, const uint16_t bg) {
+    return _push({ GpuCommand::GlyphColors, false, { fg, bg } });
+}
+
+bool GpuQueue::uploadGlyph(
+        const uint16_t slot, const uint8_t *rows, const bool progmem) {
+    return _push({ GpuCommand::Glyph, progmem, { slot }, rows, 0 });
+}
+
+bool GpuQueue::defineAnim(
+        const uint8_t anim, const gpulink::AnimMode mode,
+        const gpulink::AnimStep *steps, const uint8_t count,
+        const bool progmem) {
+    if((count == 0) || (count > gpulink::g_animMaxSteps)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::DefineAnim, progmem,
+        { anim, static_cast<uint16_t>(mode), count },
+        reinterpret_cast<const uint8_t *>(steps), 0
+    });
+}
+
+bool GpuQueue::playAnim(const uint16_t id, const uint16_t anim) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(
+        GpuCommand::PlayAnim, true, id, GpuCommand::SpriteImage
+    );
+    if(pending) {
+        pending->args[1] = anim;
+    }
+    interrupts();
+    return pending || _push({ GpuCommand::PlayAnim, false, { id, anim } });
+}
+
+bool GpuQueue::setVelocity(
+        const uint16_t id, const int16_t dx, const int16_t dy) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::SetVelocity, true, id);
+    if(pending) {
+        pending->args[1] = dx;
+        pending->args[2] = dy;
+    }
+    interrupts();
+    return pending || _push({
+        GpuCommand::SetVelocity, false,
+        { id, static_cast<uint16_t>(dx), static_cast<uint16_t>(dy) }
+    });
+}
+
+// Never merged, so every tween gets its TweenDone
+bool GpuQueue::tweenSprite(
+        const uint16_t id, const int16_t x, const int16_t y,
+        const uint8_t frames, const gpulink::Ease ease) {
+    return _push({
+        GpuCommand::TweenSprite, false,
+        {
+            id, static_cast<uint16_t>(x), static_cast<uint16_t>(y),
+            static_cast<uint16_t>((static_cast<uint8_t>(ease) << 8) | frames)
+        }
+    });
+}
+
+bool GpuQueue::setSpriteEdge(
+        const uint16_t id, const gpulink::MotionEdge edge) {
+    return _push({
+        GpuCommand::SpriteEdge, false, { id, static_cast<uint16_t>(edge) }
+    });
+}
+
+bool GpuQueue::setMotionBounds(
+        const int16_t left, const int16_t top,
+        const int16_t right, const int16_t bottom) {
+    return _push({
+        GpuCommand::MotionBounds, false,
+        {
+            static_cast<uint16_t>(left), static_cast<uint16_t>(top),
+            static_cast<uint16_t>(right), static_cast<uint16_t>(bottom)
+        }
+    });
+}
+
+bool GpuQueue::setRasterLines(
+        const gpulink::RasterTable table, const uint16_t first,
+        const uint16_t *values, const uint16_t count, const bool progmem) {
+    if((count == 0) || (first + count > gpulink::g_rasterLines)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::RasterLines, progmem,
+        { static_cast<uint16_t>(table), first, count },
+        reinterpret_cast<const uint8_t *>(values), 0
+    });
+}
+
+bool GpuQueue::fillRasterLines(
+        const gpulink::RasterTable table, const uint16_t first,
+        const uint16_t count, const uint16_t value) {
+    if((count == 0) || (first + count > gpulink::g_rasterLines)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::RasterLines, false,
+        { static_cast<uint16_t>(table), first, count, value }, nullptr
+    });
+}
+
+bool GpuQueue::setupLayer(
+        const uint8_t bpp, const uint16_t w, const uint16_t h) {
+    return _push({ GpuCommand::LayerSetup, false, { bpp, w, h } });
+}
+
+bool GpuQueue::setLayerPosition(const int16_t x, const int16_t y) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::LayerPosition, false, 0);
+    if(pending) {
+        pending->args[0] = x;
+        pending->args[1] = y;
+    }
+    interrupts();
+    return pending || _push({
+        GpuCommand::LayerPosition, false,
+        { static_cast<uint16_t>(x), static_cast<uint16_t>(y) }
+    });
+}
+
+bool GpuQueue::setupAffine(
+        const uint16_t w, const uint16_t h, const gpulink::AffineEdge edge) {
+    return _push({
+        GpuCommand::AffineSetup, false,
+        { w, h, static_cast<uint16_t>(edge) }
+    });
+}
+
+bool GpuQueue::setAffineTiles(
+        const uint16_t first, const uint8_t *slots, const uint16_t count,
+        const bool progmem) {
+    if((count == 0) || (first + count > gpulink::g_affineMaxCells)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::AffineTiles, progmem, { first, count }, slots, 0
+    });
+}
+
+bool GpuQueue::fillAffineTiles(
+        const uint16_t first, const uint16_t count, const uint8_t slot) {
+    if((count == 0) || (first + count > gpulink::g_affineMaxCells)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::AffineTiles, false, { first, count, slot }, nullptr
+    });
+}
+
+bool GpuQueue::setAffineMatrix(
+        const int16_t pa, const int16_t pb,
+        const int16_t pc, const int16_t pd) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::AffineMatrix, false, 0);
+    if(pending) {
+        pending->args[0] = pa;
+        pending->args[1] = pb;
+        pending->args[2] = pc;
+        pending->args[3] = pd;
+    }
+    interrupts();
+    return pending || _push({
+        GpuCommand::AffineMatrix, false,
+        {
+            static_cast<uint16_t>(pa), static_cast<uint16_t>(pb),
+            static_cast<uint16_t>(pc), static_cast<uint16_t>(pd)
+        }
+    });
+}
+
+bool GpuQueue::setAffineOrigin(
+        const int16_t u, const int16_t v,
+        const int16_t x, const int16_t y) {
+    noInterrupts();
+    QueuedCommand *pending = _findPending(GpuCommand::AffineOrigin, false, 0);
+    if(pending) {
+        pending->args[0] = u;
+        pending->args[1] = v;
+        pending->args[2] = x;
+        pending->args[3] = y;
+    }
+    interrupts();
+    return pending || _push({
+        GpuCommand::AffineOrigin, false,
+        {
+            static_cast<uint16_t>(u), static_cast<uint16_t>(v),
+            static_cast<uint16_t>(x), static_cast<uint16_t>(y)
+        }
+    });
+}
+
+bool GpuQueue::setLayerPalette(const uint8_t index, const uint16_t color) {
+    return _push({ GpuCommand::LayerPalette, false, { index, color } });
+}
+
+bool GpuQueue::setLayerPen(const uint8_t index) {
+    return _push({ GpuCommand::LayerPen, false, { index } });
+}
+
+bool GpuQueue::layerPixel(const int16_t x, const int16_t y) {
+    return _push({
+        GpuCommand::LayerPixel, false,
+        { static_cast<uint16_t>(x), static_cast<uint16_t>(y) }
+    });
+}
+
+bool GpuQueue::layerLine(
+        const int16_t x0, const int16_t y0,
+        const int16_t x1, const int16_t y1) {
+    return _push({
+        GpuCommand::LayerLine, false,
+        {
+            static_cast<uint16_t>(x0), static_cast<uint16_t>(y0),
+            static_cast<uint16_t>(x1), static_cast<uint16_t>(y1)
+        }
+    });
+}
+
+bool GpuQueue::layerRect(
+        const int16_t x, const int16_t y,
+        const uint16_t w, const uint16_t h) {
+    return _push({
+        GpuCommand::LayerRect, false,
+        { static_cast<uint16_t>(x), static_cast<uint16_t>(y), w, h }
+    });
+}
+
+bool GpuQueue::layerBlit(
+        const int16_t x, const int16_t y, const uint8_t w, const uint8_t h,
+        const uint8_t *indices, const bool progmem) {
+    if((w == 0) || (h == 0)) {
+        return false;
+    }
+    return _push({
+        GpuCommand::LayerBlit, progmem,
+        { static_cast<uint16_t>(x), static_cast<uint16_t>(y), w, h },
+        indices, 0
+    });
+}
+
+bool GpuQueue::setVideoMode(const gpulink::VideoMode mode) {
+    return _push({
+        GpuCommand::SetVideoMode, false, { static_cast<uint16_t>(mode) }
+    });
+}
+
+bool GpuQueue::tweenDone(uint16_t &ref_id) {
+    noInterrupts();
+    bool any = _doneCount > 0;
+    if(any) {
+        ref_id = _tweensDone[_doneHead];
+        _doneHead = (_doneHead + 1) % g_tweensDoneSize;
+        _doneCount--;
+    }
+    interrupts();
+    return any;
+}
+
+bool GpuQueue::idle(void) const {
+    return _count == 0;
+}
+
+int GpuQueue::room(void) const {
+    return g_queueSize - _count;
+}
+
+bool GpuQueue::_push(const QueuedCommand &cmd) {
+    noInterrupts();
+    bool fits = _count < g_queueSize;
+    if(fits) {
+        _ring[(_head + _count) % g_queueSize] = cmd;
+        _count++;
+    }
+    interrupts();
+    return fits;
+}
+
+// Newest first, but never past a clear, since ids mean something else then,
+// or past a barrier command for the same id that has to stay after it
+QueuedCommand *GpuQueue::_findPending(
+        const GpuCommand cmd, const bool matchId, const uint16_t id,
+        const GpuCommand barrier) {
+    for(int i = _count - 1; i >= 0; i--) {
+        QueuedCommand &queued = _ring[(_head + i) % g_queueSize];
+        if(queued.cmd == GpuCommand::ClearSprites) {
+            return nullptr;
+        }
+        if((queued.cmd == barrier) && (queued.args[0] == id)) {
+            return nullptr;
+        }
+        if((queued.cmd == cmd) && (!matchId || (queued.args[0] == id))) {
+            return &queued;
+        }
+    }
+    return nullptr;
+}
+
+// As many commands as fit, oldest first. Called with interrupts off
+int GpuQueue::_fillBatch(uint8_t *batch) {
+    int len = 0;
+    while(_count > 0) {
+        QueuedCommand &cmd = _ring[_head];
+        int used = _encode(cmd, &batch[len], gpulink::g_cmdBatchMax - len);
+        if(used == 0) {
+            break;
+        }
+        len += used;
+
+        // Uploads stay at the front until their last piece is out
+        if((cmd.cmd == GpuCommand::Image) && (cmd.sent < cmd.args[1])) {
+            break;
+        }
+        if((cmd.cmd == GpuCommand::RasterLines) && (cmd.args[2] > 0)) {
+            break;
+        }
+        if((cmd.cmd == GpuCommand::AffineTiles) && (cmd.args[1] > 0)) {
+            break;
+        }
+        if(
+                (cmd.cmd == GpuCommand::LayerBlit)
+                && (cmd.sent < cmd.args[2] * cmd.args[3])) {
+            break;
+        }
+        _head = (_head + 1) % g_queueSize;
+        _count--;
+
+        // The GPU restarts on it, so nothing after it would be seen
+        if(cmd.cmd == GpuCommand::SetVideoMode) {
+            break;
+        }
+    }
+    return len;
+}
+
+// Returns bytes written, or 0 if it doesn't fit in room
+int GpuQueue::_encode(QueuedCommand &cmd, uint8_t *out, const int room) {
+    int argCount = 0;
+    switch(cmd.cmd) {
+        case GpuCommand::Background:
+        case GpuCommand::LayerPen:
+        case GpuCommand::SetVideoMode:
+            argCount = 1;
+            break;
+        case GpuCommand::AddSprite:
+        case GpuCommand::MoveSprite:
+        case GpuCommand::SetVelocity:
+        case GpuCommand::LayerSetup:
+        case GpuCommand::ResizeRect:
+        case GpuCommand::FindImage: // Hash split over the last two
+        case GpuCommand::CopyRomImages:
+        case GpuCommand::AffineSetup:
+            argCount = 3;
+            break;
+        case GpuCommand::SpriteImage:
+        case GpuCommand::GlyphColors:
+        case GpuCommand::PlayAnim:
+        case GpuCommand::SpriteEdge:
+        case GpuCommand::LayerPosition:
+        case GpuCommand::LayerPalette:
+        case GpuCommand::LayerPixel:
+        case GpuCommand::ShapeStyle:
+        case GpuCommand::RectColor:
+            argCount = 2;
+            break;
+        case GpuCommand::TweenSprite: // Ease and frames share the last
+        case GpuCommand::MotionBounds:
+        case GpuCommand::RasterFill:
+        case GpuCommand::LayerLine:
+        case GpuCommand::LayerRect:
+        case GpuCommand::AddRect:
+        case GpuCommand::AffineMatrix:
+        case GpuCommand::AffineOrigin:
+            argCount = 4;
+            break;
+        case GpuCommand::ClearSprites:
+        case GpuCommand::AffineFill: // Only ever sent for an AffineTiles
+            break;
+
+        // <slot:2> <offset> <len> <data...>, as much data as fits
+        case GpuCommand::Image: {
+            int n = min(cmd.args[1] - cmd.sent, room - 5);
+            if(n <= 0) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = (cmd.args[0] >> 8) & 0xFF;
+            out[2] = cmd.args[0] & 0xFF;
+            out[3] = cmd.sent;
+            out[4] = n;
+            if(cmd.progmem) {
+                memcpy_P(&out[5], cmd.data + cmd.sent, n);
+            } else {
+                memcpy(&out[5], cmd.data + cmd.sent, n);
+            }
+            cmd.sent += n;
+            return 5 + n;
+        }
+
+        // <table> <line:2> <count> <values...>, as many lines as fit. The
+        // command itself keeps track of what's left. Without data, it's a
+        // fill of args[3], sent as a RasterFill
+        case GpuCommand::RasterLines: {
+            if(!cmd.data) {
+                if(9 > room) {
+                    return 0;
+                }
+                out[0] = static_cast<uint8_t>(GpuCommand::RasterFill);
+                for(int i = 0; i < 4; i++) {
+                    out[1 + i * 2] = (cmd.args[i] >> 8) & 0xFF;
+                    out[2 + i * 2] = cmd.args[i] & 0xFF;
+                }
+                cmd.args[2] = 0;
+                return 9;
+            }
+            int n = min(cmd.args[2], (room - 5) / 2);
+            if(n <= 0) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = cmd.args[0];
+            out[2] = (cmd.args[1] >> 8) & 0xFF;
+            out[3] = cmd.args[1] & 0xFF;
+            out[4] = n;
+            const uint16_t *values =
+                reinterpret_cast<const uint16_t *>(cmd.data);
+            for(int i = 0; i < n; i++) {
+                uint16_t value = cmd.progmem
+                    ? pgm_read_word(&values[i]) : values[i];
+                out[5 + i * 2] = (value >> 8) & 0xFF;
+                out[6 + i * 2] = value & 0xFF;
+            }
+            cmd.data += n * 2;
+            cmd.args[1] += n;
+            cmd.args[2] -= n;
+            return 5 + n * 2;
+        }
+
+        // <cell:2> <count> <slots...>, as many cells as fit. Like
+        // RasterLines, what's left is kept in the command, and without
+        // data it's a fill of args[2], sent as an AffineFill
+        case GpuCommand::AffineTiles: {
+            if(!cmd.data) {
+                if(7 > room) {
+                    return 0;
+                }
+                out[0] = static_cast<uint8_t>(GpuCommand::AffineFill);
+                for(int i = 0; i < 3; i++) {
+                    out[1 + i * 2] = (cmd.args[i] >> 8) & 0xFF;
+                    out[2 + i * 2] = cmd.args[i] & 0xFF;
+                }
+                cmd.args[1] = 0;
+                return 7;
+            }
+            int n = min(min(cmd.args[1], 255), room - 4);
+            if(n <= 0) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = (cmd.args[0] >> 8) & 0xFF;
+            out[2] = cmd.args[0] & 0xFF;
+            out[3] = n;
+            if(cmd.progmem) {
+                memcpy_P(&out[4], cmd.data, n);
+            } else {
+                memcpy(&out[4], cmd.data, n);
+            }
+            cmd.data += n;
+            cmd.args[0] += n;
+            cmd.args[1] -= n;
+            return 4 + n;
+        }
+
+        // <x:2> <y:2> <w> <first:2> <n> <indices...>, as many pixels as
+        // fit. Pieces start on a whole byte, so n is even but for the last
+        case GpuCommand::LayerBlit: {
+            int total = cmd.args[2] * cmd.args[3];
+            int n = min(
+                total - cmd.sent, (room - gpulink::g_blitHeaderSize) * 2
+            );
+            if(n <= 0) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = (cmd.args[0] >> 8) & 0xFF;
+            out[2] = cmd.args[0] & 0xFF;
+            out[3] = (cmd.args[1] >> 8) & 0xFF;
+            out[4] = cmd.args[1] & 0xFF;
+            out[5] = cmd.args[2];
+            out[6] = (cmd.sent >> 8) & 0xFF;
+            out[7] = cmd.sent & 0xFF;
+            out[8] = n;
+            int bytes = (n + 1) / 2;
+            const uint8_t *src = cmd.data + cmd.sent / 2;
+            if(cmd.progmem) {
+                memcpy_P(&out[gpulink::g_blitHeaderSize], src, bytes);
+            } else {
+                memcpy(&out[gpulink::g_blitHeaderSize], src, bytes);
+            }
+            cmd.sent += n;
+            return gpulink::g_blitHeaderSize + bytes;
+        }
+
+        // <slot:2> <rows...>, never split
+        case GpuCommand::Glyph:
+            if(3 + gpulink::g_glyphSize > room) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = (cmd.args[0] >> 8) & 0xFF;
+            out[2] = cmd.args[0] & 0xFF;
+            if(cmd.progmem) {
+                memcpy_P(&out[3], cmd.data, gpulink::g_glyphSize);
+            } else {
+                memcpy(&out[3], cmd.data, gpulink::g_glyphSize);
+            }
+            return 3 + gpulink::g_glyphSize;
+
+        // <anim> <mode> <count> (<img:2> <frames>)..., never split
+        case GpuCommand::DefineAnim: {
+            int count = cmd.args[2];
+            if(4 + count * 3 > room) {
+                return 0;
+            }
+            out[0] = static_cast<uint8_t>(cmd.cmd);
+            out[1] = cmd.args[0];
+            out[2] = cmd.args[1];
+            out[3] = count;
+            const gpulink::AnimStep *steps =
+                reinterpret_cast<const gpulink::AnimStep *>(cmd.data);
+            for(int i = 0; i < count; i++) {
+                gpulink::AnimStep step;
+                if(cmd.progmem) {
+                    memcpy_P(&step, &steps[i], sizeof(step));
+                } else {
+                    step = steps[i];
+                }
+                out[4 + i * 3] = (step.img >> 8) & 0xFF;
+                out[5 + i * 3] = step.img & 0xFF;
+                out[6 + i * 3] = step.frames;
+            }
+            return 4 + count * 3;
+        }
+    }
+
+    if(1 + argCount * 2 > room) {
+        return 0;
+    }
+    out[0] = static_cast<uint8_t>(cmd.cmd);
+    for(int i = 0; i < argCount; i++) {
+        out[1 + i * 2] = (cmd.args[i] >> 8) & 0xFF;
+        out[2 + i * 2] = cmd.args[i] & 0xFF;
+    }
+    return 1 + argCount * 2;
+}
+
+// Runs in Wire's interrupt, so interrupts are already off
+void GpuQueue::_onRequest(void) {
+    int len = g_activeQueue ? g_activeQueue->_fillBatch(&g_packet[1]) : 0;
+    if(len == 0) {
+        Wire.write(gpulink::g_linkIdle);
+        return;
+    }
+    g_packet[0] = len;
+    Wire.write(g_packet, 1 + len);
+}
+
+// An event the GPU wrote (see GpuEvent). Also in Wire's interrupt
+void GpuQueue::_onReceive(int len) {
+    uint8_t event[gpulink::g_eventSize];
+    int got = 0;
+    while(Wire.available()) {
+        int b = Wire.read();
+        if(got < gpulink::g_eventSize) {
+            event[got++] = b;
+        }
+    }
+    if(!g_activeQueue || (got < gpulink::g_eventSize)) {
+        return;
+    }
+
+    // When full, the oldest goes
+    GpuQueue &queue = *g_activeQueue;
+    uint16_t id = (static_cast<uint16_t>(event[1]) << 8) | event[2];
+    switch(static_cast<gpulink::GpuEvent>(event[0])) {
+        case gpulink::GpuEvent::TweenDone:
+            if(queue._doneCount == g_tweensDoneSize) {
+                queue._doneHead = (queue._doneHead + 1) % g_tweensDoneSize;
+                queue._doneCount--;
+            }
+            queue._tweensDone[
+                (queue._doneHead + queue._doneCount) % g_tweensDoneSize
+            ] = id;
+            queue._doneCount++;
+            break;
+
+        case gpulink::GpuEvent::ImageFound:
+        case gpulink::GpuEvent::ImageMissing:
+            if(queue._resultCount == g_imageResultsSize) {
+                queue._resultHead =
+                    (queue._resultHead + 1) % g_imageResultsSize;
+                queue._resultCount--;
+            }
+            queue._imageResults[
+                (queue._resultHead + queue._resultCount) % g_imageResultsSize
+            ] = ImageResult {
+                id, event[0] == static_cast<uint8_t>(
+                    gpulink::GpuEvent::ImageFound
+                )
+            };
+            queue._resultCount++;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,242 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Logic MCU side of the GPU command link (see GpuLink.hpp)
+ * - Drawing calls queue up in a fixed ring and return right away. Every time
+ *   the GPU polls, as many queued commands as fit go out in one packet
+ * - Redundant updates are merged while they wait: moving a sprite twice
+ *   before the GPU polls sends one move, and the same goes for a sprite's
+ *   image, velocity, a rect's size and color, the background and the
+ *   affine layer's matrix and origin
+ * - Image and glyph uploads, animation steps, raster tables, layer blits and
+ *   affine tiles are sent from the caller's buffer (RAM or PROGMEM), which
+ *   must stay put until idle() says the queue is empty
+ * - Calls return false when the ring is full; try again after a poll
+ * - The GPU writes back when a tween finishes, see tweenDone(), and with
+ *   what it found for findImage(), see imageResult()
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "GpuLink.hpp"
+
+namespace gfx {
+    const int g_queueSize = 16;
+    const int g_tweensDoneSize = 8;
+    const int g_imageResultsSize = 8;
+
+    struct QueuedCommand {
+        gpulink::GpuCommand cmd;
+        bool progmem; // For uploads, where data lives
+        uint16_t args[4]; // Fields, in the order they're sent
+        const uint8_t *data; // For uploads
+        uint16_t sent; // For image uploads and blits, how much is out
+    };
+
+    struct ImageResult {
+        uint16_t slot;
+        bool found; // Else it still has to be uploaded
+    };
+
+    class GpuQueue {
+        public:
+            GpuQueue(void);
+            void begin(void); // Join the GPU's bus as its logic MCU
+
+            bool setBackground(const uint16_t color);
+            bool addSprite( // Ids count up from 0 until clearSprites()
+                const int16_t x, const int16_t y, const uint16_t img,
+                uint16_t &ref_id
+            );
+            bool moveSprite(const uint16_t id, const int16_t x, const int16_t y);
+            bool setSpriteImage(const uint16_t id, const uint16_t img);
+            bool clearSprites(void);
+
+            // Rects and lines for UI (bars, panels, borders) at a few bytes
+            // each. They count in the same ids as sprites, and are drawn in
+            // the ShapeStyle queued before them. A rect is at least 1 px
+            // wide, but can be 0 high to hide it
+            bool setShapeStyle(
+                const uint16_t color,
+                const gpulink::ShapeFill fill = gpulink::ShapeFill::Filled
+            );
+            bool addRect(
+                const int16_t x, const int16_t y,
+                const uint16_t w, const uint16_t h, uint16_t &ref_id
+            );
+            bool addHLine(
+                const int16_t x, const int16_t y, const uint16_t len,
+                uint16_t &ref_id
+            );
+            bool addVLine(
+                const int16_t x, const int16_t y, const uint16_t len,
+                uint16_t &ref_id
+            );
+            bool resizeRect(
+                const uint16_t id, const uint16_t w, const uint16_t h
+            );
+            bool setRectColor(const uint16_t id, const uint16_t color);
+            bool uploadImage(
+                const uint16_t slot, const uint8_t *data,
+                const bool progmem = false,
+                const uint8_t len = gpulink::g_imageSize
+            );
+
+            // Image slots keep what's in them from one program to the next,
+            // so before uploading, ask whether the GPU already has the image
+            // somewhere and have it copied to slot. The answer comes back
+            // through imageResult(). Hashes are gpulink's imageHash()
+            bool findImage(const uint16_t slot, const uint32_t hash);
+            bool imageResult(ImageResult &ref_result); // Oldest, last 8 kept
+            static uint32_t imageHash(
+                const uint8_t *data, const bool progmem = false
+            );
+            static uint32_t glyphHash( // Of the image the GPU expands it to
+                const uint8_t *rows, const uint16_t fg, const uint16_t bg,
+                const bool progmem = false
+            );
+
+            // The GPU's own asset ROM (GpuRom.hpp's ids work wherever an
+            // image does) costs no upload. Copying images of it to slots
+            // is for ones drawn many times a line
+            bool copyRomImages(
+                const uint16_t slot, const uint16_t romImage,
+                const uint16_t count = 1
+            );
+
+            // 8 bytes of 1bpp rows instead of a 128 byte image. The GPU
+            // expands it with the glyph colors queued before it
+            bool setGlyphColors(const uint16_t fg, const uint16_t bg);
+            bool uploadGlyph(
+                const uint16_t slot, const uint8_t *rows,
+                const bool progmem = false
+            );
+
+            // Once started, the GPU steps the sprite through the images by
+            // itself, so a walk cycle or a blinking cursor costs no more
+            // traffic. Up to g_animMaxSteps steps
+            bool defineAnim(
+                const uint8_t anim, const gpulink::AnimMode mode,
+                const gpulink::AnimStep *steps, const uint8_t count,
+                const bool progmem = false
+            );
+            bool playAnim( // gpulink::g_animStop stops it
+                const uint16_t id, const uint16_t anim
+            );
+
+            // Motion the GPU keeps up by itself every frame. Velocities are
+            // in 1/256ths of a px a frame, so 0x180 is 1.5 px. A tween glides
+            // the sprite to x, y over frames, holding its velocity until done
+            bool setVelocity(
+                const uint16_t id, const int16_t dx, const int16_t dy
+            );
+            bool tweenSprite(
+                const uint16_t id, const int16_t x, const int16_t y,
+                const uint8_t frames,
+                const gpulink::Ease ease = gpulink::Ease::Linear
+            );
+            bool setSpriteEdge(
+                const uint16_t id, const gpulink::MotionEdge edge
+            );
+            bool setMotionBounds( // For every sprite's MotionEdge
+                const int16_t left, const int16_t top,
+                const int16_t right, const int16_t bottom
+            );
+
+            // Per scanline tables, g_rasterLines entries each, so gradients,
+            // ripples and split scrolling cost nothing once they're up.
+            // Writing the Background table overrides setBackground() until
+            // setBackground() is called again
+            bool setRasterLines(
+                const gpulink::RasterTable table, const uint16_t first,
+                const uint16_t *values, const uint16_t count,
+                const bool progmem = false
+            );
+            bool fillRasterLines(
+                const gpulink::RasterTable table, const uint16_t first,
+                const uint16_t count, const uint16_t value
+            );
+
+            // A palette framebuffer under the sprites that the GPU draws
+            // into and keeps, in its own coordinates (see LayerSetup). Blits
+            // are w x h 4 bit indices, two a byte, high nibble first
+            bool setupLayer(
+                const uint8_t bpp, const uint16_t w, const uint16_t h
+            );
+            bool setLayerPosition(const int16_t x, const int16_t y);
+            bool setLayerPalette(const uint8_t index, const uint16_t color);
+            bool setLayerPen(const uint8_t index);
+            bool layerPixel(const int16_t x, const int16_t y);
+            bool layerLine(
+                const int16_t x0, const int16_t y0,
+                const int16_t x1, const int16_t y1
+            );
+            bool layerRect(
+                const int16_t x, const int16_t y,
+                const uint16_t w, const uint16_t h
+            );
+            bool layerBlit(
+                const int16_t x, const int16_t y,
+                const uint8_t w, const uint8_t h, const uint8_t *indices,
+                const bool progmem = false
+            );
+
+            // A w x h map of image slots drawn through a matrix, under the
+            // sprites and the layer (see AffineSetup). Per line scale and
+            // map row come from the AffineScale and AffineRow raster tables
+            bool setupAffine(
+                const uint16_t w, const uint16_t h,
+                const gpulink::AffineEdge edge = gpulink::AffineEdge::Wrap
+            );
+            bool setAffineTiles(
+                const uint16_t first, const uint8_t *slots,
+                const uint16_t count, const bool progmem = false
+            );
+            bool fillAffineTiles(
+                const uint16_t first, const uint16_t count, const uint8_t slot
+            );
+            bool setAffineMatrix(
+                const int16_t pa, const int16_t pb,
+                const int16_t pc, const int16_t pd
+            );
+            bool setAffineOrigin(
+                const int16_t u, const int16_t v,
+                const int16_t x, const int16_t y
+            );
+
+            // Restarts the GPU in another resolution (see VideoMode), so
+            // it goes before anything else. What's queued after it waits for
+            // the GPU to come back
+            bool setVideoMode(const gpulink::VideoMode mode);
+
+            // Oldest sprite whose tween has finished, if any. The last
+            // g_tweensDoneSize are kept
+            bool tweenDone(uint16_t &ref_id);
+
+            bool idle(void) const; // Everything has gone out
+            int room(void) const; // Commands that can still be queued
+
+        private:
+            QueuedCommand _ring[g_queueSize];
+            volatile uint8_t _head, _count; // _head is the oldest
+            uint16_t _spriteCount;
+            uint16_t _tweensDone[g_tweensDoneSize];
+            volatile uint8_t _doneHead, _doneCount;
+            ImageResult _imageResults[g_imageResultsSize];
+            volatile uint8_t _resultHead, _resultCount;
+
+            bool _push(const QueuedCommand &cmd);
+            QueuedCommand *_findPending(
+                const gpulink::GpuCommand cmd, const bool matchId,
+                const uint16_t id,
+                const gpulink::GpuCommand barrier =
+                    gpulink::GpuCommand::ClearSprites
+            );
+            int _fillBatch(uint8_t *batch); // Returns bytes used
+            int _encode(QueuedCommand &cmd, uint8_t *out, const int room);
+
+            static void _onRequest(void);
+            static void _onReceive(int len);
+    };
+}
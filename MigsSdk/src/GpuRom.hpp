@@ -0,0 +1,23 @@
+/*
+ * Generated by tools/migsrom.py from rom/. Do not edit.
+ * - Ids of the images built into the GPU firmware. They go anywhere
+ *   an image slot does (see gpulink::g_romImage)
+ * - Fonts are opaque white on clear, with the _<CHAR>_START offsets
+ *   of migsfont.py's headers
+ */
+
+#pragma once
+
+#define ROM_SPRITES_CORNER              0x8000
+#define ROM_SPRITES_CORNER_COUNT        1
+#define ROM_SPRITES_CURSOR              0x8001
+#define ROM_SPRITES_CURSOR_COUNT        1
+#define ROM_FONTS_SYSTEM                0x8002
+#define ROM_FONTS_SYSTEM_COUNT          65
+#define ROM_FONTS_SYSTEM_SPACE          0x8002
+#define ROM_FONTS_SYSTEM_PERIOD         0x8003
+#define ROM_FONTS_SYSTEM_NUM_START      0x8004
+#define ROM_FONTS_SYSTEM_CAP_START      0x800E
+#define ROM_FONTS_SYSTEM_UNDER_START    0x8028
+#define ROM_FONTS_SYSTEM_LOW_START      0x8029
+#define ROM_IMAGE_COUNT                 67
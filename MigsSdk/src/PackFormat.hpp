@@ -0,0 +1,41 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Layout of a per-game resource pack (.PAK), built by tools/migspack.py
+ * - Header: <magic:4> <version> <toc entry size> <count:2> <toc offset:4>
+ *   <reserved:4>
+ * - TOC: one entry per asset, ids run 0..count-1 in order, so asset id's entry
+ *   is at <toc offset> + id * <toc entry size> (no searching)
+ * - Entry: <id:2> <type> <flags> <offset:4> <length:4>, offset from file start
+ * - Blobs are aligned to g_packAlign so they don't straddle more SD sectors
+ *   than they have to
+ * - Multi-byte fields are little endian
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace rsrc {
+    const uint32_t g_packMagic = 0x4B41504D; // "MPAK"
+    const uint8_t g_packVersion = 1;
+    const int g_packHeaderSize = 16;
+    const int g_packEntrySize = 12;
+    const int g_packAlign = 16;
+
+    enum class AssetType : uint8_t {
+        Raw = 0,
+        Sprite = 1, // 8x8 RGAB5515 images, 128 bytes each, frames back to back
+        Tile = 2, // Same as Sprite, but meant for tile maps
+        Map = 3, // <width:2> <height:2> then width * height tile ids (2 bytes)
+        Palette = 4 // RGAB5515 colors, 2 bytes each
+    };
+
+    struct PackEntry {
+        uint16_t id;
+        AssetType type;
+        uint8_t flags;
+        uint32_t offset;
+        uint32_t length;
+    };
+}
@@ -0,0 +1,44 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Binary events the programmer sends over its debug channel when built with
+ *   PGRMR_DEBUG (MigsProgrammer/DebugTrace.hpp), in place of text
+ * - Records are <g_sync> <event> <code> <time ms:4> <arg:2> <xor of the
+ *   rest>, little endian. code is the stk500::Error for warnings and errors,
+ *   the boot::Phase for BootPhase, otherwise 0
+ * - The ErrorReceiver passes them through untouched; tools/migsdebug.py (or
+ *   the simulator) turns them back into text and timings
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace pgrmrtrace {
+    const uint8_t g_sync = 0xA5; // Never in the ASCII some senders mix in
+    const int g_recordSize = 10;
+    const uint32_t g_baud = 57600;
+
+    enum class Event : uint8_t {
+        Dropped = 0x00, // arg = records lost while the ring was full
+        BootPhase = 0x01, // code = boot::Phase, at the time it was marked
+
+        // Flashing the logic MCU
+        ProgramMode = 0x10,
+        PageWritten = 0x11, // arg = byte address of the page
+        Finished = 0x12, // Whole image written, disabling
+        Done = 0x13, // New program started
+
+        // Warnings: code = stk500::Error
+        SyncFailed = 0x20,
+        ProgramModeFailed = 0x21,
+        LoadAddrFailed = 0x22, // arg = page address
+        PageWriteFailed = 0x23, // arg = page address
+        DisableFailed = 0x24,
+        Restarting = 0x25, // arg = attempt
+        GaveUp = 0x26,
+
+        // Errors: code = stk500::Error, the programmer stops after sending
+        SdFailed = 0x40
+    };
+}
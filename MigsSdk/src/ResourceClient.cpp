@@ -0,0 +1,409 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the resource client
+ */
+
+#include <Arduino.h>
+#include "ResourceProtocol.hpp"
+#include "PackFormat.hpp"
+#include "ResourceClient.hpp"
+
+using namespace rsrc;
+
+// Longest the provider may go quiet mid response (SD access included)
+const unsigned long g_respTimeout = 100;
+
+// Longest the first list may take to start: the provider checks its game
+// index against the card first, and rebuilds it when the games changed
+const unsigned long g_listTimeout = 3000;
+
+uint8_t g_reqBuff[g_maxPayload];
+
+ResourceClient::ResourceClient(void) {
+}
+
+Status ResourceClient::open(const char *name, uint8_t &ref_handle) {
+    uint8_t len = strnlen(name, g_nameLenLimit - 1);
+    _request(Command::Open, reinterpret_cast<const uint8_t *>(name), len);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recv(&ref_handle, 1) ? Status::Ok : Status::Timeout;
+}
+
+Status ResourceClient::read(
+        const uint8_t handle, const uint32_t offset,
+        uint8_t *buff, const uint16_t len, uint16_t &ref_got) {
+    _requestRead(Command::Read, &handle, 1, offset, len, 0);
+
+    Status status = _response(ref_got);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recv(buff, ref_got) ? Status::Ok : Status::Timeout;
+}
+
+Status ResourceClient::stream(
+        const uint8_t handle, const uint32_t offset,
+        const uint16_t len, uint8_t *buff, const uint8_t window,
+        StreamSink sink, uint16_t &ref_got) {
+    if(window == 0) {
+        return Status::BadFrame;
+    }
+    _requestRead(Command::Read, &handle, 1, offset, len, window);
+
+    Status status = _response(ref_got);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recvWindows(ref_got, buff, window, sink);
+}
+
+Status ResourceClient::close(const uint8_t handle) {
+    _request(Command::Close, &handle, 1);
+
+    uint16_t respLen;
+    return _response(respLen);
+}
+
+Status ResourceClient::list(
+        const uint16_t offset, const uint8_t count,
+        char (*names)[g_nameLenLimit], uint8_t &ref_got,
+        uint16_t &ref_total) {
+    g_reqBuff[0] = offset & 0xFF;
+    g_reqBuff[1] = (offset >> 8) & 0xFF;
+    g_reqBuff[2] = count;
+    _request(Command::List, g_reqBuff, 3);
+
+    uint16_t respLen;
+    Status status = _response(respLen, g_listTimeout);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t total[2];
+    if(!_recv(total, 2)) {
+        return Status::Timeout;
+    }
+    ref_total = total[0] | (static_cast<uint16_t>(total[1]) << 8);
+    ref_got = (respLen - 2) / g_nameLenLimit;
+    for(int i = 0; i < ref_got; i++) {
+        if(!_recv(reinterpret_cast<uint8_t *>(names[i]), g_nameLenLimit)) {
+            return Status::Timeout;
+        }
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::openPack(const char *name, uint16_t &ref_count) {
+    uint8_t len = strnlen(name, g_nameLenLimit - 1);
+    _request(Command::OpenPack, reinterpret_cast<const uint8_t *>(name), len);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t count[2];
+    if(!_recv(count, 2)) {
+        return Status::Timeout;
+    }
+    ref_count = count[0] | (static_cast<uint16_t>(count[1]) << 8);
+    return Status::Ok;
+}
+
+Status ResourceClient::assetInfo(
+        const uint16_t id, AssetType &ref_type, uint32_t &ref_length) {
+    g_reqBuff[0] = id & 0xFF;
+    g_reqBuff[1] = (id >> 8) & 0xFF;
+    _request(Command::AssetInfo, g_reqBuff, 2);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t info[6];
+    if(!_recv(info, 6)) {
+        return Status::Timeout;
+    }
+    ref_type = static_cast<AssetType>(info[0]);
+    ref_length = 0;
+    for(int i = 0; i < 4; i++) {
+        ref_length |= static_cast<uint32_t>(info[2 + i]) << (i * 8);
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::readAsset(
+        const uint16_t id, const uint32_t offset,
+        uint8_t *buff, const uint16_t len, uint16_t &ref_got) {
+    uint8_t key[2] = {
+        static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8)
+    };
+    _requestRead(Command::ReadAsset, key, 2, offset, len, 0);
+
+    Status status = _response(ref_got);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recv(buff, ref_got) ? Status::Ok : Status::Timeout;
+}
+
+Status ResourceClient::streamAsset(
+        const uint16_t id, const uint32_t offset,
+        const uint16_t len, uint8_t *buff, const uint8_t window,
+        StreamSink sink, uint16_t &ref_got) {
+    if(window == 0) {
+        return Status::BadFrame;
+    }
+    uint8_t key[2] = {
+        static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8)
+    };
+    _requestRead(Command::ReadAsset, key, 2, offset, len, window);
+
+    Status status = _response(ref_got);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recvWindows(ref_got, buff, window, sink);
+}
+
+Status ResourceClient::baud(const uint8_t index) {
+    _request(Command::Baud, &index, 1);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status == Status::Ok) {
+        Serial.flush();
+        Serial.begin(g_bauds[index]);
+    }
+    return status;
+}
+
+Status ResourceClient::stats(uint32_t &ref_hits, uint32_t &ref_misses) {
+    _request(Command::Stats, nullptr, 0);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t counts[8];
+    if(!_recv(counts, 8)) {
+        return Status::Timeout;
+    }
+    ref_hits = ref_misses = 0;
+    for(int i = 0; i < 4; i++) {
+        ref_hits |= static_cast<uint32_t>(counts[i]) << (i * 8);
+        ref_misses |= static_cast<uint32_t>(counts[4 + i]) << (i * 8);
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::upload(const uint16_t id, const uint16_t slot) {
+    g_reqBuff[0] = id & 0xFF;
+    g_reqBuff[1] = (id >> 8) & 0xFF;
+    g_reqBuff[2] = slot & 0xFF;
+    g_reqBuff[3] = (slot >> 8) & 0xFF;
+    _request(Command::Upload, g_reqBuff, 4);
+
+    uint16_t respLen;
+    return _response(respLen);
+}
+
+Status ResourceClient::uploadStatus(uint32_t &ref_left) {
+    _request(Command::UploadStatus, nullptr, 0);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t left[4];
+    if(!_recv(left, 4)) {
+        return Status::Timeout;
+    }
+    ref_left = 0;
+    for(int i = 0; i < 4; i++) {
+        ref_left |= static_cast<uint32_t>(left[i]) << (i * 8);
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::assetHash(
+        const uint16_t id, const uint16_t image, uint32_t &ref_hash) {
+    g_reqBuff[0] = id & 0xFF;
+    g_reqBuff[1] = (id >> 8) & 0xFF;
+    g_reqBuff[2] = image & 0xFF;
+    g_reqBuff[3] = (image >> 8) & 0xFF;
+    _request(Command::AssetHash, g_reqBuff, 4);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t hash[4];
+    if(!_recv(hash, 4)) {
+        return Status::Timeout;
+    }
+    ref_hash = 0;
+    for(int i = 0; i < 4; i++) {
+        ref_hash |= static_cast<uint32_t>(hash[i]) << (i * 8);
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::openSave(const char *name, uint32_t &ref_size) {
+    uint8_t len = strnlen(name, g_nameLenLimit - 1);
+    _request(Command::OpenSave, reinterpret_cast<const uint8_t *>(name), len);
+
+    uint16_t respLen;
+    Status status = _response(respLen);
+    if(status != Status::Ok) {
+        return status;
+    }
+    uint8_t size[4];
+    if(!_recv(size, 4)) {
+        return Status::Timeout;
+    }
+    ref_size = 0;
+    for(int i = 0; i < 4; i++) {
+        ref_size |= static_cast<uint32_t>(size[i]) << (i * 8);
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::writeSave(
+        const uint32_t offset, const uint8_t *data, uint16_t len) {
+    uint32_t pos = offset;
+    while(len > 0) {
+        uint8_t n = min(len, g_maxPayload - 4);
+        for(int i = 0; i < 4; i++) {
+            g_reqBuff[i] = (pos >> (i * 8)) & 0xFF;
+        }
+        memcpy(&g_reqBuff[4], data, n);
+        _request(Command::WriteSave, g_reqBuff, 4 + n);
+
+        uint16_t respLen;
+        Status status = _response(respLen);
+        if(status != Status::Ok) {
+            return status;
+        }
+        pos += n;
+        data += n;
+        len -= n;
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::appendSave(const uint8_t *data, uint16_t len) {
+    while(len > 0) {
+        uint8_t n = min(len, g_maxPayload);
+        _request(Command::AppendSave, data, n);
+
+        uint16_t respLen;
+        Status status = _response(respLen);
+        if(status != Status::Ok) {
+            return status;
+        }
+        data += n;
+        len -= n;
+    }
+    return Status::Ok;
+}
+
+Status ResourceClient::syncSave(void) {
+    _request(Command::SyncSave, nullptr, 0);
+
+    uint16_t respLen;
+    return _response(respLen);
+}
+
+Status ResourceClient::readSave(
+        const uint32_t offset, uint8_t *buff, const uint16_t len,
+        uint16_t &ref_got) {
+    _requestRead(Command::ReadSave, nullptr, 0, offset, len, 0);
+
+    Status status = _response(ref_got);
+    if(status != Status::Ok) {
+        return status;
+    }
+    return _recv(buff, ref_got) ? Status::Ok : Status::Timeout;
+}
+
+// <key...> <offset:4> <len:2> [window], key being a handle or an asset id
+void ResourceClient::_requestRead(
+        const Command cmd, const uint8_t *key, const uint8_t keyLen,
+        const uint32_t offset, const uint16_t len, const uint8_t window) {
+    if(keyLen > 0) {
+        memcpy(g_reqBuff, key, keyLen);
+    }
+    for(int i = 0; i < 4; i++) {
+        g_reqBuff[keyLen + i] = (offset >> (i * 8)) & 0xFF;
+    }
+    g_reqBuff[keyLen + 4] = len & 0xFF;
+    g_reqBuff[keyLen + 5] = (len >> 8) & 0xFF;
+    g_reqBuff[keyLen + 6] = window;
+    _request(cmd, g_reqBuff, keyLen + ((window > 0) ? 7 : 6));
+}
+
+Status ResourceClient::_recvWindows(
+        const uint16_t len, uint8_t *buff, const uint8_t window,
+        StreamSink sink) {
+    for(uint16_t left = len; left > 0; ) {
+        uint16_t n = min(left, window);
+        if(!_recv(buff, n)) {
+            return Status::Timeout;
+        }
+        left -= n;
+        if(left > 0) {
+            Serial.write(g_ackByte); // Let the next window come while we work
+        }
+        sink(buff, n);
+    }
+    return Status::Ok;
+}
+
+void ResourceClient::_request(
+        const Command cmd, const uint8_t *payload, const uint8_t len) {
+    Serial.write(static_cast<uint8_t>(cmd));
+    Serial.write(len);
+    Serial.write(payload, len);
+}
+
+Status ResourceClient::_response(uint16_t &ref_len) {
+    return _response(ref_len, g_respTimeout);
+}
+
+// Waits up to wait for the response to start, then g_respTimeout per byte
+Status ResourceClient::_response(uint16_t &ref_len, const unsigned long wait) {
+    uint8_t header[3];
+    if(!_recv(header, 1, wait) || !_recv(&header[1], 2)) {
+        return Status::Timeout;
+    }
+    ref_len = header[1] | (static_cast<uint16_t>(header[2]) << 8);
+    return static_cast<Status>(header[0]);
+}
+
+// Like Serial.readBytes, but the timeout restarts with every byte
+bool ResourceClient::_recv(uint8_t *buff, const uint16_t len) {
+    return _recv(buff, len, g_respTimeout);
+}
+
+bool ResourceClient::_recv(
+        uint8_t *buff, const uint16_t len, const unsigned long timeout) {
+    unsigned long last = millis();
+    for(uint16_t i = 0; i < len; ) {
+        if(Serial.available()) {
+            buff[i++] = Serial.read();
+            last = millis();
+        } else if(millis() - last >= timeout) {
+            return false;
+        }
+    }
+    return true;
+}
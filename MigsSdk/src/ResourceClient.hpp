@@ -0,0 +1,102 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Logic MCU side of the resource protocol (see ResourceProtocol.hpp)
+ * - Calls block until the response arrives or the provider stops answering
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "ResourceProtocol.hpp"
+#include "PackFormat.hpp"
+
+namespace rsrc {
+    // Gets each window's worth of data from ResourceClient::stream
+    typedef void (*StreamSink)(const uint8_t *data, const uint16_t len);
+
+    class ResourceClient {
+        public:
+            ResourceClient(void);
+
+            Status open(const char *name, uint8_t &ref_handle);
+            Status read(
+                const uint8_t handle, const uint32_t offset,
+                uint8_t *buff, const uint16_t len, uint16_t &ref_got
+            );
+
+            // Read more than fits in RAM, buff holding one window at a time
+            // Keep window <= the rx buffer size (64) so nothing is dropped
+            Status stream(
+                const uint8_t handle, const uint32_t offset,
+                const uint16_t len, uint8_t *buff, const uint8_t window,
+                StreamSink sink, uint16_t &ref_got
+            );
+            Status close(const uint8_t handle);
+            // Waits up to g_listTimeout for the answer to start, since the
+            // provider may be checking or rebuilding its game index
+            Status list(
+                const uint16_t offset, const uint8_t count,
+                char (*names)[g_nameLenLimit], uint8_t &ref_got,
+                uint16_t &ref_total
+            );
+            Status baud(const uint8_t index); // Index into g_bauds
+            Status stats(uint32_t &ref_hits, uint32_t &ref_misses);
+
+            // Resource pack access, assets by id (see PackFormat.hpp)
+            Status openPack(const char *name, uint16_t &ref_count);
+            Status assetInfo(
+                const uint16_t id, AssetType &ref_type, uint32_t &ref_length
+            );
+            Status readAsset(
+                const uint16_t id, const uint32_t offset,
+                uint8_t *buff, const uint16_t len, uint16_t &ref_got
+            );
+            Status streamAsset(
+                const uint16_t id, const uint32_t offset,
+                const uint16_t len, uint8_t *buff, const uint8_t window,
+                StreamSink sink, uint16_t &ref_got
+            );
+
+            // Have the programmer send an asset to GPU image slots from slot
+            // on, one slot per 128 bytes. Returns Busy while one is going
+            Status upload(const uint16_t id, const uint16_t slot);
+            Status uploadStatus(uint32_t &ref_left); // Done when left is 0
+            Status assetHash( // Of the image at slot + image once uploaded
+                const uint16_t id, const uint16_t image, uint32_t &ref_hash
+            );
+
+            // The game's save file. Writes are split into as many requests
+            // as they need, and only reach the card on syncSave() or once
+            // the game stops writing for a moment
+            Status openSave(const char *name, uint32_t &ref_size);
+            Status writeSave(
+                const uint32_t offset, const uint8_t *data, uint16_t len
+            );
+            Status appendSave(const uint8_t *data, uint16_t len);
+            Status syncSave(void);
+            Status readSave(
+                const uint32_t offset, uint8_t *buff, const uint16_t len,
+                uint16_t &ref_got
+            );
+
+        private:
+            void _requestRead(
+                const Command cmd, const uint8_t *key, const uint8_t keyLen,
+                const uint32_t offset, const uint16_t len, const uint8_t window
+            );
+            Status _recvWindows(
+                const uint16_t len, uint8_t *buff, const uint8_t window,
+                StreamSink sink
+            );
+            void _request(
+                const Command cmd, const uint8_t *payload, const uint8_t len
+            );
+            Status _response(uint16_t &ref_len);
+            Status _response(uint16_t &ref_len, const unsigned long wait);
+            bool _recv(uint8_t *buff, const uint16_t len);
+            bool _recv(
+                uint8_t *buff, const uint16_t len, const unsigned long timeout
+            );
+    };
+}
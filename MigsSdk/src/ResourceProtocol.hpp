@@ -0,0 +1,95 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Framed protocol spoken between the logic MCU and the resource provider
+ * - Request: <cmd> <payload len> <payload...>
+ * - Response: <status> <payload len lo> <payload len hi> <payload...>
+ * - 0x55 between requests is ignored, so it can still be sent as a no-op
+ * - Multi-byte fields are little endian
+ * - Flow control: a read with a non-zero window pauses after every <window>
+ *   bytes of data until the client sends g_ackByte, so a client with a small
+ *   rx buffer can take large reads without losing bytes
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace rsrc {
+    const uint8_t g_idleByte = 0x55;
+    const int g_nameLenLimit = 13; // Root dir 8.3 filenames + \0
+    const int g_maxPayload = 32; // Largest request payload
+    const int g_maxHandles = 2; // Files open at once (each costs RAM)
+    const int g_listMax = 4; // Names per list response
+    const unsigned long g_frameTimeout = 20; // ms to finish a started frame
+    const unsigned long g_ackTimeout = 100; // ms until a paused read is dropped
+    const uint8_t g_ackByte = 'A';
+
+    // Rates for Command::Baud (all but 115200 are exact on a 16MHz AVR)
+    const uint32_t g_bauds[] = { 115200, 250000, 500000, 1000000 };
+    const int g_baudCount = sizeof(g_bauds) / sizeof(g_bauds[0]);
+
+    // None can be g_idleByte ('U'), which is skipped between frames
+    enum class Command : uint8_t {
+        Open = 'O', // <name...> -> <handle>
+        Read = 'R', // <handle> <offset:4> <len:2> [window] -> <data...>
+        Close = 'C', // <handle> -> nothing
+        // Sorted games (.HEX files but the menu), with the total for paging
+        List = 'L', // <offset:2> <count> -> <total:2> <name:13>... (<= max)
+        Baud = 'B', // <index into g_bauds> -> nothing, then both sides switch
+
+        // Resource packs (see PackFormat.hpp). One is open at a time
+        OpenPack = 'P', // <name...> -> <asset count:2>
+        AssetInfo = 'I', // <id:2> -> <type> <flags> <length:4>
+        ReadAsset = 'A', // <id:2> <offset:4> <len:2> [window] -> <data...>
+
+        Stats = 'S', // -> <read-ahead hits:4> <read-ahead misses:4>
+
+        // Programmer sends a pack asset straight to GPU image slots over I2C
+        // (see GpuLink.hpp), so the data never goes through the logic MCU
+        Upload = 'G', // <id:2> <first gpu slot:2> -> nothing (queued)
+        UploadStatus = 'W', // -> <bytes left:4> (0 once the GPU has it all)
+        // gpulink's image hash of the image'th 128 bytes of an asset, to ask
+        // the GPU for it before uploading (see GpuCommand::FindImage)
+        AssetHash = 'H', // <id:2> <image:2> -> <hash:4>
+
+        // A game's save file. One is open at a time, and writes are buffered
+        // by the provider, so they return before reaching the card
+        OpenSave = 'V', // <name...> -> <size:4> (created if missing)
+        WriteSave = 'X', // <offset:4> <data...> -> nothing (offset <= size)
+        AppendSave = 'Y', // <data...> -> nothing
+        SyncSave = 'Z', // -> nothing, once everything is on the card
+        ReadSave = 'Q' // <offset:4> <len:2> [window] -> <data...>
+    };
+
+    constexpr bool isIdle(const Command cmd) {
+        return static_cast<uint8_t>(cmd) == g_idleByte;
+    }
+    static_assert(
+        !isIdle(Command::Open) && !isIdle(Command::Read)
+            && !isIdle(Command::Close) && !isIdle(Command::List)
+            && !isIdle(Command::Baud) && !isIdle(Command::OpenPack)
+            && !isIdle(Command::AssetInfo) && !isIdle(Command::ReadAsset)
+            && !isIdle(Command::Stats) && !isIdle(Command::Upload)
+            && !isIdle(Command::UploadStatus) && !isIdle(Command::AssetHash)
+            && !isIdle(Command::OpenSave) && !isIdle(Command::WriteSave)
+            && !isIdle(Command::AppendSave) && !isIdle(Command::SyncSave)
+            && !isIdle(Command::ReadSave),
+        "A command is the idle byte, so the provider would skip it"
+    );
+
+    enum class Status : uint8_t {
+        Ok = 0,
+        BadFrame = 1, // Unknown command, bad length, or frame timed out
+        NotFound = 2,
+        NoHandles = 3,
+        BadHandle = 4,
+        BadOffset = 5,
+        BadBaud = 6,
+        BadPack = 7, // No pack open, or it isn't a valid one
+        BadAsset = 8,
+        Busy = 9, // An upload is still going
+        BadSave = 10, // No save open, or the card wouldn't take the write
+        Timeout = 0xFF // Never sent; client side only
+    };
+}
@@ -0,0 +1,90 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Logic MCU program for the simulator's sprite load scenario
+ * - Opens SPRITES.PAK, gets every sprite in it into the GPU image slot of the
+ *   same number and puts one of each on screen, in a grid
+ * - The programmer sends the images straight to the GPU (Upload). Built with
+ *   SPRITE_LOAD_VIA_CPU, they come through the logic MCU instead (streamAsset
+ *   into GpuQueue::uploadImage), to compare the two
+ */
+
+#include <Wire.h>
+#include <ResourceClient.hpp>
+#include <GpuQueue.hpp>
+
+const char *g_packName = "SPRITES.PAK";
+const uint16_t g_bg = 0x0000;
+const int g_gridColumns = 36;
+const int g_gridSpacing = 12;
+const int g_gridMargin = 8;
+
+rsrc::ResourceClient g_resources;
+gfx::GpuQueue g_gpu;
+
+#if defined(SPRITE_LOAD_VIA_CPU)
+const uint8_t g_windowSize = 32;
+uint8_t g_image[gpulink::g_imageSize];
+uint8_t g_window[g_windowSize];
+uint16_t g_imageLen = 0;
+
+void sink(const uint8_t *data, const uint16_t len) {
+    memcpy(&g_image[g_imageLen], data, len);
+    g_imageLen += len;
+}
+#endif
+
+// Spinning on the queue has to give the GPU's polls a chance
+void waitForRoom(void) {
+    while(g_gpu.room() == 0) {
+        delayMicroseconds(100);
+    }
+}
+
+bool loadImage(const uint16_t id) {
+#if defined(SPRITE_LOAD_VIA_CPU)
+    // The queue sends straight out of g_image, so the last one must be gone
+    while(!g_gpu.idle()) {
+        delayMicroseconds(100);
+    }
+    uint16_t got;
+    g_imageLen = 0;
+    if(g_resources.streamAsset(
+            id, 0, gpulink::g_imageSize, g_window, g_windowSize, sink, got)
+            != rsrc::Status::Ok) {
+        return false;
+    }
+    waitForRoom();
+    return g_gpu.uploadImage(id, g_image);
+#else
+    rsrc::Status status;
+    while((status = g_resources.upload(id, id)) == rsrc::Status::Busy) {
+    }
+    return status == rsrc::Status::Ok;
+#endif
+}
+
+void setup(void) {
+    Serial.begin(115200);
+    g_gpu.begin();
+    g_gpu.setBackground(g_bg);
+
+    uint16_t count;
+    if(g_resources.openPack(g_packName, count) != rsrc::Status::Ok) {
+        return;
+    }
+    for(uint16_t i = 0; i < count; i++) {
+        if(!loadImage(i)) {
+            return;
+        }
+        uint16_t id;
+        waitForRoom();
+        g_gpu.addSprite(
+            g_gridMargin + (i % g_gridColumns) * g_gridSpacing,
+            g_gridMargin + (i / g_gridColumns) * g_gridSpacing, i, id
+        );
+    }
+}
+
+void loop(void) {
+}
@@ -0,0 +1,456 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The Arduino core, Wire, EEPROM and SoftwareSerial stand-ins, acting on
+ *   whichever simulated AVR is running
+ */
+
+#include <stdio.h>
+#include "Avr.hpp"
+#include <Arduino.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <SoftwareSerial.h>
+
+using namespace sim;
+
+HardwareSerial Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+Avr::Avr(const std::string &name) :
+        name(name), uart(name), wire {}, interruptsOn(true), pinsLow(0) {
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    memset(flash, 0xFF, sizeof(flash));
+}
+
+void Avr::reset(void) {
+    uart.reset();
+    g_i2c.detach(wire);
+    wire.onRequest = nullptr;
+    wire.onReceive = nullptr;
+    interruptsOn = true;
+}
+
+void sim::bind(Core &core, Avr &avr) {
+    core.board = &avr;
+    avr.wire.core = &core;
+}
+
+Avr &sim::avr(void) {
+    return *static_cast<Avr *>(current().board);
+}
+
+// Time
+
+unsigned long millis(void) {
+    spend(g_avrCallCost);
+    return now() / g_ms;
+}
+
+unsigned long micros(void) {
+    spend(g_avrCallCost);
+    return now() / g_us;
+}
+
+void delay(unsigned long ms) {
+    spend(ms * g_ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    spend(us * g_us);
+}
+
+// Pins (only the reset line and the buttons a scenario presses go anywhere)
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    spend(g_avrPinCost);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    spend(g_avrPinCost);
+    if(current().onPin) {
+        current().onPin(pin, val);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    spend(g_avrPinCost);
+    return ((avr().pinsLow >> pin) & 1) ? LOW : HIGH;
+}
+
+int analogRead(uint8_t pin) {
+    spend(110 * g_us);
+    return 512;
+}
+
+void noInterrupts(void) {
+    avr().interruptsOn = false;
+}
+
+void interrupts(void) {
+    avr().interruptsOn = true;
+}
+
+// Print/Stream
+
+size_t Print::write(const uint8_t *buff, size_t len) {
+    size_t n = 0;
+    while(len--) {
+        n += write(*buff++);
+    }
+    return n;
+}
+
+size_t Print::write(const char *str) {
+    return str ? write(reinterpret_cast<const uint8_t *>(str), strlen(str)) : 0;
+}
+
+size_t Print::print(const __FlashStringHelper *str) {
+    return write(reinterpret_cast<const char *>(str));
+}
+
+size_t Print::print(const char *str) {
+    return write(str);
+}
+
+size_t Print::print(char c) {
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char n, int base) {
+    return print(static_cast<unsigned long>(n), base);
+}
+
+size_t Print::print(int n, int base) {
+    return print(static_cast<long>(n), base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+    return print(static_cast<unsigned long>(n), base);
+}
+
+size_t Print::print(long n, int base) {
+    if((base == DEC) && (n < 0)) {
+        return print('-') + _printNumber(-n, base);
+    }
+    return _printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+    return _printNumber(n, base);
+}
+
+size_t Print::println(void) {
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper *str) {
+    return print(str) + println();
+}
+
+size_t Print::println(const char *str) {
+    return print(str) + println();
+}
+
+size_t Print::println(char c) {
+    return print(c) + println();
+}
+
+size_t Print::println(unsigned char n, int base) {
+    return print(n, base) + println();
+}
+
+size_t Print::println(int n, int base) {
+    return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+    return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base) {
+    return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+    return print(n, base) + println();
+}
+
+size_t Print::_printNumber(unsigned long n, int base) {
+    char buff[8 * sizeof(long) + 1];
+    char *str = &buff[sizeof(buff) - 1];
+    *str = '\0';
+    if(base < 2) {
+        base = 10;
+    }
+    do {
+        int digit = n % base;
+        n /= base;
+        *--str = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+    } while(n);
+    return write(str);
+}
+
+void Stream::setTimeout(unsigned long ms) {
+    _timeout = ms;
+}
+
+size_t Stream::readBytes(uint8_t *buff, size_t len) {
+    size_t got = 0;
+    unsigned long start = millis();
+    while((got < len) && (millis() - start < _timeout)) {
+        int c = read();
+        if(c >= 0) {
+            buff[got++] = c;
+        }
+    }
+    return got;
+}
+
+size_t Stream::readBytes(char *buff, size_t len) {
+    return readBytes(reinterpret_cast<uint8_t *>(buff), len);
+}
+
+// Serial
+
+void HardwareSerial::begin(unsigned long baud) {
+    spend(g_avrCallCost);
+    avr().uart.begin(baud);
+}
+
+void HardwareSerial::end(void) {
+    avr().uart.end();
+}
+
+int HardwareSerial::available(void) {
+    spend(g_avrCallCost);
+    return avr().uart.available();
+}
+
+int HardwareSerial::read(void) {
+    spend(g_avrSerialByteCost);
+    return avr().uart.read();
+}
+
+int HardwareSerial::peek(void) {
+    spend(g_avrCallCost);
+    return avr().uart.peek();
+}
+
+int HardwareSerial::availableForWrite(void) {
+    spend(g_avrCallCost);
+    return avr().uart.availableForWrite();
+}
+
+void HardwareSerial::flush(void) {
+    avr().uart.flush();
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    spend(g_avrSerialByteCost);
+    avr().uart.write(c);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buff, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        write(buff[i]);
+    }
+    return len;
+}
+
+// Wire (slave side)
+
+void TwoWire::begin(void) {
+}
+
+void TwoWire::begin(uint8_t addr) {
+    spend(g_avrCallCost);
+    I2cSlave &slave = avr().wire;
+    slave.addr = addr;
+    slave.txLen = 0;
+    g_i2c.attach(slave);
+}
+
+void TwoWire::end(void) {
+    g_i2c.detach(avr().wire);
+}
+
+void TwoWire::setClock(uint32_t hz) {
+}
+
+void TwoWire::onRequest(void (*handler)(void)) {
+    avr().wire.onRequest = handler;
+}
+
+void TwoWire::onReceive(void (*handler)(int)) {
+    avr().wire.onReceive = handler;
+}
+
+int TwoWire::available(void) {
+    I2cSlave &slave = avr().wire;
+    return slave.rxLen - slave.rxPos;
+}
+
+int TwoWire::read(void) {
+    I2cSlave &slave = avr().wire;
+    return (slave.rxPos < slave.rxLen) ? slave.rx[slave.rxPos++] : -1;
+}
+
+int TwoWire::peek(void) {
+    I2cSlave &slave = avr().wire;
+    return (slave.rxPos < slave.rxLen) ? slave.rx[slave.rxPos] : -1;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+// Like the AVR library, only fills the 32 byte buffer
+size_t TwoWire::write(const uint8_t *buff, size_t len) {
+    I2cSlave &slave = avr().wire;
+    size_t n = min(len, static_cast<size_t>(g_wireBuffSize - slave.txLen));
+    memcpy(&slave.tx[slave.txLen], buff, n);
+    slave.txLen += n;
+    return n;
+}
+
+// EEPROM
+
+uint8_t EEPROMClass::read(int addr) {
+    spend(g_avrCallCost);
+    return avr().eeprom[addr % g_avrEepromSize];
+}
+
+void EEPROMClass::write(int addr, uint8_t val) {
+    spend(g_avrEepromWriteCost);
+    avr().eeprom[addr % g_avrEepromSize] = val;
+}
+
+void EEPROMClass::update(int addr, uint8_t val) {
+    if(read(addr) != val) {
+        write(addr, val);
+    }
+}
+
+uint16_t EEPROMClass::length(void) {
+    return g_avrEepromSize;
+}
+
+// SoftwareSerial: the debug channel, one trace event per line or record
+
+// Same words as tools/migsdebug.py
+static const char *phaseName(const int phase) {
+    static const char *names[] = {
+        "start", "sd ready", "image checked", "synced", "flashed",
+        "unchanged", "ready"
+    };
+    int count = sizeof(names) / sizeof(names[0]);
+    return ((phase >= 0) && (phase < count)) ? names[phase] : "?";
+}
+
+static void traceEvent(const uint8_t *rec) {
+    using pgrmrtrace::Event;
+    int code = static_cast<int8_t>(rec[2]);
+    unsigned long ms = rec[3] | (rec[4] << 8) | (rec[5] << 16)
+        | (static_cast<unsigned long>(rec[6]) << 24);
+    unsigned arg = rec[7] | (rec[8] << 8);
+    const char *warn = nullptr;
+    switch(static_cast<Event>(rec[1])) {
+        case Event::Dropped:
+            event("debug: %u records dropped", arg);
+            return;
+        case Event::BootPhase:
+            event("debug: boot %s @ %lu ms", phaseName(code), ms);
+            return;
+        case Event::ProgramMode:
+            event("debug: program mode");
+            return;
+        case Event::PageWritten:
+            event("debug: page 0x%04X written", arg);
+            return;
+        case Event::Finished:
+            event("debug: finished programming");
+            return;
+        case Event::Done:
+            event("debug: new program started");
+            return;
+        case Event::SdFailed:
+            event("debug: error: SD card init failed (%d)", code);
+            return;
+        case Event::SyncFailed:
+            warn = "sync failed";
+            break;
+        case Event::ProgramModeFailed:
+            warn = "program mode failed";
+            break;
+        case Event::LoadAddrFailed:
+            warn = "load address failed";
+            break;
+        case Event::PageWriteFailed:
+            warn = "page write failed";
+            break;
+        case Event::DisableFailed:
+            warn = "disable failed";
+            break;
+        case Event::Restarting:
+            warn = "restarting";
+            break;
+        case Event::GaveUp:
+            warn = "gave up";
+            break;
+        default:
+            event("debug: unknown event 0x%02X", rec[1]);
+            return;
+    }
+    event("debug: warning: %s (%d, arg 0x%04X)", warn, code, arg);
+}
+
+SoftwareSerial::SoftwareSerial(uint8_t rx, uint8_t tx) :
+        _baud(9600), _lineLen(0), _recordLen(0) {
+}
+
+void SoftwareSerial::begin(long baud) {
+    _baud = baud;
+}
+
+int SoftwareSerial::available(void) {
+    return 0;
+}
+
+int SoftwareSerial::read(void) {
+    return -1;
+}
+
+int SoftwareSerial::peek(void) {
+    return -1;
+}
+
+// Bit banged with interrupts off, so the sender waits out every bit
+size_t SoftwareSerial::write(uint8_t c) {
+    spend(10 * g_sec / _baud);
+    if((_recordLen > 0) || (c == pgrmrtrace::g_sync)) {
+        _record[_recordLen++] = c;
+        if(_recordLen < pgrmrtrace::g_recordSize) {
+            return 1;
+        }
+        _recordLen = 0;
+        uint8_t check = 0;
+        for(int i = 1; i < pgrmrtrace::g_recordSize - 1; i++) {
+            check ^= _record[i];
+        }
+        if(check == _record[pgrmrtrace::g_recordSize - 1]) {
+            traceEvent(_record);
+        } else {
+            event("debug: bad record");
+        }
+    } else if(c == '\n') {
+        _line[_lineLen] = '\0';
+        event("debug: %s", _line);
+        _lineLen = 0;
+    } else if((c != '\r') && (_lineLen < static_cast<int>(sizeof(_line)) - 1)) {
+        _line[_lineLen++] = c;
+    }
+    return 1;
+}
@@ -0,0 +1,40 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The peripherals of a simulated ATmega328p, which the Arduino stand-ins
+ *   (Serial, Wire, EEPROM, pins) find through the core that's running
+ * - Also the costs charged for Arduino calls, roughly what they take at 16MHz
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "Sim.hpp"
+#include "Uart.hpp"
+#include "I2cBus.hpp"
+
+namespace sim {
+    const Time g_avrCallCost = 1 * g_us; // millis(), available(), ...
+    const Time g_avrPinCost = 4 * g_us; // digitalWrite
+    const Time g_avrSerialByteCost = 4 * g_us; // Buffering + its interrupt
+    const Time g_avrEepromWriteCost = 3400 * g_us;
+    const int g_avrEepromSize = 1024;
+    const int g_avrFlashSize = 32768;
+
+    struct Avr {
+        Avr(const std::string &name);
+        void reset(void); // Peripherals back to how reset leaves them
+
+        std::string name;
+        Uart uart;
+        I2cSlave wire;
+        uint8_t eeprom[g_avrEepromSize];
+        uint8_t flash[g_avrFlashSize]; // Only kept for the logic MCU
+        bool interruptsOn;
+        uint32_t pinsLow; // Bit per pin held low from outside (buttons)
+    };
+
+    void bind(Core &core, Avr &avr);
+    Avr &avr(void); // The running core's
+}
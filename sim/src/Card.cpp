@@ -0,0 +1,102 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the generated SD card
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <PackFormat.hpp>
+#include "SdCard.hpp"
+#include "Card.hpp"
+
+using namespace sim;
+
+const int g_hexRecordLen = 16;
+const int g_benchSize = 16384;
+const int g_spriteBytes = 128;
+
+static void putU16(std::vector<uint8_t> &out, const uint16_t val) {
+    out.push_back(val & 0xFF);
+    out.push_back(val >> 8);
+}
+
+static void putU32(std::vector<uint8_t> &out, const uint32_t val) {
+    putU16(out, val & 0xFFFF);
+    putU16(out, val >> 16);
+}
+
+// Deterministic filler, so runs can be compared
+static std::vector<uint8_t> filler(const int len, uint32_t seed) {
+    std::vector<uint8_t> data(len);
+    for(uint8_t &b : data) {
+        seed = seed * 1103515245 + 12345;
+        b = seed >> 16;
+    }
+    return data;
+}
+
+std::vector<uint8_t> sim::intelHex(const std::vector<uint8_t> &image) {
+    std::string hex;
+    char line[64];
+    for(size_t addr = 0; addr < image.size(); addr += g_hexRecordLen) {
+        int len = std::min(image.size() - addr, size_t(g_hexRecordLen));
+        uint8_t sum = len + (addr >> 8) + (addr & 0xFF);
+        int n = snprintf(line, sizeof(line), ":%02X%04X00", len, int(addr));
+        for(int i = 0; i < len; i++) {
+            n += snprintf(&line[n], sizeof(line) - n, "%02X", image[addr + i]);
+            sum += image[addr + i];
+        }
+        snprintf(&line[n], sizeof(line) - n, "%02X\r\n", uint8_t(-sum));
+        hex += line;
+    }
+    hex += ":00000001FF\r\n";
+    return std::vector<uint8_t>(hex.begin(), hex.end());
+}
+
+uint16_t sim::spriteColor(const int id) {
+    // Bright, never black, always opaque
+    uint16_t r = 8 + (id * 7) % 24, g = 8 + (id * 13) % 24;
+    uint16_t b = 8 + (id * 5) % 24;
+    return (r << 11) | (g << 6) | 0x20 | b;
+}
+
+// One 8x8 sprite asset per id, see PackFormat.hpp
+std::vector<uint8_t> sim::spritePack(const int count) {
+    uint32_t dataStart = rsrc::g_packHeaderSize + rsrc::g_packEntrySize * count;
+    dataStart += (rsrc::g_packAlign - dataStart % rsrc::g_packAlign)
+        % rsrc::g_packAlign;
+
+    std::vector<uint8_t> pack;
+    putU32(pack, rsrc::g_packMagic);
+    pack.push_back(rsrc::g_packVersion);
+    pack.push_back(rsrc::g_packEntrySize);
+    putU16(pack, count);
+    putU32(pack, rsrc::g_packHeaderSize);
+    putU32(pack, 0);
+    for(int id = 0; id < count; id++) {
+        putU16(pack, id);
+        pack.push_back(static_cast<uint8_t>(rsrc::AssetType::Sprite));
+        pack.push_back(0);
+        putU32(pack, dataStart + id * g_spriteBytes);
+        putU32(pack, g_spriteBytes);
+    }
+    pack.resize(dataStart, 0);
+    for(int id = 0; id < count; id++) {
+        for(int px = 0; px < g_spriteBytes / 2; px++) {
+            putU16(pack, spriteColor(id));
+        }
+    }
+    return pack;
+}
+
+void sim::buildCard(const CardSpec &spec) {
+    g_card.clear();
+    g_card.put("MENU.HEX", intelHex(filler(spec.menuSize, 1)));
+    for(int i = 0; i < spec.games; i++) {
+        std::string name = "GAME" + std::to_string(i + 1) + ".HEX";
+        g_card.put(name, intelHex(filler(spec.menuSize / 2, 2 + i)));
+    }
+    g_card.put("SPRITES.PAK", spritePack(spec.sprites));
+    g_card.put("BENCH.BIN", filler(g_benchSize, 99));
+}
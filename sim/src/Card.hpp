@@ -0,0 +1,26 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Builds the SD card a run starts with when none is given: a MENU.HEX of
+ *   made up code (the AVR build can't run here, only its size matters), a few
+ *   games, a SPRITES.PAK of solid colored sprites and BENCH.BIN
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace sim {
+    struct CardSpec {
+        int menuSize; // Bytes of code in MENU.HEX
+        int games; // GAME<n>.HEX files
+        int sprites; // Assets in SPRITES.PAK
+    };
+
+    void buildCard(const CardSpec &spec);
+
+    std::vector<uint8_t> intelHex(const std::vector<uint8_t> &image);
+    std::vector<uint8_t> spritePack(const int count);
+    uint16_t spriteColor(const int id); // What sprite id is filled with
+}
@@ -0,0 +1,65 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of firmware loading
+ */
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <stdexcept>
+#include "Firmware.hpp"
+
+// dlopen only maps a path once, so each load gets its own file
+static std::string privateCopy(const std::string &path) {
+    char dir[] = "/tmp/migs-sim-XXXXXX";
+    if(!mkdtemp(dir)) {
+        throw std::runtime_error("Can't make a temp dir");
+    }
+    std::string copy = std::string(dir) + "/fw.so";
+    std::ifstream in(path, std::ios::binary);
+    std::ofstream out(copy, std::ios::binary);
+    if(!in || !(out << in.rdbuf())) {
+        throw std::runtime_error("Can't read " + path);
+    }
+    return copy;
+}
+
+Firmware::Firmware(const std::string &path) :
+        _lib(nullptr), _setup(nullptr), _loop(nullptr), _main(nullptr) {
+    std::string copy = privateCopy(path);
+    _lib = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+    unlink(copy.c_str());
+    rmdir(copy.substr(0, copy.rfind('/')).c_str());
+    if(!_lib) {
+        throw std::runtime_error(dlerror());
+    }
+    _setup = reinterpret_cast<void (*)(void)>(dlsym(_lib, "_Z5setupv"));
+    _loop = reinterpret_cast<void (*)(void)>(dlsym(_lib, "_Z4loopv"));
+    _main = reinterpret_cast<int (*)(void)>(dlsym(_lib, "main"));
+}
+
+Firmware::~Firmware(void) {
+    dlclose(_lib);
+}
+
+void Firmware::setup(void) {
+    if(_setup) {
+        _setup();
+    }
+}
+
+void Firmware::loop(void) {
+    if(_loop) {
+        _loop();
+    }
+}
+
+int Firmware::main(void) {
+    return _main ? _main() : 0;
+}
+
+void *Firmware::symbol(const char *name) const {
+    return dlsym(_lib, name);
+}
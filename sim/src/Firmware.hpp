@@ -0,0 +1,28 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - A firmware image built as a shared library against the stand-ins
+ * - Every load is a private copy, so its globals start out fresh (a logic MCU
+ *   reset really does start the program over)
+ */
+
+#pragma once
+
+#include <string>
+
+class Firmware {
+    public:
+        Firmware(const std::string &path);
+        ~Firmware(void);
+
+        void setup(void); // Arduino sketches
+        void loop(void);
+        int main(void); // Pico programs
+        void *symbol(const char *name) const; // nullptr if it has none
+
+    private:
+        void *_lib;
+        void (*_setup)(void);
+        void (*_loop)(void);
+        int (*_main)(void);
+};
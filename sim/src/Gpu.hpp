@@ -0,0 +1,39 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - What the simulator can see of the GPU: the DVI output and its timing, and
+ *   what it sends out of UART0
+ * - Scanout takes a line from the colour queue every scan line slot (two
+ *   output lines at 960x540), straight through the active lines of a frame
+ *   and then the vertical blanking. A line that isn't there by its slot is
+ *   late, which on the real thing shows up as a glitched line
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "Sim.hpp"
+
+namespace sim {
+    struct Frame {
+        uint64_t index;
+        int width, height;
+        std::vector<uint16_t> pixels; // RGAB5515, row by row
+    };
+
+    struct DviStats {
+        uint64_t lines; // Handed to scanout
+        uint64_t frames;
+        uint64_t lateLines; // Slots that went by without a line
+        Time linePeriod; // Slot length
+    };
+
+    void resetGpu(void); // Back to power on
+    void rebootGpu(void); // After a watchdog reboot
+    void onFrame(std::function<void(const Frame &)> callback);
+    const DviStats &dviStats(void);
+    uint32_t gpuClockKhz(void);
+    const std::vector<uint8_t> &gpuUartOutput(void); // Everything sent on UART0
+}
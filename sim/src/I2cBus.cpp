@@ -0,0 +1,211 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the simulated I2C bus
+ */
+
+#include <algorithm>
+#include "I2cBus.hpp"
+
+using namespace sim;
+
+const Time g_twiIsrCost = 5 * g_us; // AVR's TWI interrupt, per byte
+const int g_addrBits = 10; // Start, address + R/W, ack
+const int g_byteBits = 9; // Data, ack
+
+I2cBus sim::g_i2c(100000);
+
+I2cBus::I2cBus(const uint32_t hz) :
+        _bitTime(g_sec / hz), _enabled(false), _active(false), _abort(false),
+        _writing(false),
+        _target(0), _abortAt(0), _busFree(0), _lastDone(0),
+        _issued(0), _popped(0) {
+}
+
+void I2cBus::reset(void) {
+    _slaves.clear();
+    _enabled = _active = _abort = _writing = false;
+    _abortAt = _busFree = _lastDone = 0;
+    _cmdDone.clear();
+    _writeDone.clear();
+    _stats.clear();
+}
+
+void I2cBus::attach(I2cSlave &slave) {
+    detach(slave);
+    slave.attached = true;
+    _slaves.push_back(&slave);
+}
+
+void I2cBus::detach(I2cSlave &slave) {
+    slave.attached = false;
+    _slaves.erase(
+        std::remove(_slaves.begin(), _slaves.end(), &slave), _slaves.end()
+    );
+}
+
+void I2cBus::setTarget(const uint8_t addr) {
+    _target = addr;
+}
+
+void I2cBus::setEnable(const uint32_t val) {
+    if(val & 0x2) { // Abort: stop after the current byte
+        if(_active) {
+            _active = false;
+            _abort = true;
+            _abortAt = std::max(now(), _lastDone) + _bitTime;
+            _busFree = _abortAt;
+            _cmdDone.clear();
+            _writeDone.clear();
+        }
+        return;
+    }
+    _enabled = val & 0x1;
+    if(!_enabled) {
+        _active = false;
+        _abort = false;
+        _cmdDone.clear();
+        _writeDone.clear();
+    }
+}
+
+void I2cBus::pushCommand(const uint32_t val) {
+    if(!_enabled || _abort) {
+        return;
+    }
+
+    if(!_active) {
+        Time start = std::max(now(), _busFree);
+        Time addrDone = start + g_addrBits * _bitTime;
+        I2cStats &stats = _stats[_target];
+        stats.transactions++;
+        stats.busy += addrDone - start;
+
+        I2cSlave *slave = _find(_target);
+        if(!slave) {
+            stats.naks++;
+            _abort = true;
+            _abortAt = _busFree = addrDone + _bitTime;
+            return;
+        }
+
+        // Address match: for a read, the slave loads up what it wants to send
+        _writing = !(val & 0x100);
+        if(_writing) {
+            _written.clear();
+            _data.clear();
+        } else {
+            Interrupt irq(*slave->core);
+            slave->txLen = 0;
+            if(slave->onRequest) {
+                slave->onRequest();
+            }
+            spend(g_twiIsrCost);
+            _data.assign(slave->tx, slave->tx + slave->txLen);
+        }
+        _active = true;
+        _lastDone = addrDone;
+        _issued = _popped = 0;
+    }
+
+    Time done = std::max(now(), _lastDone) + g_byteBits * _bitTime;
+    I2cStats &stats = _stats[_target];
+    stats.bytes++;
+    stats.busy += done - _lastDone;
+    _lastDone = done;
+    if(_writing) {
+        _writeDone.push_back(done);
+        _written.push_back(val & 0xFF);
+    } else {
+        _cmdDone.push_back(done);
+        _issued++;
+    }
+
+    I2cSlave *slave = _find(_target);
+    if(slave) {
+        Interrupt irq(*slave->core);
+        spend(g_twiIsrCost);
+    }
+
+    if(val & 0x200) { // Stop
+        _active = false;
+        _busFree = done + _bitTime;
+        stats.busy += _bitTime;
+        if(_writing && slave) {
+            _deliver(*slave);
+        }
+    }
+}
+
+uint32_t I2cBus::popData(void) {
+    if(_cmdDone.empty() || (_cmdDone.front() > now())) {
+        return 0;
+    }
+    _cmdDone.pop_front();
+    // Past the end of what was loaded, the AVR sends 0xFF
+    int ind = _popped++;
+    return (ind < static_cast<int>(_data.size())) ? _data[ind] : 0xFF;
+}
+
+uint32_t I2cBus::txLevel(void) {
+    Time at = now();
+    Time byteTime = g_byteBits * _bitTime;
+    while(!_writeDone.empty() && (_writeDone.front() - byteTime <= at)) {
+        _writeDone.pop_front();
+    }
+    int level = _writeDone.size();
+    for(Time done : _cmdDone) {
+        if(done - byteTime > at) {
+            level++;
+        }
+    }
+    return level;
+}
+
+uint32_t I2cBus::rxLevel(void) {
+    Time at = now();
+    int level = 0;
+    for(Time done : _cmdDone) {
+        if(done <= at) {
+            level++;
+        }
+    }
+    return std::min(level, g_i2cFifoDepth);
+}
+
+bool I2cBus::aborted(void) {
+    return _abort && (now() >= _abortAt);
+}
+
+void I2cBus::clearAbort(void) {
+    _abort = false;
+}
+
+bool I2cBus::busy(void) {
+    return _active || (now() < _busFree);
+}
+
+const std::map<uint8_t, I2cStats> &I2cBus::stats(void) const {
+    return _stats;
+}
+
+I2cSlave *I2cBus::_find(const uint8_t addr) {
+    for(I2cSlave *slave : _slaves) {
+        if(slave->attached && (slave->addr == addr) && !slave->core->held()) {
+            return slave;
+        }
+    }
+    return nullptr;
+}
+
+// Like the AVR Wire library, the handler gets the whole write at the stop
+void I2cBus::_deliver(I2cSlave &slave) {
+    Interrupt irq(*slave.core);
+    int len = std::min(static_cast<int>(_written.size()), g_wireBuffSize);
+    std::copy(_written.begin(), _written.begin() + len, slave.rx);
+    slave.rxLen = len;
+    slave.rxPos = 0;
+    if(slave.onReceive) {
+        slave.onReceive(len);
+    }
+    spend(g_twiIsrCost);
+}
@@ -0,0 +1,87 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The GPU's I2C bus: the RP2040's DW_apb_i2c block as master, reading from
+ *   and writing to AVR slaves
+ * - Addressing a slave to read runs its onRequest handler right then (on the
+ *   slave's clock), like the TWI interrupt does, and each byte read takes 9
+ *   bit times once the master has queued a read command for it
+ * - Bytes written are handed to the slave's onReceive handler at the stop
+ * - A slave that isn't there or is held in reset NAKs, which shows up as an
+ *   abort like on the real block
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+#include "Sim.hpp"
+
+namespace sim {
+    const int g_i2cFifoDepth = 16;
+    const int g_wireBuffSize = 32; // The AVR Wire library's
+
+    // Slave end, owned by the AVR
+    struct I2cSlave {
+        Core *core;
+        bool attached;
+        uint8_t addr;
+        void (*onRequest)(void);
+        void (*onReceive)(int);
+        uint8_t tx[g_wireBuffSize];
+        int txLen;
+        uint8_t rx[g_wireBuffSize];
+        int rxLen, rxPos;
+    };
+
+    struct I2cStats {
+        uint64_t transactions;
+        uint64_t bytes;
+        uint64_t naks;
+        Time busy;
+    };
+
+    class I2cBus {
+        public:
+            I2cBus(const uint32_t hz);
+
+            void reset(void); // Power on: no slaves, no stats
+
+            void attach(I2cSlave &slave);
+            void detach(I2cSlave &slave);
+
+            // Master registers
+            void setTarget(const uint8_t addr);
+            void setEnable(const uint32_t val);
+            void pushCommand(const uint32_t val);
+            uint32_t popData(void);
+            uint32_t txLevel(void);
+            uint32_t rxLevel(void);
+            bool aborted(void);
+            void clearAbort(void);
+            bool busy(void); // Mid transaction, or the stop isn't out yet
+
+            const std::map<uint8_t, I2cStats> &stats(void) const;
+
+        private:
+            Time _bitTime;
+            std::vector<I2cSlave *> _slaves;
+
+            bool _enabled, _active, _abort, _writing;
+            uint8_t _target;
+            Time _abortAt, _busFree, _lastDone;
+            std::vector<uint8_t> _data; // What the slave loaded up
+            std::deque<Time> _cmdDone; // Read commands not popped yet
+            std::deque<Time> _writeDone; // Write commands, until sent
+            std::vector<uint8_t> _written; // For the slave, at the stop
+            int _issued, _popped;
+            std::map<uint8_t, I2cStats> _stats;
+
+            I2cSlave *_find(const uint8_t addr);
+            void _deliver(I2cSlave &slave);
+    };
+
+    extern I2cBus g_i2c;
+}
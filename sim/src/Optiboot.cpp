@@ -0,0 +1,171 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the simulated bootloader
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Optiboot.hpp"
+
+using namespace sim;
+
+const uint32_t g_bootBaud = 115200;
+const Time g_watchdogTimeout = 1 * g_sec;
+const Time g_watchdogReset = 16 * g_ms;
+const Time g_pageWriteTime = 4500 * g_us; // Erase + write
+const Time g_pollCost = 2 * g_us;
+
+// STK500 bytes optiboot cares about
+const uint8_t g_inSync = 0x14, g_ok = 0x10, g_crcEop = 0x20;
+const uint8_t g_getParameter = 0x41, g_setDevice = 0x42;
+const uint8_t g_setDeviceExt = 0x45, g_loadAddress = 0x55;
+const uint8_t g_universal = 0x56, g_progPage = 0x64, g_readPage = 0x74;
+const uint8_t g_readSign = 0x75, g_leaveProgMode = 0x51;
+const uint8_t g_swMajor = 0x81, g_swMinor = 0x82;
+
+// Thrown to get out of the command loop the way the watchdog would
+struct WatchdogReset {
+    Time after;
+};
+
+static uint8_t getch(Avr &avr) {
+    Time deadline = now() + g_watchdogTimeout;
+    while(!avr.uart.available()) {
+        if(now() >= deadline) {
+            throw WatchdogReset { 0 };
+        }
+        spend(g_pollCost);
+    }
+    return avr.uart.read();
+}
+
+static void putch(Avr &avr, const uint8_t c) {
+    avr.uart.write(c);
+}
+
+static void getNch(Avr &avr, int count) {
+    while(count--) {
+        getch(avr);
+    }
+}
+
+// Every command ends in CRC_EOP; anything else makes optiboot give up
+static void verifySpace(Avr &avr) {
+    if(getch(avr) != g_crcEop) {
+        throw WatchdogReset { g_watchdogReset };
+    }
+    putch(avr, g_inSync);
+}
+
+void sim::optiboot(Avr &avr) {
+    avr.uart.begin(g_bootBaud);
+
+    uint32_t address = 0;
+    uint8_t page[256];
+    int pages = 0;
+    bool synced = false;
+    try {
+        while(true) {
+            uint8_t cmd = getch(avr);
+            if(cmd == g_getParameter) {
+                uint8_t which = getch(avr);
+                verifySpace(avr);
+                putch(
+                    avr, (which == g_swMajor) ? 8 : (which == g_swMinor) ? 0 : 3
+                );
+            } else if(cmd == g_setDevice) {
+                getNch(avr, 20);
+                verifySpace(avr);
+            } else if(cmd == g_setDeviceExt) {
+                getNch(avr, 5);
+                verifySpace(avr);
+            } else if(cmd == g_loadAddress) {
+                address = getch(avr);
+                address |= getch(avr) << 8;
+                address *= 2; // Words
+                verifySpace(avr);
+            } else if(cmd == g_universal) {
+                getNch(avr, 4);
+                verifySpace(avr);
+                putch(avr, 0x00);
+            } else if(cmd == g_progPage) {
+                int len = getch(avr) << 8;
+                len |= getch(avr);
+                getch(avr); // Memory type
+                for(int i = 0; i < len; i++) {
+                    page[i % sizeof(page)] = getch(avr);
+                }
+                verifySpace(avr);
+                spend(g_pageWriteTime);
+                for(int i = 0; i < len; i++) {
+                    avr.flash[(address + i) % g_avrFlashSize] =
+                        page[i % sizeof(page)];
+                }
+                pages++;
+            } else if(cmd == g_readPage) {
+                int len = getch(avr) << 8;
+                len |= getch(avr);
+                getch(avr);
+                verifySpace(avr);
+                for(int i = 0; i < len; i++) {
+                    putch(avr, avr.flash[(address + i) % g_avrFlashSize]);
+                }
+            } else if(cmd == g_readSign) {
+                verifySpace(avr);
+                putch(avr, 0x1E);
+                putch(avr, 0x95);
+                putch(avr, 0x0F);
+            } else if(cmd == g_leaveProgMode) {
+                verifySpace(avr);
+                putch(avr, g_ok);
+                event("bootloader: %d pages written, starting app", pages);
+                throw WatchdogReset { g_watchdogReset };
+            } else { // Get sync, enter program mode, ...
+                verifySpace(avr);
+                if(!synced) {
+                    synced = true;
+                    event("bootloader: in sync");
+                }
+            }
+            putch(avr, g_ok);
+        }
+    } catch(WatchdogReset &wdt) {
+        if(wdt.after == 0) {
+            event("bootloader: timed out, starting app");
+        }
+        // In steps, so a reset during the wait cuts it short at the right time
+        for(Time waited = 0; waited < wdt.after; waited += g_pollCost) {
+            spend(g_pollCost);
+        }
+    }
+    avr.uart.end();
+}
+
+static int hexByte(const uint8_t *hex) {
+    char digits[3] = { static_cast<char>(hex[0]), static_cast<char>(hex[1]) };
+    return strtol(digits, nullptr, 16);
+}
+
+std::vector<uint8_t> sim::parseHex(const std::vector<uint8_t> &hex) {
+    std::vector<uint8_t> image;
+    for(size_t i = 0; i + 11 <= hex.size(); ) {
+        if(hex[i] != ':') {
+            i++;
+            continue;
+        }
+        int len = hexByte(&hex[i + 1]);
+        int addr = (hexByte(&hex[i + 3]) << 8) | hexByte(&hex[i + 5]);
+        int type = hexByte(&hex[i + 7]);
+        if((type != 0) || (i + 11 + len * 2 > hex.size())) {
+            break;
+        }
+        if(image.size() < static_cast<size_t>(addr + len)) {
+            image.resize(addr + len, 0xFF);
+        }
+        for(int j = 0; j < len; j++) {
+            image[addr + j] = hexByte(&hex[i + 9 + j * 2]);
+        }
+        i += 11 + len * 2;
+    }
+    return image;
+}
@@ -0,0 +1,23 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Optiboot, as the logic MCU runs it after an external reset: STK500 over
+ *   its UART at 115200 into its flash
+ * - Answers and timing follow optiboot's source: page writes take ~4.5ms
+ *   after the in sync reply, leaving program mode or sending garbage starts
+ *   the app through a 16ms watchdog reset, and 1s without a byte starts it
+ *   too (which is all a reset with nothing to flash gets)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Avr.hpp"
+
+namespace sim {
+    void optiboot(Avr &avr); // Returns when it jumps to the app
+
+    // Bytes an Intel HEX file puts in flash, 0xFF where it doesn't
+    std::vector<uint8_t> parseHex(const std::vector<uint8_t> &hex);
+}
@@ -0,0 +1,558 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The Pico SDK, libdvi and libsprite stand-ins the GPU runs on
+ * - Calls are charged in RP2040 cycles at whatever clock the GPU set, so
+ *   overclocking for DVI speeds up drawing like it does on the real part
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include "Gpu.hpp"
+#include "I2cBus.hpp"
+
+extern "C" {
+    #include <pico/stdlib.h>
+    #include <hardware/i2c.h>
+    #include <dvi.h>
+    #include <sprite.h>
+    #include <common_dvi_pin_configs.h>
+}
+
+using namespace sim;
+
+const uint32_t g_bootClockKhz = 125000;
+const Time g_pllLockTime = 1 * g_ms;
+const int g_regCycles = 4; // An APB register access
+const int g_queueCycles = 40; // Spin lock, copy, unlock
+const int g_uartFifoDepth = 32;
+const int g_sioCycles = 1; // Interpolators are on the single cycle IO bus
+
+// CTRL_LANEx fields, as in the RP2040 datasheet
+const int g_interpShift = 0, g_interpMaskLsb = 5, g_interpMaskMsb = 10;
+const uint32_t g_interpAddRaw = 1u << 18;
+
+struct Dvi {
+    const dvi_timing *timing;
+    queue_t *valid, *free;
+    int width, height;
+    Time slot, framePeriod;
+    bool started;
+    Time start;
+    uint64_t nextSlot;
+    std::deque<std::pair<Time, void *>> showing; // (done at, line buffer)
+    std::deque<void *> freeLines;
+    Frame frame;
+    DviStats stats;
+    std::function<void(const Frame &)> onFrame;
+};
+
+// UART0's transmitter: bytes leave the FIFO one frame time apart
+struct Uart0 {
+    Time byteTime;
+    std::deque<Time> fifo; // When each byte in it will be sent
+    std::vector<uint8_t> sent;
+};
+
+// The simulator exports its symbols for the firmware, so its own globals
+// are static or the GPU's (g_dvi, say) would bind to them instead
+static uint32_t g_clockKhz = g_bootClockKhz;
+static Dvi g_dvi {};
+static Uart0 g_uart0 {};
+static watchdog_hw_t g_watchdog {};
+static bool g_watchdogReboot = false;
+
+static void cycles(const uint64_t n) {
+    spend(n * 1000000 / g_clockKhz);
+}
+
+void sim::resetGpu(void) {
+    g_clockKhz = g_bootClockKhz;
+    std::function<void(const Frame &)> callback = g_dvi.onFrame;
+    g_dvi = Dvi {};
+    g_dvi.onFrame = callback;
+    g_uart0 = Uart0 {};
+    g_watchdog = watchdog_hw_t {};
+    g_watchdogReboot = false;
+}
+
+// Scanout starts over from the top of a frame, but frames keep counting and
+// what already went out of UART0 stays captured
+void sim::rebootGpu(void) {
+    g_clockKhz = g_bootClockKhz;
+    std::function<void(const Frame &)> callback = g_dvi.onFrame;
+    DviStats stats = g_dvi.stats;
+    g_dvi = Dvi {};
+    g_dvi.onFrame = callback;
+    g_dvi.stats.frames = stats.frames;
+    g_dvi.stats.lateLines = stats.lateLines;
+    g_uart0.byteTime = 0;
+    g_uart0.fifo.clear();
+    g_i2c.setEnable(0);
+    g_watchdogReboot = true;
+}
+
+void sim::onFrame(std::function<void(const Frame &)> callback) {
+    g_dvi.onFrame = callback;
+}
+
+const DviStats &sim::dviStats(void) {
+    return g_dvi.stats;
+}
+
+uint32_t sim::gpuClockKhz(void) {
+    return g_clockKhz;
+}
+
+const std::vector<uint8_t> &sim::gpuUartOutput(void) {
+    return g_uart0.sent;
+}
+
+// When scan line slot n of the run starts
+static Time slotTime(const uint64_t n) {
+    return g_dvi.start + (n / g_dvi.height) * g_dvi.framePeriod
+        + (n % g_dvi.height) * g_dvi.slot;
+}
+
+static void scanOut(void *line) {
+    Time at = now();
+    if(!g_dvi.started) {
+        g_dvi.started = true;
+        g_dvi.start = at + g_dvi.slot; // The first line is encoded first
+    }
+    while(slotTime(g_dvi.nextSlot) < at) {
+        g_dvi.nextSlot++;
+        g_dvi.stats.lateLines++;
+    }
+    Time due = slotTime(g_dvi.nextSlot++);
+    g_dvi.showing.push_back(std::make_pair(due + g_dvi.slot, line));
+
+    Frame &frame = g_dvi.frame;
+    int row = g_dvi.stats.lines++ % g_dvi.height;
+    memcpy(
+        &frame.pixels[row * frame.width], line, frame.width * sizeof(uint16_t)
+    );
+    if(row == g_dvi.height - 1) {
+        frame.index = g_dvi.stats.frames++;
+        if(g_dvi.onFrame) {
+            g_dvi.onFrame(frame);
+        }
+    }
+}
+
+// Lines that have been shown go back on the free queue
+static void retireLines(void) {
+    Time at = now();
+    while(!g_dvi.showing.empty() && (g_dvi.showing.front().first <= at)) {
+        g_dvi.freeLines.push_back(g_dvi.showing.front().second);
+        g_dvi.showing.pop_front();
+    }
+}
+
+extern "C" {
+
+// Time, clocks, power and pins
+
+uint32_t time_us_32(void) {
+    cycles(g_regCycles);
+    return now() / g_us;
+}
+
+uint64_t time_us_64(void) {
+    cycles(2 * g_regCycles);
+    return now() / g_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    spend(ms * g_ms);
+}
+
+void sleep_us(uint64_t us) {
+    spend(us * g_us);
+}
+
+void busy_wait_us_32(uint32_t us) {
+    spend(us * g_us);
+}
+
+bool set_sys_clock_khz(uint32_t khz, bool required) {
+    spend(g_pllLockTime);
+    g_clockKhz = khz;
+    return true;
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+void setup_default_uart(void) {
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage) {
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    cycles(g_regCycles);
+}
+
+void gpio_pull_up(uint gpio) {
+    cycles(g_regCycles);
+}
+
+void gpio_init(uint gpio) {
+    cycles(g_regCycles);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    cycles(g_regCycles);
+}
+
+void gpio_put(uint gpio, bool value) {
+    cycles(g_regCycles);
+}
+
+bool gpio_get(uint gpio) {
+    cycles(g_regCycles);
+    return false;
+}
+
+// Cores and queues. Core 1 only runs libdvi, which scanOut() stands in for
+
+void multicore_launch_core1(void (*entry)(void)) {
+}
+
+void __wfe(void) {
+    cycles(1);
+}
+
+void __sev(void) {
+}
+
+uint next_striped_spin_lock_num(void) {
+    return 0;
+}
+
+bool queue_is_empty(queue_t *q) {
+    if(q == g_dvi.free) {
+        retireLines();
+        return g_dvi.freeLines.empty();
+    }
+    return false;
+}
+
+bool queue_try_add(queue_t *q, const void *data) {
+    cycles(g_queueCycles);
+    void *line = *static_cast<void *const *>(data);
+    if(q == g_dvi.free) {
+        g_dvi.freeLines.push_back(line);
+    } else if(q == g_dvi.valid) {
+        scanOut(line);
+    }
+    return true;
+}
+
+void queue_add_blocking(queue_t *q, const void *data) {
+    queue_try_add(q, data);
+}
+
+bool queue_try_remove(queue_t *q, void *data) {
+    cycles(g_queueCycles);
+    if(q != g_dvi.free) {
+        return false;
+    }
+    retireLines();
+    if(g_dvi.freeLines.empty()) {
+        return false;
+    }
+    *static_cast<void **>(data) = g_dvi.freeLines.front();
+    g_dvi.freeLines.pop_front();
+    return true;
+}
+
+void queue_remove_blocking(queue_t *q, void *data) {
+    while(!queue_try_remove(q, data)) {
+        if((q == g_dvi.free) && !g_dvi.showing.empty()) {
+            spendUntil(g_dvi.showing.front().first);
+        } else {
+            spend(1 * g_ms); // Nothing will ever come; don't spin for free
+        }
+    }
+}
+
+// I2C
+
+static i2c_hw_t g_i2c1Hw;
+i2c_inst_t i2c1_inst = { &g_i2c1Hw, false };
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    cycles(100 * g_regCycles);
+    return baudrate;
+}
+
+uint32_t sim_i2c_read(int reg) {
+    cycles(g_regCycles);
+    switch(reg) {
+        case SIM_I2C_DATA_CMD:
+            return g_i2c.popData();
+        case SIM_I2C_RAW_INTR_STAT:
+            return g_i2c.aborted() ? I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS : 0;
+        case SIM_I2C_CLR_TX_ABRT:
+            g_i2c.clearAbort();
+            return 0;
+        case SIM_I2C_STATUS:
+            return g_i2c.busy() ? I2C_IC_STATUS_ACTIVITY_BITS : 0;
+        case SIM_I2C_TXFLR:
+            return g_i2c.txLevel();
+        case SIM_I2C_RXFLR:
+            return g_i2c.rxLevel();
+        default:
+            return 0;
+    }
+}
+
+void sim_i2c_write(int reg, uint32_t val) {
+    cycles(g_regCycles);
+    switch(reg) {
+        case SIM_I2C_TAR:
+            g_i2c.setTarget(val & 0x7F);
+            break;
+        case SIM_I2C_ENABLE:
+            g_i2c.setEnable(val);
+            break;
+        case SIM_I2C_DATA_CMD:
+            g_i2c.pushCommand(val);
+            break;
+        default:
+            break;
+    }
+}
+
+// Watchdog
+
+watchdog_hw_t *const watchdog_hw = &g_watchdog;
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    cycles(4 * g_regCycles);
+    spend(delay_ms * g_ms);
+    throw Reset {};
+}
+
+bool watchdog_caused_reboot(void) {
+    cycles(g_regCycles);
+    return g_watchdogReboot;
+}
+
+// UART
+
+uart_inst_t uart0_inst = { 0 };
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    cycles(50 * g_regCycles);
+    return uart_set_baudrate(uart, baudrate);
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate) {
+    cycles(4 * g_regCycles);
+    g_uart0.byteTime = 10 * g_sec / baudrate;
+    return baudrate;
+}
+
+bool uart_is_writable(uart_inst_t *uart) {
+    cycles(g_regCycles);
+    Time at = now();
+    while(!g_uart0.fifo.empty() && (g_uart0.fifo.front() <= at)) {
+        g_uart0.fifo.pop_front();
+    }
+    return g_uart0.fifo.size() < static_cast<size_t>(g_uartFifoDepth);
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c) {
+    if(!g_uart0.byteTime) {
+        return; // Never set up
+    }
+    while(!uart_is_writable(uart)) {
+        spend(g_uart0.byteTime);
+    }
+    Time start = std::max(
+        now(), g_uart0.fifo.empty() ? 0 : g_uart0.fifo.back()
+    );
+    g_uart0.fifo.push_back(start + g_uart0.byteTime);
+    g_uart0.sent.push_back(c);
+}
+
+// Interpolators
+
+interp_hw_t interp0_inst = {}, interp1_inst = {};
+
+interp_config interp_default_config(void) {
+    return interp_config { 31u << g_interpMaskMsb };
+}
+
+void interp_config_set_shift(interp_config *c, uint shift) {
+    c->ctrl = (c->ctrl & ~(0x1Fu << g_interpShift)) | (shift << g_interpShift);
+}
+
+void interp_config_set_mask(interp_config *c, uint mask_lsb, uint mask_msb) {
+    c->ctrl = (c->ctrl & ~((0x1Fu << g_interpMaskLsb)
+            | (0x1Fu << g_interpMaskMsb)))
+        | (mask_lsb << g_interpMaskLsb) | (mask_msb << g_interpMaskMsb);
+}
+
+void interp_config_set_add_raw(interp_config *c, bool add_raw) {
+    c->ctrl &= ~g_interpAddRaw;
+    if(add_raw) {
+        c->ctrl |= g_interpAddRaw;
+    }
+}
+
+void interp_set_config(interp_hw_t *interp, uint lane, interp_config *config) {
+    cycles(g_sioCycles);
+    interp->ctrl[lane] = config->ctrl;
+}
+
+void interp_set_base(interp_hw_t *interp, uint lane, uint32_t val) {
+    cycles(g_sioCycles);
+    interp->base[lane] = val;
+}
+
+void interp_set_accumulator(interp_hw_t *interp, uint lane, uint32_t val) {
+    cycles(g_sioCycles);
+    interp->accum[lane] = val;
+}
+
+uint32_t interp_get_accumulator(interp_hw_t *interp, uint lane) {
+    cycles(g_sioCycles);
+    return interp->accum[lane];
+}
+
+// A lane's accumulator shifted right, then cut down to its mask's bits
+static uint32_t shiftMask(const interp_hw_t *interp, const int lane) {
+    uint32_t ctrl = interp->ctrl[lane];
+    uint32_t lsb = (ctrl >> g_interpMaskLsb) & 0x1F;
+    uint32_t msb = (ctrl >> g_interpMaskMsb) & 0x1F;
+    uint32_t mask = (msb >= lsb)
+        ? ((0xFFFFFFFFu >> (31 - msb)) & (0xFFFFFFFFu << lsb)) : 0;
+    return (interp->accum[lane] >> ((ctrl >> g_interpShift) & 0x1F)) & mask;
+}
+
+// The full result doesn't care about add raw, but what goes back into the
+// accumulators does
+uint32_t interp_pop_full_result(interp_hw_t *interp) {
+    cycles(g_sioCycles);
+    uint32_t lanes[2] = { shiftMask(interp, 0), shiftMask(interp, 1) };
+    uint32_t full = interp->base[2] + lanes[0] + lanes[1];
+    for(int i = 0; i < 2; i++) {
+        interp->accum[i] = interp->base[i] + (
+            (interp->ctrl[i] & g_interpAddRaw) ? interp->accum[i] : lanes[i]
+        );
+    }
+    return full;
+}
+
+// libdvi
+
+const struct dvi_timing dvi_timing_640x480p_60hz = {
+    false, 16, 96, 48, 640, false, 10, 2, 33, 480, 252000
+};
+const struct dvi_timing dvi_timing_800x480p_60hz = {
+    true, 24, 72, 96, 800, true, 3, 10, 7, 480, 295200
+};
+const struct dvi_timing dvi_timing_800x600p_60hz = {
+    true, 40, 128, 88, 800, true, 1, 4, 23, 600, 400000
+};
+const struct dvi_timing dvi_timing_960x540p_60hz = {
+    true, 16, 32, 96, 960, true, 3, 6, 15, 540, 372000
+};
+const struct dvi_timing dvi_timing_1280x720p_30hz = {
+    true, 110, 40, 220, 1280, true, 5, 5, 20, 720, 372000
+};
+const struct dvi_serialiser_cfg sim_dvi_cfg = { { 0, 1, 2 } };
+
+void dvi_init(
+        struct dvi_inst *inst, uint spinlock_tmds_queue,
+        uint spinlock_colour_queue) {
+    const dvi_timing *t = inst->timing;
+    uint hTotal = t->h_front_porch + t->h_sync_width + t->h_back_porch
+        + t->h_active_pixels;
+    uint vTotal = t->v_front_porch + t->v_sync_width + t->v_back_porch
+        + t->v_active_lines;
+    Time line = static_cast<Time>(hTotal) * 10 * 1000000 / t->bit_clk_khz;
+
+    g_dvi.timing = t;
+    g_dvi.valid = &inst->q_colour_valid;
+    g_dvi.free = &inst->q_colour_free;
+    g_dvi.width = t->h_active_pixels / 2;
+    g_dvi.height = t->v_active_lines / DVI_VERTICAL_REPEAT;
+    g_dvi.slot = line * DVI_VERTICAL_REPEAT;
+    g_dvi.framePeriod = line * vTotal;
+    g_dvi.frame.width = g_dvi.width;
+    g_dvi.frame.height = g_dvi.height;
+    g_dvi.frame.pixels.assign(g_dvi.width * g_dvi.height, 0);
+    g_dvi.stats.linePeriod = g_dvi.slot;
+}
+
+void dvi_register_irqs_this_core(struct dvi_inst *inst, uint irq_num) {
+}
+
+void dvi_start(struct dvi_inst *inst) {
+}
+
+void dvi_scanbuf_main_16bpp(struct dvi_inst *inst) {
+}
+
+// libsprite (bit 5 is alpha in RGAB5515)
+
+void sprite_fill8(uint8_t *scanbuf, uint8_t colour, uint len) {
+    cycles(20 + len / 4);
+    memset(scanbuf, colour, len);
+}
+
+void sprite_fill16(uint16_t *scanbuf, uint16_t colour, uint len) {
+    cycles(20 + len / 2);
+    std::fill(scanbuf, scanbuf + len, colour);
+}
+
+void sprite_blit16(uint16_t *dst, const uint16_t *src, uint len) {
+    cycles(20 + len);
+    memcpy(dst, src, len * sizeof(uint16_t));
+}
+
+void sprite_blit16_alpha(uint16_t *dst, const uint16_t *src, uint len) {
+    cycles(20 + 2 * len);
+    for(uint i = 0; i < len; i++) {
+        if(src[i] & 0x20) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+void sprite_sprite16(
+        uint16_t *scanbuf, const sprite_t *sp, uint raster_y, uint raster_w) {
+    cycles(20);
+    int size = 1 << sp->log_size;
+    int ty = static_cast<int>(raster_y) - sp->y;
+    if((ty < 0) || (ty >= size)) {
+        return;
+    }
+    if(sp->vflip) {
+        ty = size - 1 - ty;
+    }
+    int start = std::max(0, static_cast<int>(sp->x));
+    int end = std::min(static_cast<int>(raster_w), sp->x + size);
+    if(end <= start) {
+        return;
+    }
+
+    const uint16_t *row = static_cast<const uint16_t *>(sp->img) + ty * size;
+    cycles(20 + 2 * (end - start));
+    for(int x = start; x < end; x++) {
+        int tx = x - sp->x;
+        uint16_t px = row[sp->hflip ? (size - 1 - tx) : tx];
+        if(px & 0x20) {
+            scanbuf[x] = px;
+        }
+    }
+}
+
+}
@@ -0,0 +1,425 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the simulated SD card and the SD library
+ */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include "SdCard.hpp"
+#include <SD.h>
+
+using namespace sim;
+
+const int g_entriesPerBlock = 16; // 32 byte FAT directory entries
+const Time g_sdInitTime = 30 * g_ms;
+
+SdCard sim::g_card;
+SDClass SD;
+
+std::string sim::shortName(const char *path) {
+    while(*path == '/') {
+        path++;
+    }
+    std::string name;
+    for(; *path; path++) {
+        name += toupper(*path);
+    }
+    return name;
+}
+
+// 1-8 character name, optionally a dot and a 1-3 character extension
+static bool isShortName(const std::string &name) {
+    size_t dot = name.find('.');
+    if(dot == std::string::npos) {
+        return !name.empty() && (name.size() <= 8);
+    }
+    return (dot > 0) && (dot <= 8) && (name.size() - dot - 1 <= 3)
+        && (name.size() - dot - 1 > 0);
+}
+
+SdCard::SdCard(void) :
+        _cachedFile(nullptr), _cachedBlock(0),
+        _cacheValid(false), _cachedDir(false), _cacheDirty(false), _stats {} {
+}
+
+void SdCard::clear(void) {
+    _files.clear();
+    _cacheValid = _cacheDirty = false;
+}
+
+bool SdCard::load(const std::string &dir) {
+    DIR *folder = opendir(dir.c_str());
+    if(!folder) {
+        return false;
+    }
+    std::vector<std::string> names;
+    while(dirent *ent = readdir(folder)) {
+        names.push_back(ent->d_name);
+    }
+    closedir(folder);
+
+    for(const std::string &name : names) {
+        std::string path = dir + "/" + name;
+        struct stat info;
+        if((stat(path.c_str(), &info) != 0) || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        std::string card = shortName(name.c_str());
+        if(!isShortName(card)) {
+            fprintf(stderr, "Skipping %s: not an 8.3 name\n", name.c_str());
+            continue;
+        }
+        FILE *f = fopen(path.c_str(), "rb");
+        if(!f) {
+            return false;
+        }
+        std::vector<uint8_t> data(info.st_size);
+        size_t got = fread(data.data(), 1, data.size(), f);
+        fclose(f);
+        if(got != data.size()) {
+            return false;
+        }
+        put(card, data);
+    }
+    return true;
+}
+
+bool SdCard::save(const std::string &dir) const {
+    mkdir(dir.c_str(), 0755);
+    for(const auto &file : _files) {
+        FILE *f = fopen((dir + "/" + file->name).c_str(), "wb");
+        if(!f) {
+            return false;
+        }
+        fwrite(file->data.data(), 1, file->data.size(), f);
+        fclose(f);
+    }
+    return true;
+}
+
+void SdCard::put(const std::string &name, const std::vector<uint8_t> &data) {
+    CardFile *file = find(name.c_str());
+    if(!file) {
+        _files.emplace_back(new CardFile { shortName(name.c_str()), {} });
+        file = _files.back().get();
+    }
+    file->data = data;
+}
+
+CardFile *SdCard::find(const char *path) {
+    std::string name = shortName(path);
+    for(auto &file : _files) {
+        if(file->name == name) {
+            return file.get();
+        }
+    }
+    return nullptr;
+}
+
+CardFile *SdCard::create(const char *path) {
+    std::string name = shortName(path);
+    if(!isShortName(name)) {
+        return nullptr;
+    }
+    _files.emplace_back(new CardFile { name, {} });
+    return _files.back().get();
+}
+
+bool SdCard::remove(const char *path) {
+    CardFile *file = find(path);
+    if(!file) {
+        return false;
+    }
+    touchEntry(file, true);
+    if(_cachedFile == file) {
+        _cacheValid = _cacheDirty = false;
+    }
+    _files.erase(_files.begin() + indexOf(file));
+    return true;
+}
+
+CardFile *SdCard::entry(const size_t index) {
+    return (index < _files.size()) ? _files[index].get() : nullptr;
+}
+
+int SdCard::indexOf(const CardFile *file) const {
+    for(size_t i = 0; i < _files.size(); i++) {
+        if(_files[i].get() == file) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SdCard::touch(const CardFile *file, const uint32_t block, bool dirty) {
+    _load(file, false, block, dirty);
+}
+
+// The block of the directory holding a file's entry
+void SdCard::touchEntry(const CardFile *file, const bool dirty) {
+    int index = file ? indexOf(file) : static_cast<int>(_files.size());
+    _load(nullptr, true, index / g_entriesPerBlock, dirty);
+}
+
+void SdCard::writeBack(void) {
+    if(_cacheValid && _cacheDirty) {
+        spend(g_sdBlockWrite);
+        _stats.blockWrites++;
+        _stats.busy += g_sdBlockWrite;
+        _cacheDirty = false;
+    }
+}
+
+const SdStats &SdCard::stats(void) const {
+    return _stats;
+}
+
+void SdCard::clearStats(void) {
+    _stats = SdStats {};
+}
+
+void SdCard::_load(
+        const CardFile *file, const bool dir, const uint32_t block,
+        const bool dirty) {
+    bool hit = _cacheValid && (_cachedDir == dir) && (_cachedFile == file)
+        && (_cachedBlock == block);
+    if(!hit) {
+        writeBack();
+        spend(g_sdBlockRead);
+        _stats.blockReads++;
+        _stats.busy += g_sdBlockRead;
+        _cacheValid = true;
+        _cachedDir = dir;
+        _cachedFile = file;
+        _cachedBlock = block;
+    }
+    _cacheDirty |= dirty;
+}
+
+// File
+
+static FileHandle *openHandle(CardFile *file, const uint8_t mode) {
+    FileHandle *handle = new FileHandle {};
+    handle->refs = 1;
+    handle->file = file;
+    handle->open = true;
+    handle->mode = mode;
+    snprintf(
+        handle->name, sizeof(handle->name), "%s",
+        file ? file->name.c_str() : "/"
+    );
+    return handle;
+}
+
+File::File(void) : _handle(nullptr) {
+}
+
+File::File(FileHandle *handle) : _handle(handle) {
+}
+
+File::File(const File &other) : _handle(other._handle) {
+    if(_handle) {
+        _handle->refs++;
+    }
+}
+
+File &File::operator=(const File &other) {
+    if(other._handle) {
+        other._handle->refs++;
+    }
+    if(_handle && (--_handle->refs == 0)) {
+        delete _handle;
+    }
+    _handle = other._handle;
+    return *this;
+}
+
+File::~File(void) {
+    if(_handle && (--_handle->refs == 0)) {
+        delete _handle;
+    }
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buff, size_t len) {
+    spend(g_sdCallCost);
+    if(!*this || !_handle->file || !(_handle->mode & O_WRITE)) {
+        return 0;
+    }
+    std::vector<uint8_t> &data = _handle->file->data;
+    if(_handle->mode & O_APPEND) {
+        _handle->pos = data.size();
+    }
+    for(size_t i = 0; i < len; ) {
+        uint32_t pos = _handle->pos;
+        size_t n = min(len - i, g_sdBlockSize - (pos % g_sdBlockSize));
+        g_card.touch(_handle->file, pos / g_sdBlockSize, true);
+        if(pos + n > data.size()) {
+            data.resize(pos + n);
+        }
+        memcpy(&data[pos], &buff[i], n);
+        spend(n * g_sdByteCost);
+        _handle->pos += n;
+        i += n;
+    }
+    return len;
+}
+
+int File::read(void) {
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+}
+
+int File::read(void *buff, uint16_t len) {
+    spend(g_sdCallCost);
+    if(!*this || !_handle->file) {
+        return -1;
+    }
+    const std::vector<uint8_t> &data = _handle->file->data;
+    uint16_t got = 0;
+    while((got < len) && (_handle->pos < data.size())) {
+        uint32_t pos = _handle->pos;
+        size_t n = min(
+            min(static_cast<size_t>(len - got), data.size() - pos),
+            static_cast<size_t>(g_sdBlockSize - (pos % g_sdBlockSize))
+        );
+        g_card.touch(_handle->file, pos / g_sdBlockSize, false);
+        memcpy(static_cast<uint8_t *>(buff) + got, &data[pos], n);
+        spend(n * g_sdByteCost);
+        _handle->pos += n;
+        got += n;
+    }
+    return got;
+}
+
+int File::peek(void) {
+    uint32_t pos = position();
+    int c = read();
+    seek(pos);
+    return c;
+}
+
+int File::available(void) {
+    spend(g_sdCallCost);
+    if(!*this || !_handle->file) {
+        return 0;
+    }
+    uint32_t left = _handle->file->data.size() - _handle->pos;
+    return min(left, static_cast<uint32_t>(0x7FFF));
+}
+
+// Writes back the cached block and the file's directory entry (its size)
+void File::flush(void) {
+    if(!*this || !_handle->file || !(_handle->mode & O_WRITE)) {
+        return;
+    }
+    g_card.writeBack();
+    g_card.touchEntry(_handle->file, true);
+    g_card.writeBack();
+}
+
+bool File::seek(uint32_t pos) {
+    spend(g_sdCallCost);
+    if(!*this || !_handle->file || (pos > _handle->file->data.size())) {
+        return false;
+    }
+    _handle->pos = pos;
+    return true;
+}
+
+uint32_t File::position(void) {
+    return *this ? _handle->pos : 0;
+}
+
+uint32_t File::size(void) {
+    return (*this && _handle->file) ? _handle->file->data.size() : 0;
+}
+
+void File::close(void) {
+    if(*this) {
+        flush();
+        _handle->open = false;
+    }
+}
+
+File::operator bool(void) {
+    return _handle && _handle->open;
+}
+
+char *File::name(void) {
+    return _handle ? _handle->name : nullptr;
+}
+
+bool File::isDirectory(void) {
+    return *this && !_handle->file;
+}
+
+File File::openNextFile(uint8_t mode) {
+    if(!isDirectory()) {
+        return File();
+    }
+    CardFile *file = g_card.entry(_handle->dirNext);
+    g_card.touchEntry(file, false);
+    if(!file) {
+        return File();
+    }
+    _handle->dirNext++;
+    return File(openHandle(file, mode));
+}
+
+void File::rewindDirectory(void) {
+    if(isDirectory()) {
+        _handle->dirNext = 0;
+    }
+}
+
+// SD
+
+bool SDClass::begin(uint8_t chipSelect) {
+    spend(g_sdInitTime);
+    return true;
+}
+
+File SDClass::open(const char *path, uint8_t mode) {
+    spend(g_sdCallCost);
+    if(shortName(path).empty()) {
+        g_card.touchEntry(g_card.entry(0), false);
+        return File(openHandle(nullptr, O_READ));
+    }
+
+    CardFile *file = g_card.find(path);
+    g_card.touchEntry(file, false);
+    if(!file) {
+        if(!(mode & O_CREAT) || !(file = g_card.create(path))) {
+            return File();
+        }
+        g_card.touchEntry(file, true);
+    }
+    if((mode & O_TRUNC) && (mode & O_WRITE)) {
+        file->data.clear();
+        g_card.touchEntry(file, true);
+    }
+
+    File opened(openHandle(file, mode));
+    if(mode & O_APPEND) {
+        opened.seek(file->data.size());
+    }
+    return opened;
+}
+
+bool SDClass::exists(const char *path) {
+    spend(g_sdCallCost);
+    CardFile *file = g_card.find(path);
+    g_card.touchEntry(file, false);
+    return file != nullptr;
+}
+
+bool SDClass::remove(const char *path) {
+    spend(g_sdCallCost);
+    return g_card.remove(path);
+}
@@ -0,0 +1,85 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - The programmer's SD card: a flat FAT root directory of 8.3 files, held
+ *   in memory, behind the SD library stand-in (File, SD)
+ * - Timing follows the SD library: it caches a single 512 byte block, so
+ *   touching any other block (file data or directory entries) reads it from
+ *   the card first, writing the cached one back if it was changed
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Sim.hpp"
+
+namespace sim {
+    const int g_sdBlockSize = 512;
+    const Time g_sdBlockRead = 1500 * g_us; // Command + 512 bytes at 4MHz SPI
+    const Time g_sdBlockWrite = 2500 * g_us; // Same, plus the card's busy time
+    const Time g_sdCallCost = 3 * g_us; // Overhead of any File call
+    const Time g_sdByteCost = 250; // Copying out of/into the cache, per byte
+
+    struct CardFile {
+        std::string name; // Upper case 8.3
+        std::vector<uint8_t> data;
+    };
+
+    // An open file or the root directory, shared by copies of a File
+    struct FileHandle {
+        int refs;
+        CardFile *file; // Null for the root directory
+        bool open;
+        uint8_t mode;
+        uint32_t pos;
+        size_t dirNext; // Next entry openNextFile() gives out
+        char name[13];
+    };
+
+    struct SdStats {
+        uint64_t blockReads, blockWrites;
+        Time busy;
+    };
+
+    class SdCard {
+        public:
+            SdCard(void);
+
+            void clear(void);
+            bool load(const std::string &dir); // Every file in a host folder
+            bool save(const std::string &dir) const; // Write them back out
+            void put(const std::string &name, const std::vector<uint8_t> &data);
+
+            CardFile *find(const char *path);
+            CardFile *create(const char *path);
+            bool remove(const char *path);
+            CardFile *entry(const size_t index);
+            int indexOf(const CardFile *file) const;
+
+            void touch(const CardFile *file, const uint32_t block, bool dirty);
+            void touchEntry(const CardFile *file, const bool dirty);
+            void writeBack(void);
+
+            const SdStats &stats(void) const;
+            void clearStats(void);
+
+        private:
+            std::vector<std::unique_ptr<CardFile>> _files; // Directory order
+            const CardFile *_cachedFile; // Null with _cachedDir for directory
+            uint32_t _cachedBlock;
+            bool _cacheValid, _cachedDir, _cacheDirty;
+            SdStats _stats;
+
+            void _load(
+                const CardFile *file, const bool dir, const uint32_t block,
+                const bool dirty
+            );
+    };
+
+    std::string shortName(const char *path); // Upper case, no leading '/'
+
+    extern SdCard g_card;
+}
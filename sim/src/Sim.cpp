@@ -0,0 +1,256 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of simulated time and the core scheduler
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <mutex>
+#include "Sim.hpp"
+
+using namespace sim;
+
+// How far a core may run ahead of the slowest before handing over
+const Time g_quantum = 20 * g_us;
+const Time g_checkInterval = 50 * g_us; // For the limit, done() and samplers
+
+struct Sampler {
+    Time period, next;
+    std::function<void(Time)> callback;
+};
+
+static std::mutex g_lock;
+static std::vector<Core *> g_cores;
+static Core *g_running = nullptr;
+static bool g_stopping = false;
+static Time g_limit = 0, g_nextCheck = 0;
+static std::function<bool(void)> g_done;
+static std::vector<Sampler> g_samplers;
+static thread_local Core *t_core = nullptr;
+
+static std::vector<Event> g_events;
+static bool g_echo = false;
+
+Core::Core(const std::string &name, CoreBody body) :
+        board(nullptr), _name(name), _body(body), _now(0), _isrDepth(0),
+        _finished(false), _held(false), _resetPending(false), _releasedAt(0) {
+}
+
+Core::~Core(void) {
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+const std::string &Core::name(void) const {
+    return _name;
+}
+
+Time Core::now(void) const {
+    return _now;
+}
+
+void Core::hold(const bool held) {
+    if(held && !_held) {
+        _resetPending = true;
+        if(onReset) {
+            onReset();
+        }
+    } else if(!held && _held) {
+        _releasedAt = sim::now();
+    }
+    _held = held;
+}
+
+bool Core::held(void) const {
+    return _held;
+}
+
+void Core::waitForRelease(void) {
+    _resetPending = false;
+    while(_held) {
+        spend(10 * g_us);
+        _resetPending = false;
+    }
+    spendUntil(_releasedAt);
+}
+
+void Core::_main(void) {
+    t_core = this;
+    {
+        std::unique_lock<std::mutex> lock(g_lock);
+        _wake.wait(lock, [this] { return (g_running == this) || g_stopping; });
+    }
+    try {
+        if(!g_stopping) {
+            _body(*this);
+        }
+    } catch(Stop &) {
+    } catch(Reset &) {
+    }
+
+    std::unique_lock<std::mutex> lock(g_lock);
+    _finished = true;
+    if((g_running == this) && !g_stopping) {
+        Core *next = nullptr;
+        for(Core *core : g_cores) {
+            if(!core->_finished && (!next || (core->_now < next->_now))) {
+                next = core;
+            }
+        }
+        g_running = next;
+        if(next) {
+            next->_wake.notify_one();
+        }
+    }
+}
+
+Interrupt::Interrupt(Core &core) : _prev(t_core) {
+    t_core = &core;
+    core._isrDepth++;
+}
+
+Interrupt::~Interrupt(void) {
+    t_core->_isrDepth--;
+    t_core = _prev;
+}
+
+void Scheduler::run(
+        std::vector<Core *> &cores, const Time limit,
+        std::function<bool(void)> done) {
+    g_cores = cores;
+    g_stopping = false;
+    g_limit = limit;
+    g_nextCheck = 0;
+    g_done = done;
+    g_running = cores.front();
+    for(Core *core : cores) {
+        core->_thread = std::thread(&Core::_main, core);
+    }
+    for(Core *core : cores) {
+        core->_thread.join();
+    }
+    g_cores.clear();
+    g_samplers.clear();
+    g_done = nullptr;
+}
+
+void Scheduler::every(const Time period, std::function<void(Time)> callback) {
+    g_samplers.push_back(Sampler { period, period, callback });
+}
+
+void Scheduler::stop(void) {
+    std::unique_lock<std::mutex> lock(g_lock);
+    g_stopping = true;
+    for(Core *core : g_cores) {
+        core->_wake.notify_one();
+    }
+}
+
+Time Scheduler::slowest(void) {
+    Time slow = UINT64_MAX;
+    for(Core *core : g_cores) {
+        if(!core->_finished && (core->_now < slow)) {
+            slow = core->_now;
+        }
+    }
+    return slow;
+}
+
+void Scheduler::checkpoint(Core &core) {
+    if(g_stopping) {
+        throw Stop();
+    }
+    if(core._resetPending) {
+        core._resetPending = false;
+        throw Reset();
+    }
+
+    Core *next = &core;
+    for(Core *other : g_cores) {
+        if(!other->_finished && (other->_now < next->_now)) {
+            next = other;
+        }
+    }
+
+    Time slow = next->_now;
+    if(slow >= g_nextCheck) {
+        g_nextCheck = slow + g_checkInterval;
+        for(Sampler &sampler : g_samplers) {
+            while(slow >= sampler.next) {
+                sampler.callback(sampler.next);
+                sampler.next += sampler.period;
+            }
+        }
+        if((slow >= g_limit) || (g_done && g_done())) {
+            stop();
+            throw Stop();
+        }
+    }
+
+    if((next != &core) && (core._now >= next->_now + g_quantum)) {
+        _handOver(core, next);
+    }
+}
+
+void Scheduler::_handOver(Core &from, Core *to) {
+    std::unique_lock<std::mutex> lock(g_lock);
+    g_running = to;
+    to->_wake.notify_one();
+    from._wake.wait(
+        lock, [&from] { return (g_running == &from) || g_stopping; }
+    );
+    if(g_stopping) {
+        throw Stop();
+    }
+}
+
+Core &sim::current(void) {
+    return *t_core;
+}
+
+Time sim::now(void) {
+    return t_core ? t_core->now() : 0;
+}
+
+void sim::spend(const Time t) {
+    Core &core = *t_core;
+    core._now += t;
+    if(core._isrDepth == 0) {
+        Scheduler::checkpoint(core);
+    }
+}
+
+void sim::spendUntil(const Time t) {
+    Time at = now();
+    spend((t > at) ? (t - at) : 0);
+}
+
+void sim::event(const char *fmt, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    Event ev { now(), t_core ? t_core->name() : std::string("sim"), text };
+    if(g_echo) {
+        printf(
+            "[%10.3f ms] %-6s %s\n",
+            ev.time / static_cast<double>(g_ms), ev.core.c_str(), text
+        );
+    }
+    g_events.push_back(ev);
+}
+
+const std::vector<Event> &sim::events(void) {
+    return g_events;
+}
+
+void sim::clearEvents(void) {
+    g_events.clear();
+}
+
+void sim::echoEvents(const bool echo) {
+    g_echo = echo;
+}
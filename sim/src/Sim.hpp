@@ -0,0 +1,117 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Simulated time and the cores that share it
+ * - Each MCU runs its real firmware on its own thread, but only one of them
+ *   runs at a time. Every core keeps its own clock, which the stand-ins for
+ *   Serial, Wire, SD, i2c_* etc. advance by what the call costs on the real
+ *   part. Once a core gets a quantum ahead of the core furthest behind it
+ *   hands over, so the cores never drift far enough apart for their links to
+ *   see things out of order
+ * - Code run on behalf of another core (an I2C slave's onRequest handler,
+ *   run when the GPU addresses it) goes in an Interrupt scope
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim {
+    typedef uint64_t Time; // Nanoseconds since power on
+
+    const Time g_us = 1000;
+    const Time g_ms = 1000 * g_us;
+    const Time g_sec = 1000 * g_ms;
+
+    // Thrown into a core's firmware to unwind it
+    struct Stop {}; // The run is over
+    struct Reset {}; // Its reset line went low
+
+    class Core;
+    typedef std::function<void(Core &)> CoreBody;
+
+    class Core {
+        public:
+            Core(const std::string &name, CoreBody body);
+            ~Core(void);
+
+            const std::string &name(void) const;
+            Time now(void) const;
+
+            // Reset line, driven by another core
+            void hold(const bool held);
+            bool held(void) const;
+            void waitForRelease(void); // From the core's own thread
+
+            void *board; // State of its stand-ins (an Avr, ...)
+            std::function<void(int, int)> onPin; // (pin, level) on writes
+            std::function<void(void)> onReset; // Clear its peripherals
+
+        private:
+            friend class Scheduler;
+            friend class Interrupt;
+            friend void spend(const Time t);
+
+            std::string _name;
+            CoreBody _body;
+            std::thread _thread;
+            std::condition_variable _wake;
+            Time _now;
+            int _isrDepth;
+            bool _finished;
+            bool _held, _resetPending;
+            Time _releasedAt;
+
+            void _main(void);
+    };
+
+    // Runs code as if on another core (its clock, its peripherals)
+    class Interrupt {
+        public:
+            Interrupt(Core &core);
+            ~Interrupt(void);
+
+        private:
+            Core *_prev;
+    };
+
+    // Runs cores until the limit or until done() says so
+    class Scheduler {
+        public:
+            static void run(
+                std::vector<Core *> &cores, const Time limit,
+                std::function<bool(void)> done
+            );
+            static void every( // Called as simulated time passes each period
+                const Time period, std::function<void(Time)> callback
+            );
+            static void stop(void);
+            static void checkpoint(Core &core);
+            static Time slowest(void);
+
+        private:
+            static void _handOver(Core &from, Core *to);
+    };
+
+    Core &current(void);
+    Time now(void); // Current core's clock
+    void spend(const Time t); // Advance the current core
+    void spendUntil(const Time t);
+
+    // Timestamped events, kept for the report and the --trace CSV
+    struct Event {
+        Time time;
+        std::string core;
+        std::string text;
+    };
+
+    void event(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+    const std::vector<Event> &events(void);
+    void clearEvents(void);
+    void echoEvents(const bool echo);
+}
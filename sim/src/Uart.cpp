@@ -0,0 +1,148 @@
+/*
+ * Author: Dylan Turner
+ * Description: Implementation of the simulated serial line
+ */
+
+#include <algorithm>
+#include "Uart.hpp"
+
+using namespace sim;
+
+const int g_bitsPerByte = 10; // Start, 8 data, stop
+
+Uart::Uart(const std::string &name) :
+        _name(name), _peer(nullptr), _baud(0), _enabled(false), _lineFree(0),
+        _stats {} {
+}
+
+void Uart::connect(Uart &a, Uart &b) {
+    a._peer = &b;
+    b._peer = &a;
+}
+
+void Uart::begin(const uint32_t baud) {
+    _receive();
+    _baud = baud;
+    _enabled = true;
+}
+
+void Uart::end(void) {
+    _receive();
+    _enabled = false;
+}
+
+void Uart::reset(void) {
+    Time at = now();
+    _enabled = false;
+    _rx.clear();
+    _txDone.clear();
+    _lineFree = at;
+
+    // Whatever hadn't made it onto the line yet never will
+    if(_peer) {
+        auto &line = _peer->_incoming;
+        line.erase(
+            std::remove_if(
+                line.begin(), line.end(),
+                [at](const LineByte &b) { return b.arrival > at; }
+            ),
+            line.end()
+        );
+    }
+}
+
+int Uart::available(void) {
+    _receive();
+    return _rx.size();
+}
+
+int Uart::read(void) {
+    _receive();
+    if(_rx.empty()) {
+        return -1;
+    }
+    uint8_t c = _rx.front();
+    _rx.pop_front();
+    return c;
+}
+
+int Uart::peek(void) {
+    _receive();
+    return _rx.empty() ? -1 : _rx.front();
+}
+
+int Uart::availableForWrite(void) {
+    _pruneTx();
+    return std::max(0, g_uartTxSize - static_cast<int>(_txDone.size()));
+}
+
+void Uart::write(const uint8_t c) {
+    if(!_enabled || !_peer) {
+        return;
+    }
+    _pruneTx();
+    while(static_cast<int>(_txDone.size()) >= g_uartTxSize) {
+        spendUntil(_txDone.front());
+        _pruneTx();
+    }
+
+    Time byteTime = g_bitsPerByte * g_sec / _baud;
+    Time done = std::max(now(), _lineFree) + byteTime;
+    _lineFree = done;
+    _txDone.push_back(done);
+    _peer->_incoming.push_back(LineByte { done, c, _baud });
+    _stats.bytes++;
+    _stats.busy += byteTime;
+}
+
+void Uart::flush(void) {
+    _pruneTx();
+    if(!_txDone.empty()) {
+        spendUntil(_txDone.back());
+        _txDone.clear();
+    }
+}
+
+const std::string &Uart::name(void) const {
+    return _name;
+}
+
+uint32_t Uart::baud(void) const {
+    return _baud;
+}
+
+const UartStats &Uart::stats(void) const {
+    return _stats;
+}
+
+// Move whatever has arrived by now into the receive buffer
+void Uart::_receive(void) {
+    Time at = now();
+    while(!_incoming.empty() && (_incoming.front().arrival <= at)) {
+        LineByte b = _incoming.front();
+        _incoming.pop_front();
+
+        if(!_enabled) {
+            _stats.lost++;
+            continue;
+        }
+        uint8_t data = b.data;
+        if(b.baud != _baud) {
+            _stats.garbled++;
+            data = ~data ^ static_cast<uint8_t>(b.baud >> 7);
+        }
+        if(static_cast<int>(_rx.size()) >= g_uartRxSize) {
+            _stats.overruns++;
+            continue;
+        }
+        _rx.push_back(data);
+        _stats.rxPeak = std::max(_stats.rxPeak, static_cast<int>(_rx.size()));
+    }
+}
+
+void Uart::_pruneTx(void) {
+    Time at = now();
+    while(!_txDone.empty() && (_txDone.front() <= at)) {
+        _txDone.pop_front();
+    }
+}
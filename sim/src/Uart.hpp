@@ -0,0 +1,71 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - A core's hardware UART, joined to another core's by a simulated line
+ * - Bytes take 10 bit times at the sender's baud rate to arrive, and land in
+ *   a 64 byte receive buffer (what the AVR core has) that drops on overrun.
+ *   The two ends disagreeing on the baud rate garbles the byte instead
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include "Sim.hpp"
+
+namespace sim {
+    const int g_uartRxSize = 63; // The AVR core's ring buffer, less one
+    const int g_uartTxSize = 63;
+
+    struct UartStats {
+        uint64_t bytes; // Sent
+        Time busy; // Line time spent sending them
+        uint64_t lost; // Arrived while the receiver was off or in reset
+        uint64_t overruns; // Arrived with the receive buffer full
+        uint64_t garbled; // Arrived at the wrong baud rate
+        int rxPeak; // Fullest the receive buffer got
+    };
+
+    class Uart {
+        public:
+            Uart(const std::string &name);
+
+            static void connect(Uart &a, Uart &b);
+
+            void begin(const uint32_t baud);
+            void end(void);
+            void reset(void); // Loses everything, as its MCU was reset
+
+            int available(void);
+            int read(void);
+            int peek(void);
+            int availableForWrite(void);
+            void write(const uint8_t c); // Waits for room like the AVR does
+            void flush(void); // Waits until everything is on the line
+
+            const std::string &name(void) const;
+            uint32_t baud(void) const;
+            const UartStats &stats(void) const;
+
+        private:
+            struct LineByte {
+                Time arrival;
+                uint8_t data;
+                uint32_t baud;
+            };
+
+            std::string _name;
+            Uart *_peer;
+            uint32_t _baud;
+            bool _enabled;
+            std::deque<LineByte> _incoming; // Sent by the peer, in flight
+            std::deque<uint8_t> _rx;
+            std::deque<Time> _txDone; // When our unsent bytes will be out
+            Time _lineFree;
+            UartStats _stats;
+
+            void _receive(void);
+            void _pruneTx(void);
+    };
+}
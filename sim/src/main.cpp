@@ -0,0 +1,623 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Host co-simulation of the whole console: the programmer, logic MCU and
+ *   GPU firmware run together against simulated Serial, Wire, SD, I2C and DVI
+ * - The programmer drives the logic MCU's reset line and talks to its
+ *   bootloader and then its program over a 115200 baud (or faster) serial
+ *   line. Both AVRs are slaves on the GPU's 100kHz I2C bus
+ * - Reports when things happen (reset, bootloader sync, flash done, first
+ *   frame, menu drawn, N sprites loaded) and how busy each link was
+ * - Scenarios can press the logic MCU's buttons, as menu-scroll does to step
+ *   the game list down past its last row
+ */
+
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Sim.hpp"
+#include "Avr.hpp"
+#include "Gpu.hpp"
+#include "SdCard.hpp"
+#include "Card.hpp"
+#include "Optiboot.hpp"
+#include "Firmware.hpp"
+
+using namespace sim;
+
+const int g_resetPin = 6; // MigsProgrammer's line to the logic MCU's reset
+const uint16_t g_menuBg = 0x07FF; // What MigsMenu sets
+const int g_phaseReady = 6; // MigsProgrammer's boot::Phase::Ready
+const Time g_sampleInterval = 10 * g_ms;
+
+// MigsMenu's list: its scroll down button, and where its rows of text are
+const int g_downPin = 3;
+const int g_menuRows = 10;
+const int g_menuRowTop = 4, g_menuRowPitch = 10, g_menuRowHeight = 8;
+const int g_scrollGames = 20; // On the card menu-scroll builds by default
+const Time g_pressInterval = 100 * g_ms; // Held this long, then let go
+
+struct Options {
+    std::string app = "menu";
+    std::string libDir;
+    std::string cardDir, saveCardDir;
+    std::string traceFile, frameFile, gpuTraceFile;
+    CardSpec card = { 12288, 3, 64 };
+    bool gamesGiven = false;
+    int boots = 1;
+    Time limit = 10 * g_sec;
+    bool pgrmrDebug = false;
+    bool verbose = false;
+    bool keepGoing = false; // Run out --time even once the goal is reached
+};
+
+// What's been seen of the current boot. Goals only count for the program
+// the logic MCU is running once the programmer is done with it, so a frame
+// from before its last reset can't reach them
+struct Watch {
+    bool menuDrawn, spritesDrawn, benchDone, scrolled;
+    bool appUp, pgrmrReady;
+    uint16_t lastBg;
+    int lastDrawn;
+    size_t eventsSeen;
+    Frame lastFrame;
+
+    // menu-scroll: presses so far, rows the list has moved, and the frames
+    // last settled on and after the last press
+    int presses, rowsMoved;
+    bool scrollBroken;
+    Frame settling, shown;
+};
+
+static Options g_opts;
+static Watch g_watch;
+static std::vector<std::string> g_samples; // Bus utilisation, for --trace
+static std::vector<uint8_t> g_gpuTrace; // What the GPU sent on UART0, every boot
+static bool (*g_pgrmrMarked)(int) = nullptr; // Its boot::marked(), while loaded
+
+void usage(const char *prog) {
+    printf(
+        "Usage: %s [options]\n"
+        "  --app NAME       Logic MCU program once flashed: menu, menu-scroll,\n"
+        "                   sprites, sprites-cpu or bench (default menu)\n"
+        "  --games N        GAME<n>.HEX files on the generated card (default 3,\n"
+        "                   20 for menu-scroll)\n"
+        "  --sprites N      Sprites in the generated SPRITES.PAK (default 64)\n"
+        "  --hex-size N     Bytes of code in the generated MENU.HEX\n"
+        "  --card DIR       Use the files in DIR as the SD card instead\n"
+        "  --save-card DIR  Write the card out after the run\n"
+        "  --boots N        Power cycle N times, keeping EEPROM and flash\n"
+        "  --time MS        Simulated time each boot gets (default 10000)\n"
+        "  --pgrmr-debug    Run the programmer built with PGRMR_DEBUG\n"
+        "  --trace FILE     Write every event and bus sample as CSV\n"
+        "  --frame FILE     Save the last frame as a PPM\n"
+        "  --gpu-trace FILE Save the GPU's command trace (tools/migstrace.py)\n"
+        "  --lib DIR        Where the firmware libraries are\n"
+        "  --keep-going     Run for all of --time, not just until the goal\n"
+        "  --verbose        Print events as they happen\n",
+        prog
+    );
+}
+
+bool parseArgs(int argc, char **argv) {
+    char self[PATH_MAX] = {};
+    if(readlink("/proc/self/exe", self, sizeof(self) - 1) > 0) {
+        g_opts.libDir = dirname(self);
+    }
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool takesVal = true;
+        if((arg == "--app") && val) {
+            g_opts.app = val;
+        } else if((arg == "--games") && val) {
+            g_opts.card.games = atoi(val);
+            g_opts.gamesGiven = true;
+        } else if((arg == "--sprites") && val) {
+            g_opts.card.sprites = atoi(val);
+        } else if((arg == "--hex-size") && val) {
+            g_opts.card.menuSize = atoi(val);
+        } else if((arg == "--card") && val) {
+            g_opts.cardDir = val;
+        } else if((arg == "--save-card") && val) {
+            g_opts.saveCardDir = val;
+        } else if((arg == "--boots") && val) {
+            g_opts.boots = atoi(val);
+        } else if((arg == "--time") && val) {
+            g_opts.limit = atoll(val) * g_ms;
+        } else if((arg == "--trace") && val) {
+            g_opts.traceFile = val;
+        } else if((arg == "--frame") && val) {
+            g_opts.frameFile = val;
+        } else if((arg == "--gpu-trace") && val) {
+            g_opts.gpuTraceFile = val;
+        } else if((arg == "--lib") && val) {
+            g_opts.libDir = val;
+        } else if(arg == "--pgrmr-debug") {
+            g_opts.pgrmrDebug = true;
+            takesVal = false;
+        } else if(arg == "--keep-going") {
+            g_opts.keepGoing = true;
+            takesVal = false;
+        } else if(arg == "--verbose") {
+            g_opts.verbose = true;
+            takesVal = false;
+        } else {
+            return false;
+        }
+        i += takesVal ? 1 : 0;
+    }
+    if((g_opts.app == "menu-scroll") && !g_opts.gamesGiven) {
+        g_opts.card.games = g_scrollGames;
+    }
+    return (g_opts.app == "menu") || (g_opts.app == "menu-scroll")
+        || (g_opts.app == "sprites") || (g_opts.app == "sprites-cpu")
+        || (g_opts.app == "bench");
+}
+
+// A logic MCU reset or restart starts the goals over
+void watchEvents(void) {
+    const std::vector<Event> &evs = events();
+    for(; g_watch.eventsSeen < evs.size(); g_watch.eventsSeen++) {
+        const std::string &text = evs[g_watch.eventsSeen].text;
+        if(text == "debug: Done.") {
+            g_watch.benchDone = g_watch.appUp;
+        } else if((text == "app started") || (text == "logic MCU reset")) {
+            g_watch.appUp = text == "app started";
+            g_watch.menuDrawn = false;
+            g_watch.spritesDrawn = false;
+            g_watch.benchDone = false;
+            g_watch.scrolled = false;
+            g_watch.presses = 0;
+            g_watch.rowsMoved = 0;
+            g_watch.scrollBroken = false;
+            g_watch.settling = g_watch.shown = Frame {};
+        }
+    }
+}
+
+// Only asked while the programmer is loaded, and kept once it's true
+void watchPgrmr(void) {
+    if(!g_watch.pgrmrReady && g_pgrmrMarked) {
+        g_watch.pgrmrReady = g_pgrmrMarked(g_phaseReady);
+    }
+}
+
+// Note what changed on screen, and whether the scenario's goal is up
+void watchFrame(const Frame &frame) {
+    uint16_t bg = frame.pixels[0];
+    int drawn = 0;
+    for(uint16_t px : frame.pixels) {
+        drawn += px != bg;
+    }
+    if((frame.index == 0) || (bg != g_watch.lastBg)
+            || (drawn != g_watch.lastDrawn)) {
+        event(
+            "frame %llu: background %04X, %d pixels drawn",
+            static_cast<unsigned long long>(frame.index), bg, drawn
+        );
+    }
+    g_watch.lastBg = bg;
+    g_watch.lastDrawn = drawn;
+    g_watch.lastFrame = frame;
+
+    watchEvents();
+    if(!g_watch.appUp) {
+        return;
+    }
+    if(!g_watch.menuDrawn && (bg == g_menuBg) && (drawn > 0)) {
+        g_watch.menuDrawn = true;
+        event("menu drawn");
+    }
+    int sprites = g_opts.card.sprites;
+    bool spriteApp = g_opts.app.compare(0, 7, "sprites") == 0;
+    if(spriteApp && !g_watch.spritesDrawn && (drawn >= sprites * 64)) {
+        g_watch.spritesDrawn = true;
+        event("all %d sprites drawn", sprites);
+    }
+}
+
+// Whether a row of the list's text is the same in both frames
+bool sameMenuRow(
+        const Frame &a, const int rowA, const Frame &b, const int rowB) {
+    for(int y = 0; y < g_menuRowHeight; y++) {
+        size_t lineA = (g_menuRowTop + rowA * g_menuRowPitch + y) * a.width;
+        size_t lineB = (g_menuRowTop + rowB * g_menuRowPitch + y) * b.width;
+        if(!std::equal(
+                a.pixels.begin() + lineA, a.pixels.begin() + lineA + a.width,
+                b.pixels.begin() + lineB)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rows the list moved between two frames: 0 or 1 for a press, else -1
+int menuRowsMoved(const Frame &before, const Frame &after) {
+    if(after.pixels == before.pixels) {
+        return 0;
+    }
+    for(int row = 0; row + 1 < g_menuRows; row++) {
+        if(!sameMenuRow(after, row, before, row + 1)) {
+            return -1;
+        }
+    }
+    return 1;
+}
+
+// Each period: let go of the button, or once the screen has held still for a
+// period, check what the last press did and press again. It keeps going a
+// press past the end of the list, which mustn't move it
+void pressMenu(Avr &logic) {
+    if((g_opts.app != "menu-scroll") || !g_watch.menuDrawn
+            || g_watch.scrolled || g_watch.scrollBroken) {
+        return;
+    }
+    const uint32_t down = 1UL << g_downPin;
+    if(logic.pinsLow & down) {
+        logic.pinsLow &= ~down;
+        return;
+    }
+    const Frame &frame = g_watch.lastFrame;
+    if(frame.pixels != g_watch.settling.pixels) {
+        g_watch.settling = frame;
+        return;
+    }
+
+    if(g_watch.presses > 0) {
+        int moved = menuRowsMoved(g_watch.shown, frame);
+        if(moved < 0) {
+            event("menu rows out of place after press %d", g_watch.presses);
+            g_watch.scrollBroken = true;
+            return;
+        }
+        g_watch.rowsMoved += moved;
+    }
+    g_watch.shown = frame;
+
+    int end = std::max(g_opts.card.games - g_menuRows, 0);
+    if(g_watch.presses > end) {
+        g_watch.scrolled = g_watch.rowsMoved == end;
+        event(
+            "menu scrolled %d rows in %d presses (%d games)",
+            g_watch.rowsMoved, g_watch.presses, g_opts.card.games
+        );
+        return;
+    }
+    logic.pinsLow |= down;
+    g_watch.presses++;
+}
+
+bool scenarioDone(void) {
+    watchEvents();
+    if(!g_watch.pgrmrReady) {
+        return false;
+    }
+    if(g_opts.app == "menu") {
+        return g_watch.menuDrawn;
+    } else if(g_opts.app == "menu-scroll") {
+        return g_watch.scrolled;
+    } else if(g_opts.app == "bench") {
+        return g_watch.benchDone;
+    }
+    return g_watch.spritesDrawn;
+}
+
+bool flashBlank(const Avr &avr) {
+    for(uint8_t b : avr.flash) {
+        if(b != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Offset of the first byte that doesn't match MENU.HEX, or -1
+int verifyFlash(const Avr &avr) {
+    CardFile *hex = g_card.find("MENU.HEX");
+    if(!hex) {
+        return 0;
+    }
+    std::vector<uint8_t> image = parseHex(hex->data);
+    for(size_t i = 0; i < image.size(); i++) {
+        if((i >= sizeof(avr.flash)) || (avr.flash[i] != image[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+std::string appLib(void) {
+    std::string app = (g_opts.app == "menu-scroll") ? "menu" : g_opts.app;
+    return g_opts.libDir + "/" + app + ".so";
+}
+
+void printStats(const Avr &pgrmr, const Avr &logic, const Time elapsed) {
+    double ms = elapsed / static_cast<double>(g_ms);
+    printf("Bus utilisation over %.1f ms:\n", ms);
+
+    const Avr *ends[2] = { &pgrmr, &logic };
+    for(int i = 0; i < 2; i++) {
+        const UartStats &tx = ends[i]->uart.stats();
+        const UartStats &rx = ends[1 - i]->uart.stats();
+        printf(
+            "  uart %s->%s: %llu B, busy %.1f ms (%.1f%%),"
+            " %llu overrun, %llu garbled, %llu lost, rx peak %d\n",
+            ends[i]->name.c_str(), ends[1 - i]->name.c_str(),
+            static_cast<unsigned long long>(tx.bytes), tx.busy / 1e6,
+            100.0 * tx.busy / elapsed,
+            static_cast<unsigned long long>(rx.overruns),
+            static_cast<unsigned long long>(rx.garbled),
+            static_cast<unsigned long long>(rx.lost), rx.rxPeak
+        );
+    }
+
+    Time i2cBusy = 0;
+    for(const auto &slave : g_i2c.stats()) {
+        const I2cStats &st = slave.second;
+        i2cBusy += st.busy;
+        printf(
+            "  i2c 0x%02X: %llu reads (%llu NAKed), %llu B, busy %.1f ms"
+            " (%.1f%%)\n",
+            slave.first, static_cast<unsigned long long>(st.transactions),
+            static_cast<unsigned long long>(st.naks),
+            static_cast<unsigned long long>(st.bytes), st.busy / 1e6,
+            100.0 * st.busy / elapsed
+        );
+    }
+    printf("  i2c total: busy %.1f%%\n", 100.0 * i2cBusy / elapsed);
+
+    const SdStats &sd = g_card.stats();
+    printf(
+        "  sd: %llu block reads, %llu block writes, busy %.1f ms (%.1f%%)\n",
+        static_cast<unsigned long long>(sd.blockReads),
+        static_cast<unsigned long long>(sd.blockWrites), sd.busy / 1e6,
+        100.0 * sd.busy / elapsed
+    );
+
+    const DviStats &dvi = dviStats();
+    printf(
+        "  dvi: %llu frames, %llu late lines (line slot %.2f us)\n",
+        static_cast<unsigned long long>(dvi.frames),
+        static_cast<unsigned long long>(dvi.lateLines),
+        dvi.linePeriod / 1e3
+    );
+}
+
+// Busy fraction of each link over the last interval, for the trace
+void sampleBuses(const Time at, const Avr &pgrmr, const Avr &logic) {
+    static Time lastTx[2], lastI2c;
+    if(at == g_sampleInterval) {
+        lastTx[0] = lastTx[1] = lastI2c = 0;
+    }
+    Time tx[2] = { pgrmr.uart.stats().busy, logic.uart.stats().busy };
+    Time i2c = 0;
+    for(const auto &slave : g_i2c.stats()) {
+        i2c += slave.second.busy;
+    }
+    char line[128];
+    snprintf(
+        line, sizeof(line), "%.3f,%.1f,%.1f,%.1f",
+        at / 1e3, 100.0 * (tx[0] - lastTx[0]) / g_sampleInterval,
+        100.0 * (tx[1] - lastTx[1]) / g_sampleInterval,
+        100.0 * (i2c - lastI2c) / g_sampleInterval
+    );
+    g_samples.push_back(line);
+    lastTx[0] = tx[0];
+    lastTx[1] = tx[1];
+    lastI2c = i2c;
+}
+
+void runBoot(const int boot, Avr &pgrmr, Avr &logic) {
+    bool cold = flashBlank(logic);
+    printf(
+        "== Boot %d (%s) ==\n", boot + 1,
+        cold ? "logic MCU blank" : "logic MCU already flashed"
+    );
+
+    g_watch = Watch {};
+    g_watch.eventsSeen = events().size();
+    resetGpu();
+    g_i2c.reset();
+    g_card.clearStats();
+    pgrmr.uart = Uart(pgrmr.name);
+    logic.uart = Uart(logic.name);
+    Uart::connect(pgrmr.uart, logic.uart);
+    pgrmr.reset();
+    logic.reset();
+    logic.pinsLow = 0; // Nobody's holding a button yet
+    size_t firstEvent = events().size();
+
+    std::string pgrmrLib = g_opts.libDir
+        + (g_opts.pgrmrDebug ? "/pgrmr-debug.so" : "/pgrmr.so");
+    Core pgrmrCore("pgrmr", [&pgrmrLib](Core &core) {
+        Firmware fw(pgrmrLib);
+        g_pgrmrMarked = reinterpret_cast<bool (*)(int)>(
+            fw.symbol("_ZN4boot6markedENS_5PhaseE")
+        );
+        fw.setup();
+        while(true) {
+            fw.loop();
+            spend(g_avrCallCost);
+        }
+    });
+
+    Core logicCore("logic", [&logic](Core &core) {
+        bool powerOn = true;
+        while(true) {
+            try {
+                core.waitForRelease();
+                if(!powerOn) { // External reset: the bootloader goes first
+                    optiboot(logic);
+                }
+                powerOn = false;
+                while(flashBlank(logic)) {
+                    spend(g_ms); // Runs off into nothing until it's reset
+                }
+                Firmware app(appLib());
+                event("app started");
+                app.setup();
+                while(true) {
+                    app.loop();
+                    spend(g_avrCallCost);
+                }
+            } catch(Reset &) {
+            }
+        }
+    });
+
+    Core gpuCore("gpu", [](Core &core) {
+        while(true) {
+            try {
+                Firmware fw(g_opts.libDir + "/gpu.so");
+                fw.main();
+                return;
+            } catch(Reset &) { // Its watchdog
+                event("watchdog reboot");
+                rebootGpu();
+            }
+        }
+    });
+
+    bind(pgrmrCore, pgrmr);
+    bind(logicCore, logic);
+    pgrmrCore.onPin = [&logicCore](int pin, int level) {
+        if(pin == g_resetPin) {
+            if(!level && !logicCore.held()) {
+                event("logic MCU reset");
+            }
+            logicCore.hold(!level);
+        }
+    };
+    logicCore.onReset = [&logic]() { logic.reset(); };
+    onFrame(watchFrame);
+    Scheduler::every(g_sampleInterval, [&pgrmr, &logic](Time at) {
+        sampleBuses(at, pgrmr, logic);
+    });
+    Scheduler::every(g_pressInterval, [&logic](Time at) {
+        pressMenu(logic);
+    });
+
+    std::vector<Core *> cores = { &pgrmrCore, &logicCore, &gpuCore };
+    Scheduler::run(cores, g_opts.limit, []() {
+        watchPgrmr();
+        return scenarioDone() && !g_opts.keepGoing;
+    });
+    g_pgrmrMarked = nullptr;
+    Time elapsed = std::min(
+        std::min(pgrmrCore.now(), logicCore.now()), gpuCore.now()
+    );
+
+    const std::vector<Event> &evs = events();
+    for(size_t i = firstEvent; i < evs.size(); i++) {
+        printf(
+            "[%10.3f ms] %-6s %s\n", evs[i].time / static_cast<double>(g_ms),
+            evs[i].core.c_str(), evs[i].text.c_str()
+        );
+    }
+    if(!scenarioDone()) {
+        printf("Gave up after %.0f ms\n", g_opts.limit / 1e6);
+    }
+
+    int bad = verifyFlash(logic);
+    if(bad < 0) {
+        printf("Logic MCU flash matches MENU.HEX\n");
+    } else {
+        printf("Logic MCU flash differs from MENU.HEX at 0x%04X\n", bad);
+    }
+    printStats(pgrmr, logic, elapsed);
+
+    const std::vector<uint8_t> &uart = gpuUartOutput();
+    g_gpuTrace.insert(g_gpuTrace.end(), uart.begin(), uart.end());
+}
+
+void writeTrace(const std::string &path) {
+    FILE *f = fopen(path.c_str(), "w");
+    if(!f) {
+        fprintf(stderr, "Can't write %s\n", path.c_str());
+        return;
+    }
+    fprintf(f, "time_us,core,event\n");
+    for(const Event &ev : events()) {
+        fprintf(
+            f, "%.3f,%s,\"%s\"\n", ev.time / 1e3, ev.core.c_str(),
+            ev.text.c_str()
+        );
+    }
+    fprintf(f, "\ntime_us,uart_pgrmr_tx_pct,uart_logic_tx_pct,i2c_pct\n");
+    for(const std::string &sample : g_samples) {
+        fprintf(f, "%s\n", sample.c_str());
+    }
+    fclose(f);
+}
+
+// RGAB5515 -> 24 bit binary PPM
+void writeFrame(const std::string &path, const Frame &frame) {
+    FILE *f = fopen(path.c_str(), "wb");
+    if(!f || frame.pixels.empty()) {
+        fprintf(stderr, "Can't write %s\n", path.c_str());
+        if(f) {
+            fclose(f);
+        }
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", frame.width, frame.height);
+    for(uint16_t px : frame.pixels) {
+        uint8_t rgb[3] = {
+            static_cast<uint8_t>(((px >> 11) & 0x1F) << 3),
+            static_cast<uint8_t>(((px >> 6) & 0x1F) << 3),
+            static_cast<uint8_t>((px & 0x1F) << 3)
+        };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv) {
+    if(!parseArgs(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    echoEvents(g_opts.verbose);
+
+    if(!g_opts.cardDir.empty()) {
+        if(!g_card.load(g_opts.cardDir)) {
+            fprintf(stderr, "Can't load %s\n", g_opts.cardDir.c_str());
+            return 1;
+        }
+    } else {
+        buildCard(g_opts.card);
+    }
+
+    Avr pgrmr("pgrmr"), logic("logic");
+    for(int boot = 0; boot < g_opts.boots; boot++) {
+        runBoot(boot, pgrmr, logic);
+    }
+
+    if(!g_opts.traceFile.empty()) {
+        writeTrace(g_opts.traceFile);
+    }
+    if(!g_opts.frameFile.empty()) {
+        writeFrame(g_opts.frameFile, g_watch.lastFrame);
+    }
+    if(!g_opts.gpuTraceFile.empty()) {
+        FILE *f = fopen(g_opts.gpuTraceFile.c_str(), "wb");
+        if(f) {
+            fwrite(g_gpuTrace.data(), 1, g_gpuTrace.size(), f);
+            fclose(f);
+        } else {
+            fprintf(stderr, "Can't write %s\n", g_opts.gpuTraceFile.c_str());
+        }
+    }
+    if(!g_opts.saveCardDir.empty()) {
+        g_card.save(g_opts.saveCardDir);
+    }
+    return scenarioDone() ? 0 : 2;
+}
@@ -0,0 +1,125 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for the AVR Arduino core, so the programmer and logic MCU code
+ *   builds for the host simulator (see sim/src/Arduino.cpp)
+ * - Only what MiGS uses. Timing and pins go to the simulated core that's
+ *   running, Serial to its UART
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// No separate program memory on the host
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(p) (*(const uint8_t *) (p))
+#define pgm_read_byte_near(p) pgm_read_byte(p)
+#define pgm_read_word(p) (*(const uint16_t *) (p))
+#define pgm_read_dword(p) (*(const uint32_t *) (p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper *>(str))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+void noInterrupts(void);
+void interrupts(void);
+
+// Like the AVR core's, so mixed types behave the same
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define constrain(amt, low, high) \
+    ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class Print {
+    public:
+        virtual ~Print(void) {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t *buff, size_t len);
+        size_t write(const char *str);
+
+        size_t print(const __FlashStringHelper *str);
+        size_t print(const char *str);
+        size_t print(char c);
+        size_t print(unsigned char n, int base = DEC);
+        size_t print(int n, int base = DEC);
+        size_t print(unsigned int n, int base = DEC);
+        size_t print(long n, int base = DEC);
+        size_t print(unsigned long n, int base = DEC);
+
+        size_t println(void);
+        size_t println(const __FlashStringHelper *str);
+        size_t println(const char *str);
+        size_t println(char c);
+        size_t println(unsigned char n, int base = DEC);
+        size_t println(int n, int base = DEC);
+        size_t println(unsigned int n, int base = DEC);
+        size_t println(long n, int base = DEC);
+        size_t println(unsigned long n, int base = DEC);
+
+    private:
+        size_t _printNumber(unsigned long n, int base);
+};
+
+class Stream : public Print {
+    public:
+        virtual int available(void) = 0;
+        virtual int read(void) = 0;
+        virtual int peek(void) = 0;
+
+        void setTimeout(unsigned long ms);
+        size_t readBytes(uint8_t *buff, size_t len);
+        size_t readBytes(char *buff, size_t len);
+
+    protected:
+        unsigned long _timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+    public:
+        void begin(unsigned long baud);
+        void end(void);
+        int available(void) override;
+        int read(void) override;
+        int peek(void) override;
+        int availableForWrite(void);
+        void flush(void);
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buff, size_t len) override;
+        using Print::write;
+        operator bool(void) { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,34 @@
+/*
+ * Author: Dylan Turner
+ * Description: Stand-in for the AVR EEPROM library, 1 KB per simulated core
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class EEPROMClass {
+    public:
+        uint8_t read(int addr);
+        void write(int addr, uint8_t val);
+        void update(int addr, uint8_t val);
+        uint16_t length(void);
+
+        template<typename T> T &get(int addr, T &ref_val) {
+            uint8_t *bytes = reinterpret_cast<uint8_t *>(&ref_val);
+            for(size_t i = 0; i < sizeof(T); i++) {
+                bytes[i] = read(addr + i);
+            }
+            return ref_val;
+        }
+
+        template<typename T> const T &put(int addr, const T &val) {
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&val);
+            for(size_t i = 0; i < sizeof(T); i++) {
+                update(addr + i, bytes[i]);
+            }
+            return val;
+        }
+};
+
+extern EEPROMClass EEPROM;
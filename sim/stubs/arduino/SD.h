@@ -0,0 +1,65 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for the Arduino SD library, backed by the simulator's in-memory
+ *   card (sim/src/SdCard.cpp)
+ * - File copies share one open file, like the real library's
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define O_READ 0x01
+#define O_WRITE 0x02
+#define O_RDWR (O_READ | O_WRITE)
+#define O_APPEND 0x04
+#define O_CREAT 0x10
+#define O_TRUNC 0x20
+
+#define FILE_READ O_READ
+#define FILE_WRITE (O_READ | O_WRITE | O_CREAT | O_APPEND)
+
+namespace sim {
+    struct FileHandle;
+}
+
+class File : public Stream {
+    public:
+        File(void);
+        File(sim::FileHandle *handle);
+        File(const File &other);
+        File &operator=(const File &other);
+        ~File(void);
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buff, size_t len) override;
+        using Print::write;
+        int read(void) override;
+        int read(void *buff, uint16_t len);
+        int peek(void) override;
+        int available(void) override;
+        void flush(void);
+        bool seek(uint32_t pos);
+        uint32_t position(void);
+        uint32_t size(void);
+        void close(void);
+        operator bool(void);
+        char *name(void);
+        bool isDirectory(void);
+        File openNextFile(uint8_t mode = O_READ);
+        void rewindDirectory(void);
+
+    private:
+        sim::FileHandle *_handle;
+};
+
+class SDClass {
+    public:
+        bool begin(uint8_t chipSelect);
+        File open(const char *path, uint8_t mode = FILE_READ);
+        bool exists(const char *path);
+        bool remove(const char *path);
+};
+
+extern SDClass SD;
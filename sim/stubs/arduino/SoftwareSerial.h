@@ -0,0 +1,32 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for SoftwareSerial. Only ever used for debug output, so what's
+ *   written shows up in the simulator's trace instead
+ * - Text becomes an event per line, and the programmer's binary pgrmrtrace
+ *   records an event each
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <PgrmrTrace.hpp>
+
+class SoftwareSerial : public Stream {
+    public:
+        SoftwareSerial(uint8_t rx, uint8_t tx);
+
+        void begin(long baud);
+        int available(void) override;
+        int read(void) override;
+        int peek(void) override;
+        size_t write(uint8_t c) override;
+        using Print::write;
+
+    private:
+        long _baud;
+        char _line[96];
+        int _lineLen;
+        uint8_t _record[pgrmrtrace::g_recordSize];
+        int _recordLen;
+};
@@ -0,0 +1,31 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for the AVR Wire library, slave side only (MiGS' AVRs are slaves
+ *   on the GPU's bus)
+ * - onRequest and onReceive handlers run on the GPU's thread when it
+ *   addresses this core
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire : public Stream {
+    public:
+        void begin(void);
+        void begin(uint8_t addr);
+        void end(void);
+        void setClock(uint32_t hz);
+        void onRequest(void (*handler)(void));
+        void onReceive(void (*handler)(int));
+
+        int available(void) override;
+        int read(void) override;
+        int peek(void) override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buff, size_t len) override;
+        using Print::write;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,11 @@
+/*
+ * Author: Dylan Turner
+ * Description: Stand-in for PicoDVI's board pin configs (pins don't matter)
+ */
+
+#pragma once
+
+#include "dvi.h"
+
+extern const struct dvi_serialiser_cfg sim_dvi_cfg;
+#define DVI_DEFAULT_SERIAL_CONFIG sim_dvi_cfg
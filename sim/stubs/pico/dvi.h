@@ -0,0 +1,33 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for PicoDVI's libdvi. Scanout is modelled by the simulator: it
+ *   takes a line from q_colour_valid every scan line slot (DVI_VERTICAL_REPEAT
+ *   output lines) and hands it back on q_colour_free once it's been shown
+ */
+
+#pragma once
+
+#include "sim_pico.h"
+#include "dvi_timing.h"
+
+#ifndef DVI_VERTICAL_REPEAT
+#define DVI_VERTICAL_REPEAT 2
+#endif
+
+struct dvi_serialiser_cfg {
+    uint pio_sm_tmds[3];
+};
+
+struct dvi_inst {
+    const struct dvi_timing *timing;
+    struct dvi_serialiser_cfg ser_cfg;
+    queue_t q_colour_valid;
+    queue_t q_colour_free;
+};
+
+void dvi_init(struct dvi_inst *inst, uint spinlock_tmds_queue,
+    uint spinlock_colour_queue);
+void dvi_register_irqs_this_core(struct dvi_inst *inst, uint irq_num);
+void dvi_start(struct dvi_inst *inst);
+void dvi_scanbuf_main_16bpp(struct dvi_inst *inst);
@@ -0,0 +1,30 @@
+/*
+ * Author: Dylan Turner
+ * Description: Stand-in for PicoDVI's mode timings (same fields and values)
+ */
+
+#pragma once
+
+#include "sim_pico.h"
+
+struct dvi_timing {
+    bool h_sync_polarity;
+    uint h_front_porch;
+    uint h_sync_width;
+    uint h_back_porch;
+    uint h_active_pixels;
+
+    bool v_sync_polarity;
+    uint v_front_porch;
+    uint v_sync_width;
+    uint v_back_porch;
+    uint v_active_lines;
+
+    uint bit_clk_khz;
+};
+
+extern const struct dvi_timing dvi_timing_640x480p_60hz;
+extern const struct dvi_timing dvi_timing_800x480p_60hz;
+extern const struct dvi_timing dvi_timing_800x600p_60hz;
+extern const struct dvi_timing dvi_timing_960x540p_60hz;
+extern const struct dvi_timing dvi_timing_1280x720p_30hz;
@@ -0,0 +1,192 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-ins for the parts of the Pico SDK the GPU uses, so it builds for the
+ *   host simulator (see sim/src/Pico.cpp). The SDK's headers all include this
+ * - I2C registers are objects, so reading/writing them drives the simulated
+ *   bus the same way the DW_apb_i2c block would
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define __scratch_x(s)
+#define __scratch_y(s)
+#define __in_flash(group)
+
+// Time, clocks, power and pins
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+bool set_sys_clock_khz(uint32_t khz, bool required);
+bool stdio_init_all(void);
+void setup_default_uart(void);
+
+enum vreg_voltage {
+    VREG_VOLTAGE_1_10 = 11,
+    VREG_VOLTAGE_1_15 = 12,
+    VREG_VOLTAGE_1_20 = 13,
+    VREG_VOLTAGE_1_25 = 14,
+    VREG_VOLTAGE_1_30 = 15
+};
+void vreg_set_voltage(enum vreg_voltage voltage);
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1F
+};
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+
+// Cores, interrupts and queues
+
+enum irq_number {
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12
+};
+
+void multicore_launch_core1(void (*entry)(void));
+void __wfe(void);
+void __sev(void);
+uint next_striped_spin_lock_num(void);
+
+typedef struct {
+    int id; // The simulator tells queues apart by address
+} queue_t;
+
+bool queue_is_empty(queue_t *q);
+void queue_add_blocking(queue_t *q, const void *data);
+void queue_remove_blocking(queue_t *q, void *data);
+bool queue_try_add(queue_t *q, const void *data);
+bool queue_try_remove(queue_t *q, void *data);
+
+// I2C
+
+uint32_t sim_i2c_read(int reg);
+void sim_i2c_write(int reg, uint32_t val);
+
+enum sim_i2c_reg {
+    SIM_I2C_CON, SIM_I2C_TAR, SIM_I2C_DATA_CMD, SIM_I2C_RAW_INTR_STAT,
+    SIM_I2C_CLR_TX_ABRT, SIM_I2C_ENABLE, SIM_I2C_STATUS, SIM_I2C_TXFLR,
+    SIM_I2C_RXFLR, SIM_I2C_OTHER
+};
+
+#ifndef __cplusplus
+#error "The simulator's Pico SDK stand-ins are C++ only"
+#endif
+
+class sim_i2c_reg_t {
+    public:
+        sim_i2c_reg_t(int reg) : _reg(reg) {}
+        operator uint32_t(void) const { return sim_i2c_read(_reg); }
+        sim_i2c_reg_t &operator=(uint32_t val) {
+            sim_i2c_write(_reg, val);
+            return *this;
+        }
+
+    private:
+        int _reg;
+};
+
+typedef struct {
+    sim_i2c_reg_t con{SIM_I2C_CON};
+    sim_i2c_reg_t tar{SIM_I2C_TAR};
+    sim_i2c_reg_t data_cmd{SIM_I2C_DATA_CMD};
+    sim_i2c_reg_t raw_intr_stat{SIM_I2C_RAW_INTR_STAT};
+    sim_i2c_reg_t clr_tx_abrt{SIM_I2C_CLR_TX_ABRT};
+    sim_i2c_reg_t enable{SIM_I2C_ENABLE};
+    sim_i2c_reg_t status{SIM_I2C_STATUS};
+    sim_i2c_reg_t txflr{SIM_I2C_TXFLR};
+    sim_i2c_reg_t rxflr{SIM_I2C_RXFLR};
+} i2c_hw_t;
+
+typedef struct i2c_inst {
+    i2c_hw_t *hw;
+    bool restart_on_next;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c1_inst;
+#define i2c1 (&i2c1_inst)
+
+#define I2C_IC_ENABLE_ENABLE_BITS 0x00000001u
+#define I2C_IC_ENABLE_ABORT_BITS 0x00000002u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_STATUS_ACTIVITY_BITS 0x00000001u
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    return i2c->hw;
+}
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+
+// Watchdog. The scratch registers outlast a watchdog reboot, not a power
+// cycle, and a reboot starts the GPU's firmware over
+
+typedef struct {
+    uint32_t scratch[8];
+} watchdog_hw_t;
+
+extern watchdog_hw_t *const watchdog_hw;
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+bool watchdog_caused_reboot(void);
+
+// UART (transmit only, captured by the simulator)
+
+typedef struct uart_inst {
+    int index;
+} uart_inst_t;
+
+extern uart_inst_t uart0_inst;
+#define uart0 (&uart0_inst)
+
+uint uart_init(uart_inst_t *uart, uint baudrate);
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+bool uart_is_writable(uart_inst_t *uart);
+void uart_putc_raw(uart_inst_t *uart, char c);
+
+// Interpolators: shift, mask, add raw and the full result, as far as
+// texture lookups go (no signed or cross lanes, no blend or clamp modes)
+
+typedef struct {
+    uint32_t ctrl;
+} interp_config;
+
+typedef struct {
+    uint32_t accum[2];
+    uint32_t base[3];
+    uint32_t ctrl[2];
+} interp_hw_t;
+
+extern interp_hw_t interp0_inst, interp1_inst;
+#define interp0 (&interp0_inst)
+#define interp1 (&interp1_inst)
+
+interp_config interp_default_config(void);
+void interp_config_set_shift(interp_config *c, uint shift);
+void interp_config_set_mask(interp_config *c, uint mask_lsb, uint mask_msb);
+void interp_config_set_add_raw(interp_config *c, bool add_raw);
+void interp_set_config(interp_hw_t *interp, uint lane, interp_config *config);
+void interp_set_base(interp_hw_t *interp, uint lane, uint32_t val);
+void interp_set_accumulator(interp_hw_t *interp, uint lane, uint32_t val);
+uint32_t interp_get_accumulator(interp_hw_t *interp, uint lane);
+uint32_t interp_pop_full_result(interp_hw_t *interp);
@@ -0,0 +1,30 @@
+/*
+ * Author: Dylan Turner
+ * Description:
+ * - Stand-in for PicoDVI's libsprite. Same drawing (RGAB5515, bit 5 is
+ *   alpha), each call charged what the assembly takes on the RP2040
+ */
+
+#pragma once
+
+#include "sim_pico.h"
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    const void *img;
+    uint8_t log_size; // Sprite is 1 << log_size pixels square
+    bool has_opacity_metadata;
+    bool hflip;
+    bool vflip;
+} sprite_t;
+
+typedef int32_t affine_transform_t[6];
+
+void sprite_fill8(uint8_t *scanbuf, uint8_t colour, uint len);
+void sprite_fill16(uint16_t *scanbuf, uint16_t colour, uint len);
+void sprite_blit16(uint16_t *dst, const uint16_t *src, uint len);
+void sprite_blit16_alpha(uint16_t *dst, const uint16_t *src, uint len);
+void sprite_sprite16(
+    uint16_t *scanbuf, const sprite_t *sp, uint raster_y, uint raster_w
+);
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+Author: Dylan Turner
+Description:
+- Decode the programmer's PGRMR_DEBUG events (MigsSdk/src/PgrmrTrace.hpp)
+  into text and timings
+- Reads a capture file, or the ErrorReceiver's USB serial straight from the
+  port until Ctrl+C (--save keeps the raw bytes)
+- Prints every event with the time since the one before, then the boot
+  timeline, how long flashing took and what went wrong along the way
+- Only needs the python standard library
+"""
+
+import argparse
+import sys
+
+from migstrace import is_tty, read_serial
+
+SYNC = 0xA5
+RECORD_SIZE = 10
+BAUD = 115200  # ErrorReceiver's USB side
+
+# Event byte -> name, from PgrmrTrace.hpp
+DROPPED = 0x00
+BOOT_PHASE = 0x01
+PROGRAM_MODE = 0x10
+PAGE_WRITTEN = 0x11
+FINISHED = 0x12
+DONE = 0x13
+EVENTS = {
+    DROPPED: 'dropped',
+    BOOT_PHASE: 'boot',
+    PROGRAM_MODE: 'program mode',
+    PAGE_WRITTEN: 'page written',
+    FINISHED: 'finished programming',
+    DONE: 'new program started',
+    0x20: 'sync failed',
+    0x21: 'program mode failed',
+    0x22: 'load address failed',
+    0x23: 'page write failed',
+    0x24: 'disable failed',
+    0x25: 'restarting',
+    0x26: 'gave up',
+    0x40: 'SD card init failed'
+}
+WARNINGS = range(0x20, 0x40)
+ERRORS = range(0x40, 0x60)
+
+# boot::Phase, from MigsProgrammer/BootTimeline.hpp
+PHASES = [
+    'start', 'sd ready', 'image checked', 'synced', 'flashed', 'unchanged',
+    'ready'
+]
+
+# stk500::Error, from MigsProgrammer/Stk500.hpp
+ERROR_CODES = {
+    0: 'None', -1: 'Generic', -2: 'UnknownResponse', -3: 'NoDevice',
+    -4: 'ProtocolSync', -5: 'NoSync', -6: 'NoProgramMode',
+    -7: 'NoProgrammer', -8: 'NotOk', -9: 'ParameterFailed', -10: 'Timeout',
+    -11: 'Pending'
+}
+
+
+def event_name(event):
+    return EVENTS.get(event, f'0x{event:02X}')
+
+
+def phase_name(phase):
+    return PHASES[phase] if 0 <= phase < len(PHASES) else f'phase {phase}'
+
+
+def decode(data):
+    """([(time ms, event, code, arg)], bytes skipped to resync)"""
+    records = []
+    skipped = 0
+    last_time = None
+    wraps = 0
+    i = 0
+    while i + RECORD_SIZE <= len(data):
+        rec = data[i:i + RECORD_SIZE]
+        check = 0
+        for b in rec[1:-1]:
+            check ^= b
+        if (rec[0] != SYNC) or (check != rec[-1]):
+            i += 1
+            skipped += 1
+            continue
+        i += RECORD_SIZE
+
+        # millis() wraps every ~49 days
+        time = int.from_bytes(rec[3:7], 'little')
+        if (last_time is not None) and (last_time - time > 1 << 31):
+            wraps += 1
+        last_time = time
+        code = rec[2] - 0x100 if rec[2] & 0x80 else rec[2]
+        arg = rec[7] | (rec[8] << 8)
+        records.append((time + (wraps << 32), rec[1], code, arg))
+    return records, skipped
+
+
+def describe(event, code, arg):
+    if event == BOOT_PHASE:
+        return f'boot: {phase_name(code)}'
+    elif event == DROPPED:
+        return f'{arg} events dropped (ring full)'
+    elif event == PAGE_WRITTEN:
+        return f'page 0x{arg:04X} written'
+    elif (event in WARNINGS) or (event in ERRORS):
+        kind = 'error' if event in ERRORS else 'warning'
+        reason = ERROR_CODES.get(code, str(code))
+        return f'{kind}: {event_name(event)} ({reason}, arg 0x{arg:04X})'
+    return event_name(event)
+
+
+def print_timeline(records):
+    prev = None
+    for time, event, code, arg in records:
+        gap = '' if prev is None else f'+{time - prev}'
+        print(f'{time:10} ms {gap:>8}  {describe(event, code, arg)}')
+        prev = time
+
+
+def print_summary(records, skipped):
+    print(f'{len(records)} events over {records[-1][0] - records[0][0]} ms')
+    if skipped:
+        print(f'{skipped} bytes skipped resyncing')
+    dropped = sum(arg for _, event, _, arg in records if event == DROPPED)
+    if dropped:
+        print(f'{dropped} events dropped by the programmer (ring full)')
+
+    # Last mark of each phase, in the order they were taken
+    phases = [(time, code) for time, event, code, _ in records
+              if event == BOOT_PHASE]
+    if phases:
+        print()
+        print('Boot timeline (ms):')
+        prev = 0
+        for time, code in phases:
+            print(f'- {phase_name(code):<14} @ {time:>8} (+{time - prev})')
+            prev = time
+
+    # Each flash, from entering program mode to the new program starting
+    start = None
+    pages = 0
+    for time, event, _, _ in records:
+        if event == PROGRAM_MODE:
+            start, pages = time, 0
+        elif event == PAGE_WRITTEN:
+            pages += 1
+        elif (event == DONE) and (start is not None):
+            took = max(time - start, 1)
+            print()
+            print(f'Flashed {pages} pages in {took} ms '
+                  f'({took / max(pages, 1):.1f} ms/page)')
+            start = None
+
+    problems = {}
+    for _, event, code, _ in records:
+        if (event in WARNINGS) or (event in ERRORS):
+            key = (event, code)
+            problems[key] = problems.get(key, 0) + 1
+    if problems:
+        print()
+        print('Problems:')
+        for (event, code), count in sorted(problems.items()):
+            reason = ERROR_CODES.get(code, str(code))
+            print(f'  {event_name(event):<22} {reason:<16} x{count}')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode the programmer\'s debug events'
+    )
+    parser.add_argument('input', help='Capture file, or a serial port')
+    parser.add_argument('--baud', type=int, default=BAUD,
+                        help='Serial port baud rate')
+    parser.add_argument('--save', help='Keep what was read from the port')
+    parser.add_argument('--quiet', action='store_true',
+                        help='Only print the summary')
+    args = parser.parse_args()
+
+    if is_tty(args.input):
+        data = read_serial(args.input, args.baud, args.save)
+    else:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+
+    records, skipped = decode(data)
+    if not records:
+        sys.exit(f'No debug events in {args.input}')
+
+    if not args.quiet:
+        print_timeline(records)
+        print()
+    print_summary(records, skipped)
+
+
+if __name__ == '__main__':
+    main()
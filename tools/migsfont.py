@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+Author: Dylan Turner
+Description:
+- Generate a game's 1bpp font tables (Font.cpp/Font.hpp) from a BDF font or
+  a PNG sheet. The system font goes into the GPU's asset ROM instead (see
+  migsrom.py)
+- Glyphs are 8x8, a byte per row, top row first, most significant bit on the
+  left. The GPU expands them to colors when they're uploaded
+- BDF: each character's bitmap is placed in the cell by its BBX, with the
+  baseline FONT_DESCENT rows up from the bottom
+- PNG: a grid of 8x8 cells, left to right then top to bottom, in --chars
+  order. Opaque pixels brighter than half are set
+- Only needs the python standard library (PNGs go through migspack's reader)
+"""
+
+import argparse
+import os
+import sys
+
+from migspack import read_png
+
+CELL = 8
+
+# The menu's character set, in glyph order
+DEFAULT_CHARS = ' .0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_' \
+    'abcdefghijklmnopqrstuvwxyz'
+
+# Index defines for the header, if the character is in the set
+DEFINES = [
+    ('FONT_SPACE', ' '),
+    ('FONT_PERIOD', '.'),
+    ('FONT_NUM_START', '0'),
+    ('FONT_CAP_START', 'A'),
+    ('FONT_UNDER_START', '_'),
+    ('FONT_LOW_START', 'a')
+]
+
+
+def read_bdf(path):
+    """{char: [8 row bytes]}"""
+    glyphs = {}
+    descent = 0
+    with open(path) as f:
+        lines = [line.split() for line in f]
+
+    i = 0
+    while i < len(lines):
+        words = lines[i]
+        i += 1
+        if not words:
+            continue
+        if words[0] == 'FONT_DESCENT':
+            descent = int(words[1])
+        elif words[0] == 'STARTCHAR':
+            code = None
+            width = height = xoff = yoff = 0
+            while lines[i][0] != 'BITMAP':
+                if lines[i][0] == 'ENCODING':
+                    code = int(lines[i][1])
+                elif lines[i][0] == 'BBX':
+                    width, height, xoff, yoff = map(int, lines[i][1:5])
+                i += 1
+            i += 1
+
+            rows = [0] * CELL
+            top = CELL - descent - (height + yoff)
+            for y in range(height):
+                bits = int(lines[i + y][0], 16)
+                bits >>= len(lines[i + y][0]) * 4 - width # Pad to the right
+                cell_y = top + y
+                if not 0 <= cell_y < CELL:
+                    continue
+                for x in range(width):
+                    cell_x = xoff + x
+                    if 0 <= cell_x < CELL and bits & (1 << (width - 1 - x)):
+                        rows[cell_y] |= 0x80 >> cell_x
+            i += height
+            if code is not None and code >= 0:
+                glyphs[chr(code)] = rows
+    return glyphs
+
+
+def read_sheet(path, chars):
+    """{char: [8 row bytes]} from a grid of cells in chars order"""
+    width, height, pixels = read_png(path)
+    cols = width // CELL
+    if cols * (height // CELL) < len(chars):
+        raise ValueError(f'{path}: too few {CELL}x{CELL} cells for the chars')
+
+    glyphs = {}
+    for ind, char in enumerate(chars):
+        cx, cy = (ind % cols) * CELL, (ind // cols) * CELL
+        rows = []
+        for y in range(cy, cy + CELL):
+            row = 0
+            for x in range(cx, cx + CELL):
+                r, g, b, a = pixels[y * width + x]
+                if a >= 128 and (r + g + b) >= 3 * 128:
+                    row |= 0x80 >> (x - cx)
+            rows.append(row)
+        glyphs[char] = rows
+    return glyphs
+
+
+def char_name(char):
+    return '[space]' if char == ' ' else char
+
+
+def write_source(glyphs, chars, path, header_name, src_name):
+    lines = [
+        '/*',
+        f' * Generated by tools/migsfont.py from {src_name}. Do not edit.',
+        ' */',
+        '',
+        '#include <Arduino.h>',
+        f'#include "{header_name}"',
+        '',
+        'const uint8_t PROGMEM font::g_font[FONT_COUNT][FONT_GLYPH_SIZE] = {'
+    ]
+    for ind, char in enumerate(chars):
+        lines.append(('    { // ' if ind == 0 else '    }, { // ')
+                     + char_name(char))
+        rows = [f'        0b{row:08b}' for row in glyphs[char]]
+        lines.append(',\n'.join(rows))
+    lines += ['    }', '};', '']
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def write_header(chars, path, src_name):
+    lines = [
+        '/*',
+        f' * Generated by tools/migsfont.py from {src_name}. Do not edit.',
+        ' * - 8x8 glyphs at 1 bit per pixel: a byte per row, top first, MSB on',
+        ' *   the left',
+        ' * - Sent to the GPU as is, which expands them to the glyph colors',
+        ' *   (see gfx::GpuQueue::uploadGlyph)',
+        ' */',
+        '',
+        '#pragma once',
+        '',
+        '#include <stdint.h>',
+        ''
+    ]
+    width = max(len(name) for name, _ in DEFINES) + 4
+    for name, char in DEFINES:
+        if char in chars:
+            lines.append(f'#define {name.ljust(width)}{chars.index(char)}')
+    lines += [
+        f'#define {"FONT_COUNT".ljust(width)}{len(chars)}',
+        f'#define {"FONT_GLYPH_SIZE".ljust(width)}{CELL}',
+        '',
+        'namespace font {',
+        '    extern const uint8_t g_font[FONT_COUNT][FONT_GLYPH_SIZE];',
+        '}',
+        ''
+    ]
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build the 1bpp font tables')
+    parser.add_argument('font', help='BDF font or PNG sheet of 8x8 cells')
+    parser.add_argument('-o', '--output', required=True,
+                        help='Source file to write (e.g. Font.cpp)')
+    parser.add_argument('--header', required=True,
+                        help='Header to write (e.g. Font.hpp)')
+    parser.add_argument('--chars', default=DEFAULT_CHARS,
+                        help='Characters to include, in glyph order')
+    args = parser.parse_args()
+
+    src_name = os.path.basename(args.font)
+    if args.font.lower().endswith('.png'):
+        glyphs = read_sheet(args.font, args.chars)
+    else:
+        glyphs = read_bdf(args.font)
+
+    missing = [char for char in args.chars if char not in glyphs]
+    if missing:
+        sys.exit(f'{src_name} has no glyph for: {"".join(missing)!r}')
+
+    write_source(
+        glyphs, args.chars, args.output, os.path.basename(args.header),
+        src_name
+    )
+    write_header(args.chars, args.header, src_name)
+    print(f'{args.output}: {len(args.chars)} glyphs, '
+          f'{len(args.chars) * CELL} bytes')
+
+
+if __name__ == '__main__':
+    main()
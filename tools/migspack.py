@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""
+Author: Dylan Turner
+Description:
+- Build a MiGS resource pack (.PAK) from a directory of assets
+- Layout matches MigsSdk/src/PackFormat.hpp
+- Asset directory layout (type comes from the folder):
+  + sprites/*.png  -> Sprite: cut into 8x8 RGAB5515 frames, row by row
+  + tiles/*.png    -> Tile: same as sprites
+  + maps/*.csv     -> Map: rows of tile ids (e.g. a Tiled CSV export)
+  + palettes/*.png -> Palette: every pixel, row by row, as RGAB5515
+  + raw/*          -> Raw: copied as is
+- Ids are handed out 0..n-1 in (folder, name) order, and written to a C header
+  so games can refer to assets by name
+- Only needs the python standard library (has its own small PNG reader)
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+import zlib
+
+PACK_MAGIC = b'MPAK'
+PACK_VERSION = 1
+HEADER_SIZE = 16
+ENTRY_SIZE = 12
+ALIGN = 16
+SPR_SIZE = 8
+
+TYPE_RAW = 0
+TYPE_SPRITE = 1
+TYPE_TILE = 2
+TYPE_MAP = 3
+TYPE_PALETTE = 4
+
+# Folder -> asset type, in id order
+FOLDERS = [
+    ('sprites', TYPE_SPRITE),
+    ('tiles', TYPE_TILE),
+    ('maps', TYPE_MAP),
+    ('palettes', TYPE_PALETTE),
+    ('raw', TYPE_RAW)
+]
+
+
+def read_png(path):
+    """Decode a non-interlaced 8 bit PNG into (width, height, [(r,g,b,a)])"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(f'{path}: not a PNG')
+
+    pos = 8
+    idat = b''
+    palette = []
+    trns = b''
+    width = height = depth = ctype = interlace = 0
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, ctype, _, _, interlace = \
+                struct.unpack('>IIBBBBB', body)
+        elif kind == b'PLTE':
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b'tRNS':
+            trns = body
+        elif kind == b'IDAT':
+            idat += body
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or interlace != 0:
+        raise ValueError(f'{path}: only 8 bit, non-interlaced PNGs supported')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    rows = []
+    prev = bytearray(stride)
+    i = 0
+    for _ in range(height):
+        filt = raw[i]
+        line = bytearray(raw[i + 1:i + 1 + stride])
+        i += 1 + stride
+        for x in range(stride):
+            left = line[x - channels] if x >= channels else 0
+            up = prev[x]
+            up_left = prev[x - channels] if x >= channels else 0
+            if filt == 1:
+                line[x] = (line[x] + left) & 0xFF
+            elif filt == 2:
+                line[x] = (line[x] + up) & 0xFF
+            elif filt == 3:
+                line[x] = (line[x] + ((left + up) >> 1)) & 0xFF
+            elif filt == 4:
+                p = left + up - up_left
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - up_left)
+                pred = left if pa <= pb and pa <= pc else \
+                    (up if pb <= pc else up_left)
+                line[x] = (line[x] + pred) & 0xFF
+        rows.append(line)
+        prev = line
+
+    pixels = []
+    for line in rows:
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if ctype == 0:
+                pixels.append((px[0], px[0], px[0], 255))
+            elif ctype == 2:
+                pixels.append((px[0], px[1], px[2], 255))
+            elif ctype == 3:
+                r, g, b = palette[px[0]]
+                a = trns[px[0]] if px[0] < len(trns) else 255
+                pixels.append((r, g, b, a))
+            elif ctype == 4:
+                pixels.append((px[0], px[0], px[0], px[1]))
+            else:
+                pixels.append(tuple(px))
+    return width, height, pixels
+
+
+def rgab5515(r, g, b, a):
+    """One pixel in the GPU's format: r 15-11, g 10-6, a 5, b 4-0"""
+    return ((r >> 3) << 11) | ((g >> 3) << 6) | ((1 if a >= 128 else 0) << 5) \
+        | (b >> 3)
+
+
+def pack_sprites(path):
+    width, height, pixels = read_png(path)
+    if width % SPR_SIZE or height % SPR_SIZE:
+        raise ValueError(f'{path}: size must be a multiple of {SPR_SIZE}')
+
+    out = bytearray()
+    for fy in range(0, height, SPR_SIZE):
+        for fx in range(0, width, SPR_SIZE):
+            for y in range(fy, fy + SPR_SIZE):
+                for x in range(fx, fx + SPR_SIZE):
+                    out += struct.pack('<H', rgab5515(*pixels[y * width + x]))
+    return bytes(out)
+
+
+def pack_palette(path):
+    _, _, pixels = read_png(path)
+    return b''.join(struct.pack('<H', rgab5515(*px)) for px in pixels)
+
+
+def pack_map(path):
+    with open(path, newline='') as f:
+        rows = [
+            [int(cell) for cell in row if cell.strip() != '']
+            for row in csv.reader(f)
+        ]
+    rows = [row for row in rows if row]
+    width = max(len(row) for row in rows) if rows else 0
+    out = bytearray(struct.pack('<HH', width, len(rows)))
+    for row in rows:
+        for x in range(width):
+            out += struct.pack('<H', row[x] if x < len(row) else 0)
+    return bytes(out)
+
+
+def pack_raw(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+PACKERS = {
+    TYPE_SPRITE: pack_sprites,
+    TYPE_TILE: pack_sprites,
+    TYPE_MAP: pack_map,
+    TYPE_PALETTE: pack_palette,
+    TYPE_RAW: pack_raw
+}
+
+
+def collect(asset_dir):
+    """[(symbol, type, path)] in id order"""
+    assets = []
+    for folder, kind in FOLDERS:
+        full = os.path.join(asset_dir, folder)
+        if not os.path.isdir(full):
+            continue
+        for name in sorted(os.listdir(full)):
+            path = os.path.join(full, name)
+            if not os.path.isfile(path) or name.startswith('.'):
+                continue
+            stem = os.path.splitext(name)[0]
+            symbol = ''.join(c if c.isalnum() else '_' for c in stem).upper()
+            assets.append((f'{folder.upper()}_{symbol}', kind, path))
+    return assets
+
+
+def build(assets):
+    toc = bytearray()
+    blobs = bytearray()
+    data_start = HEADER_SIZE + ENTRY_SIZE * len(assets)
+    for ind, (_, kind, path) in enumerate(assets):
+        blob = PACKERS[kind](path)
+        blobs += b'\0' * (-(data_start + len(blobs)) % ALIGN)
+        toc += struct.pack(
+            '<HBBII', ind, kind, 0, data_start + len(blobs), len(blob)
+        )
+        blobs += blob
+
+    header = PACK_MAGIC + struct.pack(
+        '<BBHII', PACK_VERSION, ENTRY_SIZE, len(assets), HEADER_SIZE, 0
+    )
+    return header + toc + blobs
+
+
+def write_header(assets, path, pack_name):
+    lines = [
+        '/*',
+        f' * Generated by tools/migspack.py for {pack_name}. Do not edit.',
+        ' */',
+        '',
+        '#pragma once',
+        ''
+    ]
+    for ind, (symbol, _, _) in enumerate(assets):
+        lines.append(f'#define ASSET_{symbol} {ind}')
+    lines.append(f'#define ASSET_COUNT {len(assets)}')
+    lines.append('')
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build a MiGS resource pack')
+    parser.add_argument('asset_dir', help='Folder with sprites/, maps/, etc.')
+    parser.add_argument('-o', '--output', required=True,
+                        help='Pack to write (8.3 name, e.g. GAME.PAK)')
+    parser.add_argument('--header', help='C header of asset ids to write')
+    args = parser.parse_args()
+
+    assets = collect(args.asset_dir)
+    if not assets:
+        sys.exit(f'No assets found in {args.asset_dir}')
+    if len(assets) > 0xFFFF:
+        sys.exit('Too many assets for 16 bit ids')
+
+    pack = build(assets)
+    with open(args.output, 'wb') as f:
+        f.write(pack)
+    if args.header:
+        write_header(assets, args.header, os.path.basename(args.output))
+
+    print(f'{args.output}: {len(assets)} assets, {len(pack)} bytes')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Author: Dylan Turner
+Description:
+- Build the GPU's asset ROM: 8x8 RGAB5515 images compiled into the MigsGpu
+  firmware, so they never have to cross the bus
+- Asset directory layout (MigsGpu/rom/):
+  + sprites/*.png -> cut into 8x8 frames, row by row (like migspack.py)
+  + tiles/*.png   -> same as sprites
+  + fonts/*.bdf   -> a frame per character in migsfont.py's default set,
+                     opaque white on clear
+- Writes the C++ source linked into MigsGpu (the CMake build and the
+  simulator's Makefile run this) and, with --header, the ids logic MCU
+  programs use. Ids are gpulink::g_romImage plus the image's index, handed
+  out in (folder, name) order
+- Only needs the python standard library
+"""
+
+import argparse
+import os
+import sys
+
+from migsfont import DEFAULT_CHARS, DEFINES, read_bdf
+from migspack import pack_sprites
+
+SPR_SIZE = 8
+IMAGE_SIZE = SPR_SIZE * SPR_SIZE * 2
+ROM_IMAGE = 0x8000  # gpulink::g_romImage
+GLYPH_FG = 0xFFFF
+GLYPH_BG = 0x0000
+
+FOLDERS = ['sprites', 'tiles', 'fonts']
+
+
+def pack_font(path):
+    glyphs = read_bdf(path)
+    missing = [char for char in DEFAULT_CHARS if char not in glyphs]
+    if missing:
+        raise ValueError(f'{path}: no glyph for {"".join(missing)!r}')
+    out = bytearray()
+    for char in DEFAULT_CHARS:
+        for row in glyphs[char]:
+            for x in range(SPR_SIZE):
+                color = GLYPH_FG if row & (0x80 >> x) else GLYPH_BG
+                out += color.to_bytes(2, 'little')
+    return bytes(out)
+
+
+PACKERS = {
+    'sprites': pack_sprites,
+    'tiles': pack_sprites,
+    'fonts': pack_font
+}
+
+
+def collect(asset_dir):
+    """[(symbol, folder, path)] in id order"""
+    assets = []
+    for folder in FOLDERS:
+        full = os.path.join(asset_dir, folder)
+        if not os.path.isdir(full):
+            continue
+        for name in sorted(os.listdir(full)):
+            path = os.path.join(full, name)
+            if not os.path.isfile(path) or name.startswith('.'):
+                continue
+            stem = os.path.splitext(name)[0]
+            symbol = ''.join(c if c.isalnum() else '_' for c in stem).upper()
+            assets.append((f'{folder.upper()}_{symbol}', folder, path))
+    return assets
+
+
+def build(assets):
+    """(image bytes, [(symbol, folder, first image, count)])"""
+    images = bytearray()
+    placed = []
+    for symbol, folder, path in assets:
+        blob = PACKERS[folder](path)
+        first = len(images) // IMAGE_SIZE
+        placed.append((symbol, folder, first, len(blob) // IMAGE_SIZE))
+        images += blob
+    return bytes(images), placed
+
+
+def write_source(images, placed, path, src_name):
+    count = len(images) // IMAGE_SIZE
+    lines = [
+        '/*',
+        f' * Generated by tools/migsrom.py from {src_name}. Do not edit.',
+        ' */',
+        '',
+        'extern "C" {',
+        '    #include <pico/platform.h>',
+        '}',
+        '#include <AssetRom.hpp>',
+        '#include <GpuRom.hpp>',
+        '',
+        f'static_assert(ROM_IMAGE_COUNT == {count}, "MigsSdk/src/GpuRom.hpp is '
+        'out of date, run tools/migsrom.py with --header");',
+        '',
+        f'const int g_romImageCount = {count};',
+        '',
+        '// Kept in flash even in a copy to RAM build, read through the XIP '
+        'cache',
+        'alignas(4) const uint8_t __in_flash("rom")',
+        '    g_romImages[][gpulink::g_imageSize] = {'
+    ]
+    if count == 0:
+        lines.append('    { 0 }')
+    starts = {first: symbol for symbol, _, first, n in placed if n > 0}
+    for ind in range(count):
+        image = images[ind * IMAGE_SIZE:(ind + 1) * IMAGE_SIZE]
+        label = f' // {starts[ind]}' if ind in starts else ''
+        lines.append(('    {' if ind == 0 else '    }, {') + label)
+        for row in range(0, IMAGE_SIZE, 16):
+            lines.append('        ' + ', '.join(
+                f'0x{b:02X}' for b in image[row:row + 16]
+            ) + ('' if row + 16 == IMAGE_SIZE else ','))
+    if count > 0:
+        lines.append('    }')
+    lines += ['};', '']
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def write_header(placed, count, path, src_name):
+    lines = [
+        '/*',
+        f' * Generated by tools/migsrom.py from {src_name}. Do not edit.',
+        ' * - Ids of the images built into the GPU firmware. They go anywhere',
+        ' *   an image slot does (see gpulink::g_romImage)',
+        ' * - Fonts are opaque white on clear, with the _<CHAR>_START offsets',
+        ' *   of migsfont.py\'s headers',
+        ' */',
+        '',
+        '#pragma once',
+        ''
+    ]
+    defines = []
+    for symbol, folder, first, n in placed:
+        name = f'ROM_{symbol}'
+        defines.append((name, f'0x{ROM_IMAGE + first:04X}'))
+        defines.append((f'{name}_COUNT', str(n)))
+        if folder == 'fonts':
+            for define, char in DEFINES:
+                suffix = define[len('FONT_'):]
+                value = ROM_IMAGE + first + DEFAULT_CHARS.index(char)
+                defines.append((f'{name}_{suffix}', f'0x{value:04X}'))
+    defines.append(('ROM_IMAGE_COUNT', str(count)))
+    width = max(len(name) for name, _ in defines) + 4
+    lines += [f'#define {name.ljust(width)}{value}' for name, value in defines]
+    lines.append('')
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build the GPU asset ROM')
+    parser.add_argument('asset_dir', help='Folder with sprites/, fonts/, etc.')
+    parser.add_argument('-o', '--output', required=True,
+                        help='C++ source to write (linked into MigsGpu)')
+    parser.add_argument('--header', help='Header of ROM image ids to write')
+    args = parser.parse_args()
+
+    try:
+        images, placed = build(collect(args.asset_dir))
+    except ValueError as err:
+        sys.exit(str(err))
+    count = len(images) // IMAGE_SIZE
+    if count > ROM_IMAGE:
+        sys.exit(f'Too many images for the ROM ({count})')
+
+    src_name = os.path.basename(os.path.normpath(args.asset_dir)) + '/'
+    write_source(images, placed, args.output, src_name)
+    if args.header:
+        write_header(placed, count, args.header, src_name)
+    print(f'{args.output}: {count} images, {len(images)} bytes')
+
+
+if __name__ == '__main__':
+    main()
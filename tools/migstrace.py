@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+"""
+Author: Dylan Turner
+Description:
+- Decode the GPU's command trace (MigsGpu/include/CmdTrace.hpp): what came
+  over the I2C links, in which frame and when
+- Reads a capture file, or the GPU's UART0 straight from a serial port until
+  Ctrl+C (--save keeps the raw bytes). The simulator writes one with
+  --gpu-trace
+- Prints per command bandwidth, the frames that took longer than they should
+  have and, with --timeline, every record
+- Only needs the python standard library
+"""
+
+import argparse
+import os
+import statistics
+import sys
+
+SYNC = 0xA5
+RECORD_SIZE = 10
+BAUD = 921600
+
+DROPPED = 0x00
+FRAME = 0x01
+BAD_LEN = 0xFF
+
+# Op byte -> name, from GpuLink.hpp
+OPS = {
+    ord('B'): 'Background',
+    ord('S'): 'AddSprite',
+    ord('M'): 'MoveSprite',
+    ord('I'): 'SpriteImage',
+    ord('C'): 'ClearSprites',
+    ord('U'): 'Image',
+    ord('P'): 'GlyphColors',
+    ord('G'): 'Glyph',
+    ord('A'): 'DefineAnim',
+    ord('N'): 'PlayAnim',
+    ord('V'): 'SetVelocity',
+    ord('T'): 'TweenSprite',
+    ord('E'): 'SpriteEdge',
+    ord('O'): 'MotionBounds',
+    ord('R'): 'RasterLines',
+    ord('F'): 'RasterFill',
+    ord('L'): 'LayerSetup',
+    ord('J'): 'LayerPosition',
+    ord('Q'): 'LayerPalette',
+    ord('K'): 'LayerPen',
+    ord('X'): 'LayerPixel',
+    ord('W'): 'LayerLine',
+    ord('Y'): 'LayerRect',
+    ord('Z'): 'LayerBlit',
+    ord('H'): 'AddRect',
+    ord('y'): 'ShapeStyle',
+    ord('z'): 'ResizeRect',
+    ord('r'): 'RectColor',
+    ord('v'): 'SetVideoMode',
+    ord('h'): 'FindImage',
+    ord('c'): 'CopyRomImages',
+    ord('a'): 'AffineSetup',
+    ord('t'): 'AffineTiles',
+    ord('f'): 'AffineFill',
+    ord('x'): 'AffineMatrix',
+    ord('o'): 'AffineOrigin',
+    ord('D'): 'BulkImage'
+}
+
+# A frame this much longer than usual means the render loop fell behind
+SLOW_FRAME = 1.5
+
+
+def op_name(op):
+    return OPS.get(op, f'0x{op:02X}')
+
+
+def is_tty(path):
+    try:
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY | os.O_NONBLOCK)
+    except OSError:
+        return False
+    try:
+        return os.isatty(fd)
+    finally:
+        os.close(fd)
+
+
+def read_serial(path, baud, save):
+    """Raw bytes from a serial port, until Ctrl+C"""
+    import termios
+    import tty
+
+    rate = getattr(termios, f'B{baud}', None)
+    if rate is None:
+        sys.exit(f'Unsupported baud rate {baud}')
+    data = bytearray()
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    try:
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        attrs[4] = attrs[5] = rate
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        print(f'Reading {path} at {baud} baud, Ctrl+C to stop',
+              file=sys.stderr)
+        while True:
+            data += os.read(fd, 4096)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+    if save:
+        with open(save, 'wb') as f:
+            f.write(data)
+    return bytes(data)
+
+
+def decode(data):
+    """([(time us, frame, op, len)], bytes skipped to resync)"""
+    records = []
+    skipped = 0
+    last_time = None
+    wraps = 0
+    last_frame = None
+    frame_wraps = 0
+    i = 0
+    while i + RECORD_SIZE <= len(data):
+        rec = data[i:i + RECORD_SIZE]
+        check = 0
+        for b in rec[1:-1]:
+            check ^= b
+        if (rec[0] != SYNC) or (check != rec[-1]):
+            i += 1
+            skipped += 1
+            continue
+        i += RECORD_SIZE
+
+        # Both counters wrap; times every ~71 minutes
+        time = int.from_bytes(rec[5:9], 'little')
+        if (last_time is not None) and (time < last_time):
+            wraps += 1
+        last_time = time
+        frame = rec[3] | (rec[4] << 8)
+        if (last_frame is not None) and (frame < last_frame):
+            frame_wraps += 1
+        last_frame = frame
+        records.append(
+            (time + (wraps << 32), frame + (frame_wraps << 16), rec[1], rec[2])
+        )
+    return records, skipped
+
+
+def frame_starts(records):
+    """{frame: start time us}"""
+    return {frame: time for time, frame, op, _ in records if op == FRAME}
+
+
+def print_timeline(records, first, last):
+    start = records[0][0]
+    prev = {}
+    for time, frame, op, length in records:
+        if (frame < first) or (frame > last):
+            continue
+        ms = (time - start) / 1000
+        if op == FRAME:
+            gap = ''
+            if FRAME in prev:
+                gap = f' (+{(time - prev[FRAME]) / 1000:.2f} ms)'
+            print(f'{ms:12.3f} ms  -- frame {frame}{gap}')
+        elif op == DROPPED:
+            print(f'{ms:12.3f} ms     {length} records dropped')
+        else:
+            args = 'bad' if length == BAD_LEN else f'{length} B'
+            print(f'{ms:12.3f} ms     {op_name(op):<12} {args}')
+        prev[op] = time
+
+
+def print_stats(records, skipped):
+    start, end = records[0][0], records[-1][0]
+    secs = max(end - start, 1) / 1e6
+    starts = frame_starts(records)
+
+    counts, totals, bad, per_frame = {}, {}, {}, {}
+    dropped = 0
+    for time, frame, op, length in records:
+        if op == FRAME:
+            continue
+        if op == DROPPED:
+            dropped += length
+            continue
+        counts[op] = counts.get(op, 0) + 1
+        if length == BAD_LEN:
+            bad[op] = bad.get(op, 0) + 1
+            continue
+        size = 1 + length  # Op byte and its arguments
+        totals[op] = totals.get(op, 0) + size
+        key = (op, frame)
+        per_frame[key] = per_frame.get(key, 0) + size
+
+    print(f'{len(records)} records over {secs:.3f} s, {len(starts)} frames')
+    if skipped:
+        print(f'{skipped} bytes skipped resyncing')
+    if dropped:
+        print(f'{dropped} records dropped by the GPU (UART fell behind)')
+
+    total = sum(totals.values())
+    print()
+    print(f'{"command":<12} {"count":>7} {"bad":>5} {"bytes":>8} '
+          f'{"share":>6} {"B/s":>8} {"max B/frame":>12}')
+    for op in sorted(counts, key=lambda op: -totals.get(op, 0)):
+        size = totals.get(op, 0)
+        peak = max(
+            (n for (o, _), n in per_frame.items() if o == op), default=0
+        )
+        share = 100 * size / total if total else 0
+        print(f'{op_name(op):<12} {counts[op]:>7} {bad.get(op, 0):>5} '
+              f'{size:>8} {share:>5.1f}% {size / secs:>8.0f} {peak:>12}')
+    print(f'{"total":<12} {sum(counts.values()):>7} {sum(bad.values()):>5} '
+          f'{total:>8} {"":>6} {total / secs:>8.0f}')
+
+    # Frames that took longer than usual, and what came in during them
+    frames = sorted(starts)
+    periods = [
+        (starts[b] - starts[a], a) for a, b in zip(frames, frames[1:])
+        if b == a + 1
+    ]
+    if not periods:
+        return
+    usual = statistics.median(p for p, _ in periods)
+    slow = [(p, f) for p, f in periods if p > usual * SLOW_FRAME]
+    print()
+    print(f'Frame period: median {usual / 1000:.2f} ms, '
+          f'max {max(periods)[0] / 1000:.2f} ms, {len(slow)} slow')
+    for period, frame in sorted(slow, reverse=True)[:10]:
+        cmds = {}
+        for op2, f in per_frame:
+            if f == frame:
+                cmds[op2] = per_frame[(op2, f)]
+        desc = ', '.join(
+            f'{op_name(op2)} {n} B' for op2, n in sorted(cmds.items())
+        ) or 'no commands'
+        print(f'  frame {frame}: {period / 1000:.2f} ms ({desc})')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a GPU command trace')
+    parser.add_argument('input', help='Capture file, or a serial port')
+    parser.add_argument('--baud', type=int, default=BAUD,
+                        help='Serial port baud rate')
+    parser.add_argument('--save', help='Keep what was read from the port')
+    parser.add_argument('--timeline', action='store_true',
+                        help='Print every record')
+    parser.add_argument('--frames', default=None,
+                        help='FIRST:LAST frames for --timeline')
+    args = parser.parse_args()
+
+    if is_tty(args.input):
+        data = read_serial(args.input, args.baud, args.save)
+    else:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+
+    records, skipped = decode(data)
+    if not records:
+        sys.exit(f'No trace records in {args.input}')
+
+    if args.timeline:
+        first, last = 0, float('inf')
+        if args.frames:
+            lo, _, hi = args.frames.partition(':')
+            first = int(lo) if lo else first
+            last = int(hi) if hi else last
+        print_timeline(records, first, last)
+        print()
+    print_stats(records, skipped)
+
+
+if __name__ == '__main__':
+    main()